@@ -0,0 +1,42 @@
+﻿#include "framework.h"
+#include <algorithm>
+
+#include "AdaptiveDebounce.h"
+
+// 指数移動平均（記録がなければ最初の値）
+static double moving_average(double average, double value) {
+	return average < 0.0 ? value : average + AdaptiveDebounce::SMOOTHING * (value - average);
+}
+
+// キー入力を記録
+void AdaptiveDebounce::OnRequest(Clock::time_point now) {
+	auto ticks = now.time_since_epoch().count();
+	auto last = last_request_.exchange(ticks);
+	if (last == 0) return;
+
+	double interval = std::chrono::duration<double, std::milli>(Clock::duration(ticks - last)).count();
+	if (interval >= TYPING_PAUSE_MS) {
+		// 入力が途切れていたので、入力の間隔は測り直す
+		typing_interval_ = -1.0;
+		return;
+	}
+	typing_interval_ = moving_average(typing_interval_, interval);
+}
+
+// 曖昧検索の処理時間を記録
+void AdaptiveDebounce::OnFuzzyCompleted(double milliseconds) {
+	fuzzy_latency_ = moving_average(fuzzy_latency_, milliseconds);
+}
+
+// 曖昧検索を始めるまでの待ち時間
+std::chrono::milliseconds AdaptiveDebounce::FuzzyDelay() const {
+	double latency = fuzzy_latency_;
+	double interval = typing_interval_;
+	// 処理が短いか、入力が途切れている場合はすぐに始める
+	if (latency < IMMEDIATE_LATENCY_MS || interval < 0.0) {
+		return std::chrono::milliseconds(0);
+	}
+	// 入力中は次の入力が来そうな間だけ待つ（処理が重いほど打ち切られたときの無駄が大きいので長めに待つ）
+	double delay = std::max(interval * INTERVAL_FACTOR, std::min(latency, interval * 2.0));
+	return std::chrono::milliseconds(std::clamp(static_cast<int>(delay), MIN_DELAY_MS, MAX_DELAY_MS));
+}
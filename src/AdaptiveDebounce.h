@@ -0,0 +1,36 @@
+﻿#pragma once
+#include <atomic>
+#include <chrono>
+
+// 曖昧検索を始めるまでの待ち時間を、最近の処理時間と入力の間隔から決める
+// 入力の間隔は UI スレッド、処理時間はワーカースレッドから記録する
+class AdaptiveDebounce {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	// キー入力（リクエスト）を記録
+	void OnRequest(Clock::time_point now);
+
+	// 曖昧検索の処理時間を記録
+	void OnFuzzyCompleted(double milliseconds);
+
+	// 曖昧検索を始めるまでの待ち時間
+	// 処理が短ければすぐに始め、長ければ入力の間隔を目安に、次の入力が来ないと見込めるまで待つ
+	std::chrono::milliseconds FuzzyDelay() const;
+
+	// 移動平均（記録がなければ負の値）
+	double AverageFuzzyLatency() const { return fuzzy_latency_; }
+	double AverageTypingInterval() const { return typing_interval_; }
+
+	static constexpr double SMOOTHING = 0.25;             // 移動平均の係数
+	static constexpr double IMMEDIATE_LATENCY_MS = 16.0;  // これより短い処理は待たずに始める
+	static constexpr double TYPING_PAUSE_MS = 1000.0;     // これより長い間隔は入力の区切りとみなす
+	static constexpr double INTERVAL_FACTOR = 1.2;        // 入力の間隔に対する待ち時間の倍率
+	static constexpr int MIN_DELAY_MS = 30;
+	static constexpr int MAX_DELAY_MS = 500;
+
+private:
+	std::atomic<double> fuzzy_latency_{ -1.0 };
+	std::atomic<double> typing_interval_{ -1.0 };
+	std::atomic<Clock::rep> last_request_{ 0 };
+};
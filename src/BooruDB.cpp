@@ -2,11 +2,16 @@
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <exception>
 #include <iostream>
+#include <latch>
+#include <numeric>
 #include <unordered_set>
 #include "BooruDB.h"
-#include "rapidfuzz/fuzz.hpp"
-#include "rapidfuzz/distance/prefix.hpp"
+#include "PartialRatio.h"
+#include "QueryArena.h"
 
 #include "TextUtils.h"
 
@@ -16,11 +21,17 @@ BooruDB& BooruDB::GetInstance() {
 	return instance;
 }
 
-BooruDB::BooruDB() : active_query_(0) {}
+BooruDB::BooruDB() {
+	// 空の辞書で始める（読み手は常にスナップショットを参照できる）
+	Publish(std::make_shared<const Tables>(), RankingWeights(), {});
+}
 
 BooruDB::~BooruDB() {}
 
 bool BooruDB::LoadDictionary() {
+	// 新しい索引を構築してから差し替える（構築中も読み手は前のスナップショットを使う）
+	auto tables = std::make_shared<Tables>();
+	auto& dictionary = tables->dictionary;
 
 	// カスタムリストを読み込み
 	std::vector<std::string> customTags;
@@ -51,40 +62,29 @@ bool BooruDB::LoadDictionary() {
 		}
 	}
 
-	dictionary_.clear();
-	dictionary_.reserve(500000 + customTags.size());
-	dictionary_.insert(dictionary_.end(), customTags.begin(), customTags.end());
+	dictionary.reserve(500000 + customTags.size());
+	dictionary.insert(dictionary.end(), customTags.begin(), customTags.end());
 
 	// カスタムタグのセット（重複排除用）
 	std::unordered_set<std::string> customTagsSet(customTags.begin(), customTags.end());
 
 	// 辞書ファイル（日本語）
+	// 出典の優先度順に読み込むので、タグごとの説明文は優先度順に並ぶ
+	// 人手による翻訳と機械翻訳のみの辞書はなくても動作する
 	{
-		metadata_.clear();
-		metadata_.reserve(100000);
-		std::ifstream file(fullpath(L"danbooru-machine-jp.csv"));
-		if (!file.is_open()) {
+		tables->ClearDescriptions();
+		tables->LoadDescriptions(L"danbooru-jp.csv", DescriptionTier::Curated);
+		if (!tables->LoadDescriptions(L"danbooru-machine-jp.csv", DescriptionTier::Machine)) {
 			OutputDebugString(L"not found dictionary file\n");
 			return false;
 		}
-
-		std::string line;
-		while (std::getline(file, line, '\n')) {
-			std::istringstream iss(line);
-			std::string tag, metadata;
-			if (std::getline(iss, tag, ',')) {
-				tag = booru_to_image_tag(tag);
-				if (std::getline(iss, metadata)) {
-					metadata_[tag] = utf8_to_unicode(metadata);
-				}
-			}
-		}
+		tables->LoadDescriptions(L"danbooru-only-machine-jp.csv", DescriptionTier::MachineOnly);
 	}
 
 	// カテゴリー辞書
 	{
-		category_.clear();
-		category_.reserve(400000 + customTags.size());
+		auto& categories = tables->category;
+		categories.reserve(400000 + customTags.size());
 
 		std::ifstream file(fullpath(L"danbooru.csv"));
 		if (!file.is_open()) {
@@ -92,112 +92,875 @@ bool BooruDB::LoadDictionary() {
 			return false;
 		}
 
+		auto& postCounts = tables->post_count;
+		postCounts.reserve(400000 + customTags.size());
+
 		std::string line;
 		while (std::getline(file, line, '\n')) {
 			std::istringstream iss(line);
-			std::string tag, category;
+			std::string tag, category, postCount, aliasList;
 			if (std::getline(iss, tag, ',')) {
 				tag = booru_to_image_tag(tag);
+				bool hasCategory = static_cast<bool>(std::getline(iss, category, ','));
+				size_t index;
 				if (customTagsSet.find(tag) != customTagsSet.end()) {
 					// カスタムタグはレーティング用タグ扱いでカテゴリを上書き
-					category_[tag] = 9;
+					categories[tag] = 9;
+					index = std::find(dictionary.begin(), dictionary.begin() + customTags.size(), tag) - dictionary.begin();
 				} else {
-					dictionary_.push_back(tag);
-					if (std::getline(iss, category, ',')) {
-						category_[tag] = std::stoi(category);
+					dictionary.push_back(tag);
+					index = dictionary.size() - 1;
+					if (hasCategory) {
+						categories[tag] = std::stoi(category);
 					}
 				}
+				if (hasCategory && std::getline(iss, postCount, ',') && !postCount.empty()) {
+					postCounts[tag] = std::stoi(postCount);
+				}
+				// 別名の列は引用符で囲まれてカンマを含むので、行の残りをまとめて渡す
+				if (std::getline(iss, aliasList)) {
+					tables->AddAliases(index, aliasList);
+				}
 			}
 		}
 	}
 
-	if (dictionary_.empty()) {
+	if (dictionary.empty()) {
 		OutputDebugString(L"dictionary is empty\n");
 		return false;
 	}
 
+	tables->BuildIndex();
+	Publish(std::move(tables));
 	return true;
 }
 
+// 読み込んだ辞書から検索用の索引を構築
+void BooruDB::Tables::BuildIndex() {
+	// タグ → インデックス（重複時は先頭を優先）
+	index.clear();
+	index.reserve(dictionary.size());
+	for (size_t i = 0; i < dictionary.size(); ++i) {
+		index.emplace(dictionary[i], i);
+	}
+
+	// 投稿数の降順（同数なら辞書順）に並べたインデックス
+	popularity_order.resize(dictionary.size());
+	for (size_t i = 0; i < dictionary.size(); ++i) {
+		popularity_order[i] = i;
+	}
+	std::vector<int> counts(dictionary.size());
+	for (size_t i = 0; i < dictionary.size(); ++i) {
+		counts[i] = GetTagPostCount(dictionary[i]);
+	}
+	std::stable_sort(popularity_order.begin(), popularity_order.end(),
+		[&counts](size_t a, size_t b) { return counts[a] > counts[b]; });
+
+	// 文字列順（前方一致の範囲を二分探索で求める）
+	sorted_order = popularity_order;
+	std::sort(sorted_order.begin(), sorted_order.end(),
+		[this](size_t a, size_t b) { return dictionary[a] < dictionary[b]; });
+	sorted_rank.resize(dictionary.size());
+	for (size_t i = 0; i < sorted_order.size(); ++i) {
+		sorted_rank[sorted_order[i]] = static_cast<uint32_t>(i);
+	}
+
+	// 別名の文字列順（前方一致の範囲を二分探索で求める）
+	// 重複したタグは index と同じく先頭のインデックスにそろえ、タグと同じ名前の別名はタグの前方一致で見つかるので除く
+	for (auto& alias : aliases) {
+		alias.second = static_cast<uint32_t>(index.find(dictionary[alias.second])->second);
+	}
+	std::erase_if(aliases, [this](const auto& alias) { return index.count(alias.first) != 0; });
+	std::sort(aliases.begin(), aliases.end());
+	aliases.erase(std::unique(aliases.begin(), aliases.end()), aliases.end());
+
+	// カテゴリーごとの索引（投稿数の降順）
+	for (auto& order : category_order) {
+		order.clear();
+	}
+	for (auto index : popularity_order) {
+		int category = GetTagCategory(dictionary[index]);
+		if (category >= 0 && category < CATEGORY_COUNT) {
+			category_order[category].push_back(index);
+		}
+	}
+
+	// 曖昧検索用に各エントリを分割しておく
+	tokens.Build(dictionary);
+
+	// 文字の出現頻度（先読みで次の文字を見込むのに使う）
+	char_frequency.fill(0);
+	for (const auto& tag : dictionary) {
+		for (unsigned char c : tag) {
+			if (c < char_frequency.size()) char_frequency[c]++;
+		}
+	}
+
+	// 逆引き用の索引（人気の高い順に文書IDを振る）
+	// 説明文は表記ゆれを吸収した形に変換してから登録する
+	// 出典が違っても変換後に同じになる説明文は、優先度の高い方だけを登録する
+	// カタカナを含む説明文はローマ字読みも登録し、IME を使わない入力でも逆引きできるようにする
+	reverse_index.Clear();
+	romaji_index.Clear();
+	for (auto index : popularity_order) {
+		auto it = metadata.find(dictionary[index]);
+		if (it == metadata.end()) continue;
+		for (auto id : it->second) {
+			auto tier = descriptions[id].tier;
+			auto text = normalize_japanese(std::wstring(DescriptionText(id)));
+			if (!reverse_index.Add(index, text, tier)) continue;
+			auto romaji = kana_to_romaji(text);
+			romaji_index.Add(index, std::wstring(romaji.begin(), romaji.end()), tier);
+		}
+	}
+	reverse_index.Build();
+	romaji_index.Build();
+}
+
+// スナップショットを作って差し替える
+// 静的スコアはタグ固有の値なので、索引・重み・お気に入りのどれかが変わるたびに作り直す
+void BooruDB::Publish(std::shared_ptr<const Tables> tables, const RankingWeights& weights, std::unordered_set<std::string> user_tags) {
+	auto snapshot = std::make_shared<Snapshot>();
+	snapshot->version = ++last_version_;
+	snapshot->tables = std::move(tables);
+	snapshot->weights = weights;
+	snapshot->user_tags = std::move(user_tags);
+
+	const auto& dictionary = snapshot->tables->dictionary;
+	snapshot->static_score.resize(dictionary.size());
+	for (size_t i = 0; i < dictionary.size(); ++i) {
+		const auto& tag = dictionary[i];
+		bool isUserTag = snapshot->user_tags.find(tag) != snapshot->user_tags.end();
+		snapshot->static_score[i] = static_tag_score(snapshot->tables->GetTagPostCount(tag),
+			snapshot->tables->GetTagCategory(tag), isUserTag, snapshot->weights);
+	}
+	snapshot_.store(std::move(snapshot));
+}
+
+// 索引を差し替える
+void BooruDB::Publish(std::shared_ptr<const Tables> tables) {
+	std::lock_guard<std::mutex> lock(writer_mutex_);
+	auto current = Pin();
+	Publish(std::move(tables), current->weights, current->user_tags);
+}
+
+// ランキングの重みを設定
+void BooruDB::SetRankingWeights(const RankingWeights& weights) {
+	std::lock_guard<std::mutex> lock(writer_mutex_);
+	auto current = Pin();
+	Publish(current->tables, weights, current->user_tags);
+}
+
+// ユーザーが優先するタグを設定
+void BooruDB::SetUserTags(const std::vector<std::string>& tags) {
+	std::lock_guard<std::mutex> lock(writer_mutex_);
+	auto current = Pin();
+	Publish(current->tables, current->weights, std::unordered_set<std::string>(tags.begin(), tags.end()));
+}
+
+// カテゴリー指定の接頭辞を解析
+int BooruDB::ParseCategoryFilter(std::string& input) {
+	std::string_view view = input;
+	int category = ParseCategoryFilter(view);
+	if (category >= 0) {
+		input = std::string(view);
+	}
+	return category;
+}
+
+// カテゴリー指定の接頭辞を解析（文字列をコピーしない版）
+int BooruDB::ParseCategoryFilter(std::string_view& input) {
+	static constexpr std::pair<std::string_view, int> prefixes[] = {
+		{ "char:", 4 },
+		{ "artist:", 1 },
+		{ "copy:", 3 },
+		{ "meta:", 5 },
+	};
+	for (const auto& [prefix, category] : prefixes) {
+		if (input.starts_with(prefix)) {
+			input.remove_prefix(prefix.size());
+			auto first = input.find_first_not_of(" \t\n\r");
+			auto last = input.find_last_not_of(" \t\n\r");
+			input = first == std::string_view::npos ? std::string_view() : input.substr(first, last - first + 1);
+			return category;
+		}
+	}
+	return -1;
+}
+
+// 走査対象のインデックス
+const std::vector<size_t>& BooruDB::Tables::Candidates(int category) const {
+	if (category >= 0 && category < CATEGORY_COUNT) {
+		return category_order[category];
+	}
+	return popularity_order;
+}
+
+// 前方一致するタグの sorted_order 内の範囲
+std::pair<size_t, size_t> BooruDB::Tables::PrefixRange(std::string_view prefix) const {
+	auto first = std::lower_bound(sorted_order.begin(), sorted_order.end(), prefix,
+		[this](size_t index, std::string_view value) { return dictionary[index] < value; });
+	// 前方一致するものは first から連続するので、範囲の末尾も二分探索で求める
+	auto last = std::partition_point(first, sorted_order.end(),
+		[this, &prefix](size_t index) { return dictionary[index].starts_with(prefix); });
+	return { first - sorted_order.begin(), last - sorted_order.begin() };
+}
+
+// 前方一致する別名の aliases 内の範囲
+std::pair<size_t, size_t> BooruDB::Tables::AliasRange(std::string_view prefix) const {
+	auto first = std::lower_bound(aliases.begin(), aliases.end(), prefix,
+		[](const auto& alias, std::string_view value) { return alias.first < value; });
+	auto last = std::partition_point(first, aliases.end(),
+		[&prefix](const auto& alias) { return alias.first.starts_with(prefix); });
+	return { first - aliases.begin(), last - aliases.begin() };
+}
+
+// タグに別名を追加
+void BooruDB::Tables::AddAliases(size_t index, const std::string& list) {
+	for (auto alias : split_string(list, ',')) {
+		alias.erase(std::remove(alias.begin(), alias.end(), '"'), alias.end());
+		alias = trim(alias);
+		if (!alias.empty()) {
+			aliases.emplace_back(booru_to_image_tag(alias), static_cast<uint32_t>(index));
+		}
+	}
+}
+
+// 登録済みのサジェストの辞書内インデックス
+BooruDB::IndexSet BooruDB::SuggestedIndices(const TagHandleList& suggestions, std::pmr::memory_resource* resource) {
+	IndexSet indices(resource);
+	for (const auto& suggestion : suggestions) {
+		indices.insert(suggestion.id);
+	}
+	return indices;
+}
+
+// 上位だけを残す
+void BooruDB::KeepTopRanked(RankedList& ranked, int maxSuggestions) {
+	// 上位だけをスコアで部分ソート（同点なら走査順を維持）
+	// stable_sort は一時バッファをヒープから確保するので、走査順の番号を作業領域に並べてソートする
+	auto count = std::min(ranked.size(), static_cast<size_t>(std::max(maxSuggestions, 0)));
+	std::pmr::vector<uint32_t> order(ranked.size(), ranked.get_allocator().resource());
+	std::iota(order.begin(), order.end(), 0u);
+	std::partial_sort(order.begin(), order.begin() + count, order.end(), [&ranked](uint32_t a, uint32_t b) {
+		if (ranked[a].second != ranked[b].second) return ranked[a].second > ranked[b].second;
+		return a < b;
+	});
+
+	RankedList top(ranked.get_allocator().resource());
+	top.reserve(count);
+	for (size_t i = 0; i < count; ++i) {
+		top.push_back(ranked[order[i]]);
+	}
+	ranked.swap(top);
+}
+
+// ランキング順に並べた上位をサジェストに追加
+bool BooruDB::AppendRanked(TagHandleList& suggestions, RankedList& ranked,
+	int maxSuggestions, const CancellationToken& cancel) {
+	KeepTopRanked(ranked, maxSuggestions);
+	if (cancel.Cancelled()) return false;
+
+	// 上位のサジェストを返す（文字列は作らず、ハンドルだけを追加する）
+	// 段階は呼び出し側が設定する
+	suggestions.reserve(suggestions.size() + ranked.size());
+	for (const auto& [index, score] : ranked) {
+		suggestions.push_back({ static_cast<uint32_t>(index), static_cast<float>(score), SuggestionStage::Clear });
+	}
+
+	return !cancel.Cancelled();
+}
+
+// TagList 版の検索
+// 登録済みのサジェストをハンドルに変換してから検索し、追加された結果だけを Tag に変換する
+template <typename Search>
+bool BooruDB::SearchTags(TagList& suggestions, Search search) const {
+	TagHandleList handles;
+	{
+		auto pinned = Pin();
+		const auto& tables = *pinned->tables;
+		for (const auto& suggestion : suggestions) {
+			auto it = tables.index.find(suggestion.tag);
+			if (it != tables.index.end()) {
+				handles.push_back({ static_cast<uint32_t>(it->second), 0.0f, SuggestionStage::Clear });
+			}
+		}
+	}
+	auto known = handles.size();
+	bool ok = search(handles);
+	for (size_t i = known; i < handles.size(); ++i) {
+		suggestions.push_back(MakeSuggestion(handles[i]));
+	}
+	return ok;
+}
+
+bool BooruDB::ExactSuggestion(TagList& suggestions, const std::string& input, const CancellationToken& cancel) const {
+	return SearchTags(suggestions, [&](TagHandleList& handles) { return ExactSuggestion(handles, input, cancel); });
+}
+
+bool BooruDB::QuickSuggestion(TagList& suggestions, const std::string& input, int maxSuggestions, const CancellationToken& cancel) const {
+	return SearchTags(suggestions, [&](TagHandleList& handles) { return QuickSuggestion(handles, input, maxSuggestions, cancel); });
+}
+
+bool BooruDB::AliasSuggestion(TagList& suggestions, const std::string& input, int maxSuggestions, const CancellationToken& cancel) const {
+	return SearchTags(suggestions, [&](TagHandleList& handles) { return AliasSuggestion(handles, input, maxSuggestions, cancel); });
+}
+
+bool BooruDB::FuzzySuggestion(TagList& suggestions, const std::string& input, int maxSuggestions, const CancellationToken& cancel) const {
+	return SearchTags(suggestions, [&](TagHandleList& handles) { return FuzzySuggestion(handles, input, maxSuggestions, cancel); });
+}
+
+bool BooruDB::FuzzySuggestion(TagList& suggestions, const std::string& input, int maxSuggestions,
+	std::chrono::milliseconds budget, bool& exhaustive, const CancellationToken& cancel) const {
+	return SearchTags(suggestions, [&](TagHandleList& handles) {
+		return FuzzySuggestion(handles, input, maxSuggestions, budget, exhaustive, cancel);
+	});
+}
+
+bool BooruDB::ReverseSuggestion(TagList& suggestions, const std::string& input, int maxSuggestions, const CancellationToken& cancel) const {
+	return SearchTags(suggestions, [&](TagHandleList& handles) { return ReverseSuggestion(handles, input, maxSuggestions, cancel); });
+}
+
+bool BooruDB::MixedSuggestion(TagList& suggestions, const std::string& input, int maxSuggestions, const CancellationToken& cancel) const {
+	return SearchTags(suggestions, [&](TagHandleList& handles) { return MixedSuggestion(handles, input, maxSuggestions, cancel); });
+}
+
+bool BooruDB::RomajiSuggestion(TagList& suggestions, const std::string& input, int maxSuggestions, const CancellationToken& cancel) const {
+	return SearchTags(suggestions, [&](TagHandleList& handles) { return RomajiSuggestion(handles, input, maxSuggestions, cancel); });
+}
+
+// 完全一致サジェスト
+bool BooruDB::ExactSuggestion(TagHandleList& suggestions, const std::string& input, const CancellationToken& cancel) const {
+	auto pinned = Pin();
+	const auto& snapshot = *pinned;
+	const auto& tables = *snapshot.tables;
+	if (input.empty() || tables.dictionary.empty()) return false;
+
+	QueryArena::Scope scope;
+	std::string_view query = input;
+	int category = ParseCategoryFilter(query);
+	if (query.empty()) return !cancel.Cancelled();
+	auto excluded = SuggestedIndices(suggestions, &scope.Arena());
+
+	// 完全一致するタグは前方一致する範囲の先頭に並ぶ
+	RankedList ranked(&scope.Arena());
+	auto [first, last] = tables.PrefixRange(query);
+	for (size_t pos = first; pos < last; ++pos) {
+		auto index = tables.sorted_order[pos];
+		const auto& entry = tables.dictionary[index];
+		if (entry.size() != query.size()) break;
+		if (excluded.count(index)) continue;
+		if (category >= 0 && tables.GetTagCategory(entry) != category) continue;
+		ranked.emplace_back(index, rank_score(MatchType::Exact, 100.0, snapshot.static_score[index], snapshot.weights));
+	}
+	return AppendRanked(suggestions, ranked, 1, cancel);
+}
+
 // 即時サジェスト
-bool BooruDB::QuickSuggestion(TagList& suggestions, const std::string& input, int maxSuggestions) {
-	if (input.empty() || dictionary_.empty()) return false;
-	int query_id = ++active_query_;
-	auto length = input.size();
-	for (const auto& entry : dictionary_) {
-		auto score = rapidfuzz::prefix_similarity(input, entry);
-		if (score >= length) {
-			suggestions.push_back(MakeSuggestion(entry));
-			if (--maxSuggestions <= 0) break;
-		}
-		if (query_id != active_query_) return false;
+bool BooruDB::QuickSuggestion(TagHandleList& suggestions, const std::string& input, int maxSuggestions, const CancellationToken& cancel) const {
+	auto pinned = Pin();
+	const auto& snapshot = *pinned;
+	const auto& tables = *snapshot.tables;
+	if (input.empty() || tables.dictionary.empty()) return false;
+
+	QueryArena::Scope scope;
+	std::string_view query = input;
+	int category = ParseCategoryFilter(query);
+	auto excluded = SuggestedIndices(suggestions, &scope.Arena());
+
+	// 接頭辞のみの場合はそのカテゴリーの人気順
+	RankedList ranked(&scope.Arena());
+	if (query.empty()) {
+		for (auto i : tables.Candidates(category)) {
+			if (static_cast<int>(ranked.size()) >= maxSuggestions) break;
+			if (excluded.count(i)) continue;
+			ranked.emplace_back(i, snapshot.static_score[i]);
+		}
+		return AppendRanked(suggestions, ranked, maxSuggestions, cancel);
+	}
+
+	// 文字列順の索引から前方一致する範囲を二分探索し、その範囲だけをランキング
+	auto [first, last] = tables.PrefixRange(query);
+	for (size_t pos = first; pos < last; ++pos) {
+		auto index = tables.sorted_order[pos];
+		const auto& entry = tables.dictionary[index];
+		if (excluded.count(index)) continue;
+		if (category >= 0 && tables.GetTagCategory(entry) != category) continue;
+		auto type = entry.size() == query.size() ? MatchType::Exact : MatchType::Prefix;
+		ranked.emplace_back(index, rank_score(type, 100.0, snapshot.static_score[index], snapshot.weights));
+	}
+	if (cancel.Cancelled()) return false;
+
+	return AppendRanked(suggestions, ranked, maxSuggestions, cancel);
+}
+
+// 別名サジェスト
+bool BooruDB::AliasSuggestion(TagHandleList& suggestions, const std::string& input, int maxSuggestions, const CancellationToken& cancel) const {
+	auto pinned = Pin();
+	const auto& snapshot = *pinned;
+	const auto& tables = *snapshot.tables;
+	if (input.empty() || tables.dictionary.empty()) return false;
+
+	QueryArena::Scope scope;
+	std::string_view query = input;
+	int category = ParseCategoryFilter(query);
+	if (query.empty()) return !cancel.Cancelled();
+	auto excluded = SuggestedIndices(suggestions, &scope.Arena());
+
+	// 別名の文字列順の索引から前方一致する範囲を二分探索し、正式なタグでランキング
+	// 完全一致する別名は範囲の先頭に並ぶので、タグごとに最初に見つかった別名のスコアが最も高い
+	RankedList ranked(&scope.Arena());
+	auto [first, last] = tables.AliasRange(query);
+	for (size_t pos = first; pos < last; ++pos) {
+		if ((pos - first) % DEADLINE_CHECK_INTERVAL == 0 && cancel.Cancelled()) return false;
+		const auto& [alias, index] = tables.aliases[pos];
+		if (!excluded.insert(index).second) continue;
+		if (category >= 0 && tables.GetTagCategory(tables.dictionary[index]) != category) continue;
+		auto type = alias.size() == query.size() ? MatchType::Exact : MatchType::Prefix;
+		ranked.emplace_back(index, rank_score(type, 100.0, snapshot.static_score[index], snapshot.weights));
+	}
+
+	return AppendRanked(suggestions, ranked, maxSuggestions, cancel);
+}
+
+// インライン補完
+bool BooruDB::TopCompletion(const std::string& prefix, std::string& completion, std::chrono::microseconds budget) const {
+	completion.clear();
+	if (prefix.empty()) return false;
+	const auto deadline = std::chrono::steady_clock::now() + budget;
+	auto pinned = Pin();
+	const auto& snapshot = *pinned;
+	const auto& tables = *snapshot.tables;
+
+	// 文字列順の索引で前方一致する範囲を求め、その中で静的スコアが最も高いものを選ぶ
+	// 完全一致は補完するものがないので除く
+	auto [first, last] = tables.PrefixRange(prefix);
+	size_t best = tables.dictionary.size();
+	for (size_t pos = first; pos < last; ++pos) {
+		if ((pos - first) % COMPLETION_CHECK_INTERVAL == 0 && pos != first &&
+			std::chrono::steady_clock::now() >= deadline) {
+			break;
+		}
+		auto index = tables.sorted_order[pos];
+		if (tables.dictionary[index].size() == prefix.size()) continue;
+		if (best == tables.dictionary.size() || snapshot.static_score[index] > snapshot.static_score[best]) {
+			best = index;
+		}
 	}
+	if (best == tables.dictionary.size()) return false;
+	completion = tables.dictionary[best];
 	return true;
 }
 
+// 次に入力されそうな1文字を加えた入力
+std::vector<std::string> BooruDB::LikelyContinuations(const std::string& input, size_t count) const {
+	std::vector<std::string> continuations;
+	if (input.empty() || count == 0) return continuations;
+	auto pinned = Pin();
+	const auto& tables = *pinned->tables;
+
+	// 前方一致するタグの次の文字（人気のタグほど入力されやすいとみなして log(投稿数) で重み付け）
+	std::array<double, 128> weight{};
+	auto [first, last] = tables.PrefixRange(input);
+	last = std::min(last, first + CONTINUATION_SCAN_LIMIT);
+	for (size_t pos = first; pos < last; ++pos) {
+		const auto& tag = tables.dictionary[tables.sorted_order[pos]];
+		if (tag.size() <= input.size()) continue;
+		auto c = static_cast<unsigned char>(tag[input.size()]);
+		if (c < weight.size()) {
+			weight[c] += 1.0 + std::log10(static_cast<double>(tables.GetTagPostCount(tag)) + 1.0);
+		}
+	}
+
+	// 前方一致するタグがなければ（曖昧検索の入力）、辞書全体の文字の出現頻度
+	if (first == last) {
+		for (size_t c = 0; c < weight.size(); ++c) {
+			weight[c] = static_cast<double>(tables.char_frequency[c]);
+		}
+	}
+
+	// 制御文字とタグの区切りは除く
+	// 入力は前後の空白を取り除いてからリクエストされるので、空白も除く
+	std::vector<char> characters;
+	for (size_t c = ' ' + 1; c < weight.size() - 1; ++c) {
+		if (weight[c] > 0.0 && c != ',') characters.push_back(static_cast<char>(c));
+	}
+	std::stable_sort(characters.begin(), characters.end(),
+		[&weight](char a, char b) { return weight[static_cast<unsigned char>(a)] > weight[static_cast<unsigned char>(b)]; });
+	if (characters.size() > count) characters.resize(count);
+	for (auto c : characters) {
+		continuations.push_back(input + c);
+	}
+	return continuations;
+}
+
 // 曖昧検索でサジェスト
-bool BooruDB::FuzzySuggestion(TagList& suggestions, const std::string& input, int maxSuggestions) {
-	if (input.empty() || dictionary_.empty()) return false;
-	int query_id = ++active_query_;
-
-	// 入力文字列と各辞書エントリの類似度を計算
-	std::vector<std::pair<std::string, double>> scores;
-	for (const auto& entry : dictionary_) {
-		double score = rapidfuzz::fuzz::token_set_ratio(input, entry, FUZZY_SUGGESTION_CUTOFF);
-		if (query_id != active_query_) return false;
-		if (!score) continue;
-		scores.emplace_back(entry, score);
-	}
-
-	// スコアでソート
-	std::sort(scores.begin(), scores.end(),
-		[](const auto& a, const auto& b) { return a.second > b.second; });
-	if (query_id != active_query_) return false;
-
-	// 上位のサジェストを返す
-	for (const auto& entry : scores) {
-		auto tag = entry.first;
-		// 登録済みのものは除外
-		if (std::any_of(suggestions.begin(), suggestions.end(), [&tag](const auto& s) { return s.tag == tag; })) continue;
-		if (query_id != active_query_) return false;
-		suggestions.push_back(MakeSuggestion(tag));
-		if (--maxSuggestions <= 0) break;
-	}
-
-	if (query_id != active_query_) return false;
+bool BooruDB::FuzzySuggestion(TagHandleList& suggestions, const std::string& input, int maxSuggestions, const CancellationToken& cancel) const {
+	bool exhaustive = false;
+	return FuzzySuggestion(suggestions, input, maxSuggestions, std::chrono::milliseconds::max(), exhaustive, cancel);
+}
+
+// 曖昧検索でサジェスト（時間制限付き）
+bool BooruDB::FuzzySuggestion(TagHandleList& suggestions, const std::string& input, int maxSuggestions,
+	std::chrono::milliseconds budget, bool& exhaustive, const CancellationToken& cancel) const {
+	FuzzyProgress progress;
+	bool result = FuzzySuggestion(suggestions, input, maxSuggestions, budget, progress, cancel);
+	exhaustive = progress.exhaustive;
+	return result;
+}
+
+// 曖昧検索でサジェスト（時間制限付き、続きから再開できる）
+bool BooruDB::FuzzySuggestion(TagHandleList& suggestions, const std::string& input, int maxSuggestions,
+	std::chrono::milliseconds budget, FuzzyProgress& progress, const CancellationToken& cancel) const {
+	auto pinned = Pin();
+	const auto& snapshot = *pinned;
+	const auto& tables = *snapshot.tables;
+
+	// 時間切れになった検索の続きなら、前回追加した結果を取り除いて続きから走査する
+	// 前回の上位は走査順で先に見つかったものなので、ランキングの先頭に戻せば同点の順序も全件を走査した場合と変わらない
+	// スナップショットが差し替わっていれば候補の並びが変わるので、先頭から走査し直す
+	bool continuing = !progress.exhaustive && progress.next > 0 && progress.offset <= suggestions.size();
+	if (continuing) {
+		suggestions.resize(progress.offset);
+	} else {
+		progress.offset = suggestions.size();
+	}
+	if (!continuing || progress.version != snapshot.version) {
+		progress.next = 0;
+		progress.ranked.clear();
+	}
+	progress.version = snapshot.version;
+	progress.exhaustive = false;
+	if (input.empty() || tables.dictionary.empty()) return false;
+
+	// カテゴリー指定があればそのカテゴリーの索引だけを走査
+	QueryArena::Scope scope;
+	std::string_view query = input;
+	int category = ParseCategoryFilter(query);
+	const auto& candidates = tables.Candidates(category);
+	if (query.empty()) {
+		// 接頭辞のみの場合は曖昧検索するものがない
+		progress.exhaustive = true;
+		return true;
+	}
+
+	// 制限時間（max指定の場合は無制限）
+	const auto deadline = budget == std::chrono::milliseconds::max()
+		? std::chrono::steady_clock::time_point::max()
+		: std::chrono::steady_clock::now() + budget;
+
+	// 登録済みのもの（即時サジェストの結果など）は候補から除く
+	RankedList ranked(progress.ranked.begin(), progress.ranked.end(), &scope.Arena());
+	if (!RankFuzzy(snapshot, query, candidates, SuggestedIndices(suggestions, &scope.Arena()), deadline, ranked, progress.next, cancel)) return false;
+
+	if (!AppendRanked(suggestions, ranked, maxSuggestions, cancel)) return false;
+	progress.exhaustive = progress.next == candidates.size();
+
+	// 時間切れの場合は、続きから走査するときのために上位に残ったものを覚えておく
+	if (progress.exhaustive) {
+		progress.ranked.clear();
+	} else {
+		progress.ranked.assign(ranked.begin(), ranked.end());
+	}
 	return true;
 }
 
+// 曖昧検索でランキング
+bool BooruDB::RankFuzzy(const Snapshot& snapshot, std::string_view query, const std::vector<size_t>& candidates,
+	const IndexSet& excluded, std::chrono::steady_clock::time_point deadline,
+	RankedList& ranked, size_t& next, const CancellationToken& cancel) {
+	const auto& tables = *snapshot.tables;
+	const bool unlimited = deadline == std::chrono::steady_clock::time_point::max();
+
+	// 投稿数の多い順に入力文字列と各辞書エントリの一致の種類と類似度を求める
+	// 前方一致は索引の範囲で分類し（タグの文字列には触れない）、それ以外の候補だけ曖昧検索の類似度を計算する
+	auto [prefixFirst, prefixLast] = tables.PrefixRange(query);
+	CachedTokenSetScorer scorer(query, tables.tokens, ranked.get_allocator().resource());
+	const size_t first = std::min(next, candidates.size());
+	for (next = first; next < candidates.size(); ++next) {
+		// 一定件数ごとに中断と制限時間を確認し、時間切れならそこまでの結果を使う
+		if ((next - first) % DEADLINE_CHECK_INTERVAL == 0 && next != first) {
+			if (cancel.Cancelled()) return false;
+			if (!unlimited && std::chrono::steady_clock::now() >= deadline) {
+				break;
+			}
+		}
+		auto index = candidates[next];
+		auto rank = tables.sorted_rank[index];
+		MatchType type;
+		double score = 100.0;
+		if (rank >= prefixFirst && rank < prefixLast) {
+			type = tables.dictionary[index].size() == query.size() ? MatchType::Exact : MatchType::Prefix;
+		} else {
+			score = scorer.Similarity(index, FUZZY_SUGGESTION_CUTOFF);
+			if (!score) continue;
+			type = classify_match(query, std::string_view(tables.dictionary[index]));
+		}
+		if (!excluded.empty() && excluded.count(index)) continue;
+		ranked.emplace_back(index, rank_score(type, score, snapshot.static_score[index], snapshot.weights));
+	}
+	return !cancel.Cancelled();
+}
+
+
+// 逆引きの索引を引く検索語（表記ゆれを吸収したワイド文字列）
+static std::pmr::wstring to_reverse_query(std::string_view query, std::pmr::memory_resource* resource) {
+	return normalize_japanese(utf8_to_unicode(query, resource), resource);
+}
 
 // 逆引きサジェスト
-bool BooruDB::ReverseSuggestion(TagList& suggestions, const std::string& input, int maxSuggestions) {
-	if (input.empty() || metadata_.empty()) return false;
-	int query_id = ++active_query_;
-
-	// 入力文字列と各辞書エントリの類似度を計算
-	auto unicode_input = utf8_to_unicode(input);
-	for (const auto& entry : metadata_) {
-		double score = rapidfuzz::fuzz::partial_ratio(unicode_input, entry.second, REVERSE_SUGGESTION_CUTOFF);
-		if (!score) continue;
-		auto tag = entry.first;
-		suggestions.push_back(MakeSuggestion(tag));
-		if (--maxSuggestions <= 0) break;
-		if (query_id != active_query_) return false;
-	}
-
-	if (query_id != active_query_) return false;
+bool BooruDB::ReverseSuggestion(TagHandleList& suggestions, const std::string& input, int maxSuggestions, const CancellationToken& cancel) const {
+	auto pinned = Pin();
+	const auto& snapshot = *pinned;
+	const auto& tables = *snapshot.tables;
+	if (input.empty() || tables.reverse_index.Size() == 0) return false;
+
+	// カテゴリー指定があればそのカテゴリーのタグだけを対象にする
+	QueryArena::Scope scope;
+	std::string_view query = input;
+	int category = ParseCategoryFilter(query);
+	if (query.empty()) return false;
+
+	RankedList ranked(&scope.Arena());
+	if (!RankDescriptions(snapshot, tables.reverse_index, to_reverse_query(query, &scope.Arena()), REVERSE_GRAM, REVERSE_SUGGESTION_CUTOFF,
+		category, suggestions, maxSuggestions, ranked, cancel)) return false;
+	return AppendRanked(suggestions, ranked, maxSuggestions, cancel);
+}
+
+// ローマ字の索引を引く検索語（小文字のワイド文字列）
+static std::pmr::wstring to_romaji_query(std::string_view query, std::pmr::memory_resource* resource) {
+	std::pmr::wstring romaji(resource);
+	romaji.reserve(query.size());
+	for (auto c : query) {
+		romaji.push_back(static_cast<wchar_t>(std::tolower(static_cast<unsigned char>(c))));
+	}
+	return romaji;
+}
+
+// 英語と日本語が混在した入力のサジェスト
+bool BooruDB::MixedSuggestion(TagHandleList& suggestions, const std::string& input, int maxSuggestions, const CancellationToken& cancel) const {
+	auto pinned = Pin();
+	const auto& snapshot = *pinned;
+	const auto& tables = *snapshot.tables;
+	if (input.empty() || tables.dictionary.empty()) return false;
+
+	QueryArena::Scope scope;
+	std::string_view query = input;
+	int category = ParseCategoryFilter(query);
+	auto runs = split_script_runs(query, &scope.Arena());
+	if (runs.empty()) return false;
+	auto excluded = SuggestedIndices(suggestions, &scope.Arena());
+
+	// 文字種の連続ごとに対応する検索を並行して行う
+	// ASCII は曖昧検索とローマ字の逆引き、日本語は逆引き
+	// まとめた後の上位はいずれかの連続の上位に入るので、連続ごとに上位 maxSuggestions 件だけを返せばよい
+	// 検索は実行したスレッドの作業領域を使い、上位だけを呼び出し側の作業領域に確保しておいた配列に書き込む
+	auto count = static_cast<size_t>(std::max(maxSuggestions, 0));
+	std::pmr::vector<RankedList> results(&scope.Arena());
+	results.reserve(runs.size());
+	for (size_t i = 0; i < runs.size(); ++i) {
+		results.emplace_back().reserve(count);
+	}
+	auto search = [&](std::string_view run, RankedList& result) {
+		QueryArena::Scope runScope;
+		RankedList ranked(&runScope.Arena());
+		bool ok;
+		if (utf8_has_multibyte(run)) {
+			ok = RankDescriptions(snapshot, tables.reverse_index, to_reverse_query(run, &runScope.Arena()), REVERSE_GRAM, REVERSE_SUGGESTION_CUTOFF,
+				category, suggestions, maxSuggestions, ranked, cancel);
+		} else {
+			size_t next = 0;
+			ok = RankFuzzy(snapshot, run, tables.Candidates(category), excluded, std::chrono::steady_clock::time_point::max(), ranked, next, cancel);
+			if (ok && run.size() >= ROMAJI_MIN_QUERY_LENGTH) {
+				ok = RankDescriptions(snapshot, tables.romaji_index, to_romaji_query(run, &runScope.Arena()), ROMAJI_GRAM, ROMAJI_SUGGESTION_CUTOFF,
+					category, suggestions, maxSuggestions, ranked, cancel);
+			}
+		}
+		if (!ok) return;
+		KeepTopRanked(ranked, maxSuggestions);
+		result.assign(ranked.begin(), ranked.end());
+	};
+
+	// 2つ目以降の連続はスレッドプールで検索し、最初の連続は呼び出し元のスレッドで検索する
+	// （連続ごとにスレッドや結果の受け渡しの状態をヒープから確保しない）
+	struct RunTask {
+		decltype(search)* function;
+		std::string_view run;
+		RankedList* result;
+		std::latch* done;
+		std::exception_ptr error;
+
+		static void CALLBACK Execute(PTP_CALLBACK_INSTANCE, void* context) {
+			auto& task = *static_cast<RunTask*>(context);
+			try {
+				(*task.function)(task.run, *task.result);
+			} catch (...) {
+				task.error = std::current_exception();
+			}
+			task.done->count_down();
+		}
+	};
+	std::latch done(static_cast<ptrdiff_t>(runs.size() - 1));
+	std::pmr::vector<RunTask> tasks(&scope.Arena());
+	tasks.reserve(runs.size() - 1);
+	for (size_t i = 1; i < runs.size(); ++i) {
+		auto& task = tasks.emplace_back(RunTask{ &search, runs[i], &results[i], &done, nullptr });
+		if (!TrySubmitThreadpoolCallback(&RunTask::Execute, &task, nullptr)) RunTask::Execute(nullptr, &task);
+	}
+	search(runs[0], results[0]);
+	done.wait();
+	for (const auto& task : tasks) {
+		if (task.error) std::rethrow_exception(task.error);
+	}
+	if (cancel.Cancelled()) return false;
+
+	// 1つのランキングにまとめる（複数の検索で見つかったタグは高い方のスコア）
+	std::pmr::unordered_map<size_t, size_t> positions(&scope.Arena());
+	RankedList ranked(&scope.Arena());
+	for (const auto& result : results) {
+		for (const auto& [index, score] : result) {
+			auto [it, inserted] = positions.emplace(index, ranked.size());
+			if (inserted) {
+				ranked.emplace_back(index, score);
+			} else {
+				ranked[it->second].second = std::max(ranked[it->second].second, score);
+			}
+		}
+	}
+	return AppendRanked(suggestions, ranked, maxSuggestions, cancel);
+}
+
+// ローマ字の逆引きサジェスト
+bool BooruDB::RomajiSuggestion(TagHandleList& suggestions, const std::string& input, int maxSuggestions, const CancellationToken& cancel) const {
+	auto pinned = Pin();
+	const auto& snapshot = *pinned;
+	const auto& tables = *snapshot.tables;
+	if (input.empty() || tables.romaji_index.Size() == 0) return false;
+
+	QueryArena::Scope scope;
+	std::string_view query = input;
+	int category = ParseCategoryFilter(query);
+	if (query.size() < ROMAJI_MIN_QUERY_LENGTH || utf8_has_multibyte(query)) return false;
+
+	RankedList ranked(&scope.Arena());
+	if (!RankDescriptions(snapshot, tables.romaji_index, to_romaji_query(query, &scope.Arena()), ROMAJI_GRAM, ROMAJI_SUGGESTION_CUTOFF,
+		category, suggestions, maxSuggestions, ranked, cancel)) return false;
+	return AppendRanked(suggestions, ranked, maxSuggestions, cancel);
+}
+
+// 説明文の索引を引いてランキング
+bool BooruDB::RankDescriptions(const Snapshot& snapshot, const DescriptionIndex& index, std::wstring_view query, size_t gram, double cutoff,
+	int category, const TagHandleList& suggestions, int maxSuggestions, RankedList& ranked, const CancellationToken& cancel) {
+	const auto& tables = *snapshot.tables;
+	auto* resource = ranked.get_allocator().resource();
+	auto excluded = SuggestedIndices(suggestions, resource);
+	auto accepts = [&](size_t tag) {
+		if (category >= 0 && tables.GetTagCategory(tables.dictionary[tag]) != category) return false;
+		return excluded.count(tag) == 0;
+	};
+
+	// 説明文を採点してランキングに加える
+	// 同じタグの説明文は文書IDが連続するので、直前と同じタグなら高い方だけを残す
+	auto rank = [&](uint32_t doc, double score) {
+		const auto& entry = index.GetDoc(doc);
+		auto type = classify_match(query, index.Text(doc));
+		double total = rank_score(type, score, snapshot.static_score[entry.tag], snapshot.weights)
+			+ snapshot.weights.descriptionTier[static_cast<size_t>(entry.tier)];
+		if (!ranked.empty() && ranked.back().first == entry.tag) {
+			ranked.back().second = std::max(ranked.back().second, total);
+			return;
+		}
+		ranked.emplace_back(entry.tag, total);
+	};
+
+	// 部分文字列として含む説明文は接尾辞配列で直接求める（partial_ratio は100）
+	auto hits = index.FindContaining(query, resource);
+	for (auto doc : hits) {
+		if (accepts(index.GetDoc(doc).tag)) rank(doc, 100.0);
+	}
+	if (cancel.Cancelled()) return false;
+
+	// 部分文字列の一致が足りなければ、n-gram を一定割合以上共有する説明文を曖昧検索で補う
+	if (ranked.size() < static_cast<size_t>(std::max(maxSuggestions, 0))) {
+		IndexSet matched(resource);
+		for (const auto& entry : ranked) matched.insert(entry.first);
+
+		auto candidates = index.FindSimilar(query, REVERSE_CANDIDATE_RATIO, gram, resource);
+		CachedPartialRatioScorer scorer(query, resource);
+		for (size_t i = 0; i < candidates.size(); ++i) {
+			if (i % DESCRIPTION_CHECK_INTERVAL == 0 && i != 0 && cancel.Cancelled()) return false;
+			auto doc = candidates[i];
+			auto tag = index.GetDoc(doc).tag;
+			if (matched.count(tag) || !accepts(tag)) continue;
+			if (std::binary_search(hits.begin(), hits.end(), doc)) continue;
+			double score = scorer.Similarity(index.Text(doc), cutoff);
+			if (score) rank(doc, score);
+		}
+	}
 	return true;
 }
 
-// メタ情報の取得
-std::wstring BooruDB::GetMetadata(const std::string& tag) {
-	auto it = metadata_.find(tag);
-	if (it != metadata_.end()) {
-		return it->second;
+// メタ情報の取得（最も優先度の高い出典の説明文）
+std::wstring BooruDB::Tables::GetMetadata(const std::string& tag) const {
+	auto it = metadata.find(tag);
+	if (it != metadata.end() && !it->second.empty()) {
+		return std::wstring(DescriptionText(it->second.front()));
 	}
 	return L"";
 }
 
+// 説明文の辞書を読み込む
+bool BooruDB::Tables::LoadDescriptions(const wchar_t* filename, DescriptionTier tier) {
+	std::ifstream file(fullpath(filename));
+	if (!file.is_open()) {
+		return false;
+	}
+
+	std::string line;
+	while (std::getline(file, line, '\n')) {
+		std::istringstream iss(line);
+		std::string tag, metadata;
+		if (std::getline(iss, tag, ',')) {
+			tag = booru_to_image_tag(tag);
+			if (std::getline(iss, metadata)) {
+				AddDescription(tag, utf8_to_unicode(metadata), tier);
+			}
+		}
+	}
+	return true;
+}
+
+// 説明文を全て削除
+void BooruDB::Tables::ClearDescriptions() {
+	metadata.clear();
+	metadata.reserve(200000);
+	descriptions.clear();
+	description_pool.clear();
+}
+
+// タグに説明文を追加
+void BooruDB::Tables::AddDescription(const std::string& tag, const std::wstring& text, DescriptionTier tier) {
+	if (text.empty()) return;
+	auto& ids = metadata[tag];
+	for (auto id : ids) {
+		if (DescriptionText(id) == text) return;
+	}
+	auto id = static_cast<uint32_t>(descriptions.size());
+	descriptions.push_back({ static_cast<uint32_t>(description_pool.size()), static_cast<uint32_t>(text.size()), tier });
+	description_pool += text;
+	// 出典の優先度順を保つ
+	auto pos = std::upper_bound(ids.begin(), ids.end(), tier, [this](DescriptionTier t, uint32_t other) {
+		return t < descriptions[other].tier;
+	});
+	ids.insert(pos, id);
+}
+
+// 説明文の文字列
+std::wstring_view BooruDB::Tables::DescriptionText(uint32_t id) const {
+	const auto& description = descriptions[id];
+	return std::wstring_view(description_pool).substr(description.offset, description.length);
+}
+
 
 // カテゴリー名
 static std::wstring GetCategoryName(int category) {
@@ -211,32 +974,95 @@ static std::wstring GetCategoryName(int category) {
 	}
 }
 
+// 表示用の説明（メタ情報とカテゴリー名）
+std::wstring BooruDB::Tables::GetDescription(const std::string& tag) const {
+	return GetMetadata(tag) + GetCategoryName(GetTagCategory(tag));
+}
+
 // メタ情報付きのサジェストに変換
-Tag BooruDB::MakeSuggestion(const std::string& tag) {
-	int category = GetTagCategory(tag);
-	Tag suggestion;
+Tag BooruDB::Tables::MakeSuggestion(const std::string& tag) const {
+	Tag suggestion{};
 	suggestion.tag = tag;
-	suggestion.description = GetMetadata(tag) + GetCategoryName(category);
-	suggestion.category = category;
+	suggestion.description = GetDescription(tag);
+	suggestion.category = GetTagCategory(tag);
 	return suggestion;
 }
 
 // タグの辞書内でのインデックスを取得（使用頻度の代替として使用）
-int BooruDB::GetTagIndex(const std::string& tag) const {
-	auto it = std::find(dictionary_.begin(), dictionary_.end(), tag);
-	if (it != dictionary_.end()) {
-		return static_cast<int>(std::distance(dictionary_.begin(), it));
+int BooruDB::Tables::GetTagIndex(const std::string& tag) const {
+	auto it = index.find(tag);
+	if (it != index.end()) {
+		return static_cast<int>(it->second);
 	}
 	// 見つからない場合は最後に配置（辞書サイズより大きい値を返す）
-	return static_cast<int>(dictionary_.size() + 1);
+	return static_cast<int>(dictionary.size() + 1);
 }
 
 // タグのカテゴリーを取得
-int BooruDB::GetTagCategory(const std::string& tag) const {
-	auto it = category_.find(tag);
-	if (it != category_.end()) {
+int BooruDB::Tables::GetTagCategory(const std::string& tag) const {
+	auto it = category.find(tag);
+	if (it != category.end()) {
+		return it->second;
+	}
+	return 0;
+}
+
+// タグの投稿数を取得
+int BooruDB::Tables::GetTagPostCount(const std::string& tag) const {
+	auto it = post_count.find(tag);
+	if (it != post_count.end()) {
 		return it->second;
 	}
 	return 0;
 }
 
+// メタ情報の取得
+std::wstring BooruDB::GetMetadata(const std::string& tag) const {
+	return Pin()->tables->GetMetadata(tag);
+}
+
+// 表示用の説明
+std::wstring BooruDB::GetDescription(const std::string& tag) const {
+	return Pin()->tables->GetDescription(tag);
+}
+
+// メタ情報付きのサジェストに変換
+Tag BooruDB::MakeSuggestion(const std::string& tag) const {
+	return Pin()->tables->MakeSuggestion(tag);
+}
+
+Tag BooruDB::MakeSuggestion(const TagHandle& handle) const {
+	auto pinned = Pin();
+	const auto& tables = *pinned->tables;
+	if (handle.id >= tables.dictionary.size()) return Tag{};
+	return tables.MakeSuggestion(tables.dictionary[handle.id]);
+}
+
+// ハンドルのタグ名（辞書の範囲外なら空文字列）
+std::string BooruDB::GetTagName(const TagHandle& handle) const {
+	auto pinned = Pin();
+	const auto& dictionary = pinned->tables->dictionary;
+	return handle.id < dictionary.size() ? dictionary[handle.id] : std::string();
+}
+
+// ハンドルのタグのカテゴリー
+int BooruDB::GetTagCategory(const TagHandle& handle) const {
+	auto pinned = Pin();
+	const auto& tables = *pinned->tables;
+	return handle.id < tables.dictionary.size() ? tables.GetTagCategory(tables.dictionary[handle.id]) : 0;
+}
+
+// タグの辞書内でのインデックスを取得
+int BooruDB::GetTagIndex(const std::string& tag) const {
+	return Pin()->tables->GetTagIndex(tag);
+}
+
+// タグのカテゴリーを取得
+int BooruDB::GetTagCategory(const std::string& tag) const {
+	return Pin()->tables->GetTagCategory(tag);
+}
+
+// タグの投稿数を取得
+int BooruDB::GetTagPostCount(const std::string& tag) const {
+	return Pin()->tables->GetTagPostCount(tag);
+}
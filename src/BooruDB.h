@@ -2,10 +2,21 @@
 
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <string_view>
 
 #include "Tag.h"
+#include "Ranking.h"
+#include "TokenSet.h"
+#include "DescriptionIndex.h"
+#include "CancellationToken.h"
 
 // カスタムタグファイル名
 constexpr const wchar_t* CUSTOM_TAGS_FILENAME = L"custom_tags.txt";
@@ -14,9 +25,27 @@ constexpr const wchar_t* CUSTOM_TAGS_FILENAME = L"custom_tags.txt";
 namespace TagListHandlerTest {
 	class BooruDBTestHelper;
 }
+namespace BooruDBTest {
+	class BooruDBTestHelper;
+}
+
+// 制限時間付きの曖昧検索の途中経過
+// 時間切れで走査しきれなかった検索を、同じスナップショットのうちは続きから再開するのに使う
+struct FuzzyProgress {
+	uint64_t version = 0;                          // 走査したスナップショットの版
+	size_t offset = 0;                             // この検索の結果が始まる suggestions の位置
+	size_t next = 0;                               // 次に走査する候補の位置
+	bool exhaustive = false;                       // 全件を走査できたか
+	std::vector<std::pair<size_t, double>> ranked; // 時間切れまでに見つかった上位（辞書内インデックスとスコア、ランキング順）
+};
 
+// 辞書と検索用の索引
+// 読み込んだデータは変更しないスナップショットにまとめ、アトミックな shared_ptr で差し替える
+// 読み手はスナップショットを1つ固定して参照するので、ロックを取らずに複数のスレッドから検索でき、
+// 読み込みや重みの変更の途中の状態を見ることもない
 class BooruDB {
 	friend class TagListHandlerTest::BooruDBTestHelper;
+	friend class BooruDBTest::BooruDBTestHelper;
 public:
 	// Singletonインスタンスを取得
 	static BooruDB& GetInstance();
@@ -28,25 +57,105 @@ public:
 	BooruDB& operator=(BooruDB&&) = delete;
 
 	// 辞書ファイルを読み込む
+	// 新しいスナップショットを構築してから差し替えるので、読み込み中も前の辞書で検索できる
 	bool LoadDictionary();
 
-	// 処理の中断
-	void Cancel() { active_query_ = 0; }
-
 	// メタ情報の取得
-	std::wstring GetMetadata(const std::string& tag);
+	std::wstring GetMetadata(const std::string& tag) const;
+
+	// 表示用の説明（メタ情報とカテゴリー名）
+	std::wstring GetDescription(const std::string& tag) const;
 
 	// メタ情報付きのサジェストに変換
-	Tag MakeSuggestion(const std::string& suggestion);
+	Tag MakeSuggestion(const std::string& suggestion) const;
+	Tag MakeSuggestion(const TagHandle& handle) const;
+
+	// ハンドルのタグ名とカテゴリー
+	// ハンドルは辞書を読み込み直すまで有効（範囲外なら空文字列とカテゴリー0）
+	std::string GetTagName(const TagHandle& handle) const;
+	int GetTagCategory(const TagHandle& handle) const;
 
-	// 即時サジェスト
-	bool QuickSuggestion(TagList& suggestions, const std::string& input, int maxSuggestions = 5);
+	// 各サジェストは結果をハンドルとして suggestions の末尾に追加し、cancel が中断されたら false を返す
+	// 検索では表示用の文字列を作らない（段階は呼び出し側が設定する）
+	// 中断は呼び出し側ごとのトークンで指示するので、別々の呼び出し側の検索は並行して行える
+
+	// 完全一致サジェスト（入力と同じ名前のタグ、なければ何も追加しない）
+	bool ExactSuggestion(TagHandleList& suggestions, const std::string& input,
+		const CancellationToken& cancel = CancellationToken::None()) const;
+
+	// 即時サジェスト（索引から前方一致を求める）
+	bool QuickSuggestion(TagHandleList& suggestions, const std::string& input, int maxSuggestions = 5,
+		const CancellationToken& cancel = CancellationToken::None()) const;
+
+	// 別名サジェスト（danbooru.csv の別名に前方一致するタグ）
+	// 別名では表示せず、正式なタグ名で返す
+	bool AliasSuggestion(TagHandleList& suggestions, const std::string& input, int maxSuggestions = 5,
+		const CancellationToken& cancel = CancellationToken::None()) const;
 
 	// 曖昧検索でサジェスト
-	bool FuzzySuggestion(TagList& suggestions, const std::string& input, int maxSuggestions = 5);
+	// 前方一致も同じ走査の中で分類するので、即時サジェストの結果に続けて呼べば辞書の走査は1回で済む
+	// suggestions に登録済みのタグは走査対象から除く
+	bool FuzzySuggestion(TagHandleList& suggestions, const std::string& input, int maxSuggestions = 5,
+		const CancellationToken& cancel = CancellationToken::None()) const;
+
+	// 曖昧検索でサジェスト（時間制限付き）
+	// 投稿数の多い順に走査し、制限時間内に見つかった上位を返す
+	// exhaustive には全件を走査できたかどうかが入る
+	bool FuzzySuggestion(TagHandleList& suggestions, const std::string& input, int maxSuggestions,
+		std::chrono::milliseconds budget, bool& exhaustive, const CancellationToken& cancel = CancellationToken::None()) const;
+
+	// 曖昧検索でサジェスト（時間制限付き、続きから再開できる）
+	// 時間切れで走査しきれなかった検索の progress を渡すと、前回追加した結果を suggestions から取り除き、
+	// 前回の上位と続きの走査の結果を合わせてランキングし直す（全件を走査した場合と同じ結果になる）
+	// 入力は前回と同じものを渡す（スナップショットが差し替わっていれば先頭から走査する）
+	bool FuzzySuggestion(TagHandleList& suggestions, const std::string& input, int maxSuggestions,
+		std::chrono::milliseconds budget, FuzzyProgress& progress, const CancellationToken& cancel = CancellationToken::None()) const;
+
+	// 逆引きサジェスト（説明文に部分文字列として含まれるものを優先し、足りなければ n-gram 索引で候補を絞って曖昧検索）
+	bool ReverseSuggestion(TagHandleList& suggestions, const std::string& input, int maxSuggestions = 5,
+		const CancellationToken& cancel = CancellationToken::None()) const;
 
-	// 逆引きサジェスト
-	bool ReverseSuggestion(TagList& suggestions, const std::string& input, int maxSuggestions = 5);
+	// 英語と日本語が混在した入力のサジェスト
+	// 入力を文字種の連続ごとに分割し、英語の部分は曖昧検索とローマ字の逆引き、日本語の部分は逆引きで並行して検索して
+	// 1つのランキングにまとめる
+	// 部分ごとの検索は同じ cancel を共有する
+	bool MixedSuggestion(TagHandleList& suggestions, const std::string& input, int maxSuggestions = 5,
+		const CancellationToken& cancel = CancellationToken::None()) const;
+
+	// ローマ字の逆引きサジェスト（説明文のカタカナのローマ字読みを引く）
+	bool RomajiSuggestion(TagHandleList& suggestions, const std::string& input, int maxSuggestions = 5,
+		const CancellationToken& cancel = CancellationToken::None()) const;
+
+	// TagList 版（ハンドルで求めてから表示用の Tag に変換する、件数の少ない呼び出しやテスト用）
+	bool ExactSuggestion(TagList& suggestions, const std::string& input,
+		const CancellationToken& cancel = CancellationToken::None()) const;
+	bool QuickSuggestion(TagList& suggestions, const std::string& input, int maxSuggestions = 5,
+		const CancellationToken& cancel = CancellationToken::None()) const;
+	bool AliasSuggestion(TagList& suggestions, const std::string& input, int maxSuggestions = 5,
+		const CancellationToken& cancel = CancellationToken::None()) const;
+	bool FuzzySuggestion(TagList& suggestions, const std::string& input, int maxSuggestions = 5,
+		const CancellationToken& cancel = CancellationToken::None()) const;
+	bool FuzzySuggestion(TagList& suggestions, const std::string& input, int maxSuggestions,
+		std::chrono::milliseconds budget, bool& exhaustive, const CancellationToken& cancel = CancellationToken::None()) const;
+	bool ReverseSuggestion(TagList& suggestions, const std::string& input, int maxSuggestions = 5,
+		const CancellationToken& cancel = CancellationToken::None()) const;
+	bool MixedSuggestion(TagList& suggestions, const std::string& input, int maxSuggestions = 5,
+		const CancellationToken& cancel = CancellationToken::None()) const;
+	bool RomajiSuggestion(TagList& suggestions, const std::string& input, int maxSuggestions = 5,
+		const CancellationToken& cancel = CancellationToken::None()) const;
+
+	// インライン補完（前方一致するタグのうち静的スコアが最も高い1件）
+	// UI スレッドから入力のたびに同期的に呼ぶので、budget を過ぎたらそれまでに見つかった最上位を返す
+	// 補完するものがなければ false
+	bool TopCompletion(const std::string& prefix, std::string& completion, std::chrono::microseconds budget) const;
+
+	// 次に入力されそうな1文字を加えた入力（見込みの高い順に count 件まで、先読み用）
+	// 前方一致するタグの次の文字を投稿数で重み付けして数え、前方一致するタグがなければ辞書全体の文字の出現頻度を使う
+	std::vector<std::string> LikelyContinuations(const std::string& input, size_t count) const;
+
+	// 辞書の版（スナップショットを差し替えるたびに増える）
+	// 検索結果を保存しておく側は、版が変わったら保存した結果を使わない
+	uint64_t Version() const { return Pin()->version; }
 
 	// タグの辞書内でのインデックスを取得（使用頻度の代替として使用）
 	int GetTagIndex(const std::string& tag) const;
@@ -55,6 +164,24 @@ public:
 	// 0: general（一般タグ）、4: character（キャラクター）、9: rating（レーティング）
 	int GetTagCategory(const std::string& tag) const;
 
+	// タグの投稿数を取得（不明な場合は0）
+	int GetTagPostCount(const std::string& tag) const;
+
+	// ランキングの重みを設定・取得
+	void SetRankingWeights(const RankingWeights& weights);
+	RankingWeights GetRankingWeights() const { return Pin()->weights; }
+
+	// ユーザーが優先するタグ（お気に入り）を設定
+	void SetUserTags(const std::vector<std::string>& tags);
+
+	// カテゴリー指定の接頭辞（char:、artist:、copy:、meta:）を解析
+	// 接頭辞があれば input から取り除いてカテゴリーを返す（なければ-1）
+	static int ParseCategoryFilter(std::string& input);
+	static int ParseCategoryFilter(std::string_view& input);
+
+	// カテゴリーの数（0～9）
+	static constexpr int CATEGORY_COUNT = 10;
+
 private:
 	// プライベートコンストラクタ（Singleton）
 	BooruDB();
@@ -62,9 +189,141 @@ private:
 
 	static constexpr double FUZZY_SUGGESTION_CUTOFF = 60.0;
 	static constexpr double REVERSE_SUGGESTION_CUTOFF = 70.0;
+	static constexpr double REVERSE_CANDIDATE_RATIO = 0.6; // 逆引きの候補とする n-gram の共有割合
+	static constexpr size_t REVERSE_GRAM = 2;              // 逆引きの n-gram の文字数
+	static constexpr double ROMAJI_SUGGESTION_CUTOFF = 85.0;
+	static constexpr size_t ROMAJI_GRAM = 3;               // ローマ字読みの n-gram の文字数
+	static constexpr size_t ROMAJI_MIN_QUERY_LENGTH = 3;
+
+	// 時間制限と中断を確認する間隔（エントリ数）
+	static constexpr size_t DEADLINE_CHECK_INTERVAL = 1024;
+	// 説明文の曖昧検索で中断を確認する間隔（説明文の数）
+	static constexpr size_t DESCRIPTION_CHECK_INTERVAL = 64;
+	// インライン補完で制限時間を確認する間隔（エントリ数）
+	static constexpr size_t COMPLETION_CHECK_INTERVAL = 256;
+	// 次の文字の見込みを数えるタグの数の上限
+	static constexpr size_t CONTINUATION_SCAN_LIMIT = 4096;
+
+	// 説明文（文字列は1つのバッファに連結して持つ）
+	struct Description {
+		uint32_t offset;
+		uint32_t length;
+		DescriptionTier tier;
+	};
+
+	// 辞書と索引（構築して公開した後は変更しない）
+	struct Tables {
+		std::vector<std::string> dictionary;
+		std::unordered_map<std::string, int> category;
+		std::unordered_map<std::string, int> post_count;
+		std::unordered_map<std::string, std::vector<uint32_t>> metadata; // タグ → 説明文ID（出典の優先度順）
+		std::vector<Description> descriptions;
+		std::wstring description_pool;
+		std::unordered_map<std::string, size_t> index; // タグ → dictionary のインデックス
+		std::vector<size_t> popularity_order; // 投稿数の降順に並べた dictionary のインデックス
+		std::vector<size_t> sorted_order;     // タグの文字列順に並べた dictionary のインデックス（前方一致用）
+		std::vector<uint32_t> sorted_rank;    // dictionary のインデックス → sorted_order 内の位置
+		std::array<std::vector<size_t>, CATEGORY_COUNT> category_order; // カテゴリーごとの popularity_order
+		TokenTable tokens;                    // dictionary の各エントリを分割したトークン
+		// 表記ゆれを吸収した説明文（文書IDは人気順）
+		// 1文字の検索語で似た説明文を引いても接尾辞配列の部分一致と同じになるので、n-gram は REVERSE_GRAM 文字だけ登録する
+		DescriptionIndex reverse_index{ REVERSE_GRAM, REVERSE_GRAM };
+		DescriptionIndex romaji_index{ ROMAJI_GRAM, ROMAJI_GRAM }; // 説明文のローマ字読み
+		std::array<uint64_t, 128> char_frequency{};           // dictionary に含まれる ASCII 文字の出現回数
+		// 別名と正式なタグの dictionary のインデックス（BuildIndex で別名の文字列順に並べる）
+		std::vector<std::pair<std::string, uint32_t>> aliases;
+
+		// 読み込んだ辞書から検索用の索引を構築
+		void BuildIndex();
+
+		// タグに別名を追加（list は danbooru.csv の別名の列、カンマ区切りで引用符があってもよい）
+		void AddAliases(size_t index, const std::string& list);
+
+		// 説明文の辞書を読み込む（存在しなければ false）
+		bool LoadDescriptions(const wchar_t* filename, DescriptionTier tier);
+
+		// 説明文を全て削除
+		void ClearDescriptions();
+
+		// タグに説明文を追加（同じタグに同じ説明文があれば出典の優先度が高い方を残す）
+		void AddDescription(const std::string& tag, const std::wstring& text, DescriptionTier tier);
+
+		// 説明文の文字列（description_pool を参照する）
+		std::wstring_view DescriptionText(uint32_t id) const;
+
+		// 最も優先度の高い出典の説明文
+		std::wstring GetMetadata(const std::string& tag) const;
+
+		// 表示用の説明（メタ情報とカテゴリー名）
+		std::wstring GetDescription(const std::string& tag) const;
+
+		// メタ情報付きのサジェストに変換
+		Tag MakeSuggestion(const std::string& tag) const;
+
+		int GetTagIndex(const std::string& tag) const;
+		int GetTagCategory(const std::string& tag) const;
+		int GetTagPostCount(const std::string& tag) const;
+
+		// 走査対象のインデックス（カテゴリー指定がなければ全件）
+		const std::vector<size_t>& Candidates(int category) const;
+
+		// 前方一致するタグの sorted_order 内の範囲 [first, last)
+		std::pair<size_t, size_t> PrefixRange(std::string_view prefix) const;
+
+		// 前方一致する別名の aliases 内の範囲 [first, last)
+		std::pair<size_t, size_t> AliasRange(std::string_view prefix) const;
+	};
+
+	// 読み手が固定して参照するスナップショット
+	// 重みやお気に入りの変更では索引を作り直さず、Tables を共有して静的スコアだけを再計算する
+	struct Snapshot {
+		uint64_t version = 0;
+		std::shared_ptr<const Tables> tables;
+		RankingWeights weights;
+		std::unordered_set<std::string> user_tags;
+		std::vector<double> static_score; // dictionary と同じ並びの静的スコア
+	};
+
+	// 現在のスナップショットを固定する
+	std::shared_ptr<const Snapshot> Pin() const { return snapshot_.load(); }
+
+	// スナップショットを作って差し替える（writer_mutex_ を取ってから呼ぶ）
+	void Publish(std::shared_ptr<const Tables> tables, const RankingWeights& weights, std::unordered_set<std::string> user_tags);
+
+	// 索引を差し替える（重みとお気に入りは現在のものを引き継ぐ）
+	void Publish(std::shared_ptr<const Tables> tables);
+
+	// 検索中の作業用の配列（検索ごとの作業領域 QueryArena に確保する）
+	typedef std::pmr::vector<std::pair<size_t, double>> RankedList; // 辞書内インデックスとスコア
+	typedef std::pmr::unordered_set<size_t> IndexSet;                // 辞書内インデックスの集合
+
+	// 登録済みのサジェストの辞書内インデックス
+	static IndexSet SuggestedIndices(const TagHandleList& suggestions, std::pmr::memory_resource* resource);
+
+	// TagList 版の検索（search はハンドルのリストを受け取って検索する）
+	template <typename Search>
+	bool SearchTags(TagList& suggestions, Search search) const;
+
+	// 曖昧検索でランキングに加える（中断されたら false）
+	// next の位置の候補から走査し、next には次に走査する候補の位置が入る（全ての候補を走査できたら candidates.size()）
+	static bool RankFuzzy(const Snapshot& snapshot, std::string_view query, const std::vector<size_t>& candidates,
+		const IndexSet& excluded, std::chrono::steady_clock::time_point deadline,
+		RankedList& ranked, size_t& next, const CancellationToken& cancel);
+
+	// 説明文の索引を引いてランキングに加える（中断されたら false）
+	// 部分文字列として含むものを先に集め、足りなければ gram 文字の n-gram で候補を絞って曖昧検索で補う
+	static bool RankDescriptions(const Snapshot& snapshot, const DescriptionIndex& index, std::wstring_view query, size_t gram, double cutoff,
+		int category, const TagHandleList& suggestions, int maxSuggestions, RankedList& ranked, const CancellationToken& cancel);
+
+	// ranked をスコアの高い順に並べ、上位 maxSuggestions 件だけを残す（同点なら走査順）
+	static void KeepTopRanked(RankedList& ranked, int maxSuggestions);
+
+	// ランキング順に並べた上位をサジェストに追加
+	// ranked には追加した上位だけがランキング順に残る
+	static bool AppendRanked(TagHandleList& suggestions, RankedList& ranked,
+		int maxSuggestions, const CancellationToken& cancel);
 
-	std::vector<std::string> dictionary_;
-	std::unordered_map<std::string, int> category_;
-	std::unordered_map<std::string, std::wstring> metadata_;
-	std::atomic<int> active_query_;
+	std::atomic<std::shared_ptr<const Snapshot>> snapshot_;
+	std::mutex writer_mutex_; // 書き手どうしの排他（読み手は取らない）
+	uint64_t last_version_ = 0; // 最後に公開したスナップショットの版（writer_mutex_ で保護）
 };
@@ -227,6 +227,13 @@ void BooruPrompter::OnCreate(HWND hwnd) {
 		OnTextChanged(m_hwnd);
 		});
 
+	// インライン補完（入力中のタグを静的スコアが最も高いタグで補う）
+	m_promptEditor->SetCompletionProvider([](const std::string& prefix, std::chrono::microseconds budget) {
+		std::string completion;
+		BooruDB::GetInstance().TopCompletion(prefix, completion, budget);
+		return completion;
+		});
+
 	// サジェスト表示用リストビューの作成
 	std::vector<std::pair<std::wstring, int>> suggestionColumns = {
 		{L"タグ（サジェスト）", 150},
@@ -234,12 +241,13 @@ void BooruPrompter::OnCreate(HWND hwnd) {
 	};
 	m_hwndSuggestions = CreateListView(hwnd, ID_SUGGESTIONS, L"", suggestionColumns);
 
-	// サジェスト開始
-	m_suggestionManager.StartSuggestion([this](const TagList& suggestions) {
+	// サジェスト開始（結果は WM_SUGGESTION_READY で UI スレッドに届く）
+	// 段階ごとに差分が届くので、表示済みの行はそのままにして追加する
+	m_suggestionManager.StartSuggestion([this](const SuggestionBatch& batch) {
 		if (!m_showingFavorites) {
-			SuggestionHandler::UpdateSuggestionList(this, suggestions);
+			SuggestionHandler::AppendSuggestions(this, batch);
 		}
-		});
+		}, hwnd);
 
 	// タグリストの初期化
 	std::vector<std::pair<std::wstring, int>> tagColumns = {
@@ -251,7 +259,7 @@ void BooruPrompter::OnCreate(HWND hwnd) {
 	// 保存されたプロンプトを復元
 	if (!m_savedPrompt.empty()) {
 		SetPrompt(m_savedPrompt);
-		TagListHandler::SyncTagListFromPrompt(this, unicode_to_utf8(m_savedPrompt.c_str()));
+		TagListHandler::SyncTagListFromDocument(this, m_promptEditor->GetDocument());
 	}
 
 	// 初期状態のステータスバーパーツを設定（プログレスバーあり）
@@ -309,15 +317,15 @@ void BooruPrompter::SetPrompt(const std::wstring& text) {
 	m_promptEditor->SetText(unicode_to_utf8(text));
 }
 
-void BooruPrompter::AddListViewItem(HWND hwndListView, int index, const std::vector<std::wstring>& texts) {
+// 文字列を持たないアイテムを追加（全カラムの文字列は LVN_GETDISPINFO で求める）
+void BooruPrompter::AddListViewItem(HWND hwndListView, int index, int columnCount) {
 	LVITEM lvi{};
 	lvi.mask = LVIF_TEXT;
 	lvi.iItem = index;
+	lvi.pszText = LPSTR_TEXTCALLBACK;
 
-	for (size_t i = 0; i < texts.size(); ++i) {
-		lvi.iSubItem = static_cast<int>(i);
-		lvi.pszText = (LPWSTR)texts[i].c_str();
-
+	for (int i = 0; i < columnCount; ++i) {
+		lvi.iSubItem = i;
 		if (i == 0) {
 			ListView_InsertItem(hwndListView, &lvi);
 		} else {
@@ -326,28 +334,13 @@ void BooruPrompter::AddListViewItem(HWND hwndListView, int index, const std::vec
 	}
 }
 
-void BooruPrompter::RefreshTagList(HWND hwndListView, const TagList& tagItems) {
+// リストビューの行数を count に合わせる
+// 行の文字列は描画するときに LVN_GETDISPINFO で求めるので、ここでは文字列を作らない
+// 既存の行も再描画の際に新しい内容で問い合わせられる
+void BooruPrompter::RefreshListView(HWND hwndListView, size_t count) {
 	SendMessage(hwndListView, WM_SETREDRAW, FALSE, 0);
 	int oldCount = ListView_GetItemCount(hwndListView);
-	int newCount = (int)tagItems.size();
-
-	// 既存アイテムの内容を更新
-	auto minCount = std::min(oldCount, newCount);
-	for (int i = 0; i < minCount; ++i) {
-		const auto& item = tagItems[i];
-		const auto tag = utf8_to_unicode(item.tag);
-		LVITEM lvi{};
-		lvi.mask = LVIF_TEXT;
-		lvi.iItem = i;
-		// 1カラム目
-		lvi.iSubItem = 0;
-		lvi.pszText = (LPWSTR)tag.c_str();
-		ListView_SetItem(hwndListView, &lvi);
-		// 2カラム目
-		lvi.iSubItem = 1;
-		lvi.pszText = (LPWSTR)item.description.c_str();
-		ListView_SetItem(hwndListView, &lvi);
-	}
+	int newCount = (int)count;
 
 	// 余分なアイテムを削除
 	for (int i = oldCount - 1; i >= newCount; --i) {
@@ -355,17 +348,21 @@ void BooruPrompter::RefreshTagList(HWND hwndListView, const TagList& tagItems) {
 	}
 
 	// 新規アイテムを追加
+	int columnCount = Header_GetItemCount(ListView_GetHeader(hwndListView));
 	for (int i = oldCount; i < newCount; ++i) {
-		const auto& item = tagItems[i];
-		const auto tag = utf8_to_unicode(item.tag);
-		std::vector<std::wstring> texts = { tag, item.description };
-		AddListViewItem(hwndListView, i, texts);
+		AddListViewItem(hwndListView, i, columnCount);
 	}
 
 	SendMessage(hwndListView, WM_SETREDRAW, TRUE, 0);
 	InvalidateRect(hwndListView, NULL, TRUE);
 }
 
+// LVN_GETDISPINFO で表示する文字列を設定（リストビューのバッファに収まる分だけ写す）
+void BooruPrompter::SetDispInfoText(NMLVDISPINFO* info, const std::wstring& text) {
+	if (!(info->item.mask & LVIF_TEXT) || !info->item.pszText || info->item.cchTextMax <= 0) return;
+	wcsncpy_s(info->item.pszText, info->item.cchTextMax, text.c_str(), _TRUNCATE);
+}
+
 void BooruPrompter::OnSize(HWND hwnd) {
 	// クライアントサイズの取得
 	RECT rc;
@@ -505,14 +502,9 @@ void BooruPrompter::ApplyLayout(const LayoutInfo& layout) {
 
 void BooruPrompter::OnCommand(HWND hwnd, int id, HWND hwndCtl, UINT codeNotify) {
 	switch (id) {
-	case ID_EDIT:
-		if (codeNotify == EN_CHANGE) {
-			OnTextChanged(hwnd);
-		}
-		break;
 	case ID_CLEAR:
 		SetPrompt(L"");
-		TagListHandler::SyncTagListFromPrompt(this, "");
+		TagListHandler::SyncTagListFromDocument(this, m_promptEditor->GetDocument());
 		m_suggestionManager.Request({});
 		break;
 	case ID_PASTE:
@@ -521,7 +513,7 @@ void BooruPrompter::OnCommand(HWND hwnd, int id, HWND hwndCtl, UINT codeNotify)
 		std::wstring text = GetFromClipboard();
 		if (!text.empty()) {
 			SetPrompt(text);
-			TagListHandler::SyncTagListFromPrompt(this, unicode_to_utf8(text.c_str()));
+			TagListHandler::SyncTagListFromDocument(this, m_promptEditor->GetDocument());
 			m_suggestionManager.Request({});
 		}
 	}
@@ -566,7 +558,15 @@ void BooruPrompter::OnCommand(HWND hwnd, int id, HWND hwndCtl, UINT codeNotify)
 void BooruPrompter::OnNotifyMessage(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 	LPNMHDR pnmh = reinterpret_cast<LPNMHDR>(lParam);
 
-	if (pnmh->idFrom == ID_SUGGESTIONS && pnmh->code == NM_DBLCLK) {
+	if (pnmh->idFrom == ID_EDIT) {
+		// エディターの通知（ハイライトなど）
+		m_promptEditor->OnNotify(pnmh);
+	} else if (pnmh->idFrom == ID_SUGGESTIONS && pnmh->code == LVN_GETDISPINFO) {
+		// 描画する行の文字列
+		SuggestionHandler::OnGetDispInfo(this, reinterpret_cast<NMLVDISPINFO*>(lParam));
+	} else if (pnmh->idFrom == ID_TAG_LIST && pnmh->code == LVN_GETDISPINFO) {
+		TagListHandler::OnGetDispInfo(this, reinterpret_cast<NMLVDISPINFO*>(lParam));
+	} else if (pnmh->idFrom == ID_SUGGESTIONS && pnmh->code == NM_DBLCLK) {
 		// ダブルクリックでタグを挿入
 		LPNMITEMACTIVATE pnmia = reinterpret_cast<LPNMITEMACTIVATE>(lParam);
 		SuggestionHandler::OnSuggestionSelected(this, pnmia->iItem);
@@ -635,7 +635,7 @@ void BooruPrompter::OnImageProcessingComplete(const ImageProcessingResult& resul
 	switch (result.type) {
 	case IMAGE_PROCESSING_METADATA_SUCCESS: // メタデータ取得成功
 		SetPrompt(result.metadata);
-		TagListHandler::SyncTagListFromPrompt(this, unicode_to_utf8(result.metadata.c_str()));
+		TagListHandler::SyncTagListFromDocument(this, m_promptEditor->GetDocument());
 		UpdateProgress(100, L"ファイルからプロンプトを取得");
 		break;
 	case IMAGE_PROCESSING_TAG_DETECTION_SUCCESS: // 画像タグ検出成功
@@ -750,19 +750,19 @@ void BooruPrompter::OnTextChanged(HWND hwnd) {
 
 	// 現在のカーソル位置を取得
 	DWORD startPos = m_promptEditor->GetSelectionStart();
-	DWORD endPos = m_promptEditor->GetSelectionEnd();
 
-	// 現在のテキストを取得
-	std::string currentText = m_promptEditor->GetText();
-
-	// カーソル位置のワードを取得
-	const auto [start, end] = get_span_at_cursor(currentText, startPos);
-	const auto currentWord = trim(currentText.substr(start, end - start));
+	// カーソル位置のワードを取得（エディターが解析済みの文書を参照し、テキストは取得し直さない）
+	const auto& document = m_promptEditor->GetDocument();
+	const auto [start, end] = document.WordRangeAt(startPos);
+	const auto currentWord = trim(document.Text().substr(start, end - start));
 
 	// お気に入りリスト表示を解除
+	// 行数はお気に入りの件数になっているので、サジェストの件数に戻す
+	// （入力が前回のリクエストと同じだとサジェストは届き直さず、空の行が残ってしまう）
 	if (m_showingFavorites) {
 		m_showingFavorites = false;
 		SendMessage(m_hwndToolbar, TB_CHECKBUTTON, ID_FAVORITES, MAKELONG(FALSE, 0));
+		RefreshListView(m_hwndSuggestions, m_currentSuggestions.size());
 	}
 
 	// サジェストリクエスト
@@ -774,7 +774,7 @@ void BooruPrompter::OnTextChanged(HWND hwnd) {
 	}
 
 	// プロンプトが変更されたのでタグリストを更新
-	TagListHandler::SyncTagListFromPrompt(this, currentText);
+	TagListHandler::SyncTagListFromDocument(this, document);
 }
 
 int BooruPrompter::Run() {
@@ -1093,11 +1093,7 @@ LRESULT CALLBACK BooruPrompter::WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam,
 						if (pnmh->hwndFrom == pThis->m_hwndTagList) {
 							lplvcd->clrText = GetCategoryColor(TagListHandler::GetCategory(row));
 						} else if (pnmh->hwndFrom == pThis->m_hwndSuggestions) {
-							int category = 0;
-							if (row >= 0 && row < static_cast<int>(pThis->m_currentSuggestions.size())) {
-								category = pThis->m_currentSuggestions[row].category;
-							}
-							lplvcd->clrText = GetCategoryColor(category);
+							lplvcd->clrText = GetCategoryColor(SuggestionHandler::GetCategory(pThis, row));
 						} else {
 							lplvcd->clrText = LISTVIEW_TEXT_COLOR;
 						}
@@ -1124,6 +1120,10 @@ LRESULT CALLBACK BooruPrompter::WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam,
 			pThis->OnLButtonUp(hwnd, lParam);
 			break;
 
+		case WM_SUGGESTION_READY:
+			pThis->m_suggestionManager.DeliverResults();
+			return 0;
+
 		case WM_DESTROY:
 			pThis->m_suggestionManager.Shutdown();
 			FavoriteTags::Save();
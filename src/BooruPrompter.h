@@ -70,8 +70,9 @@ private:
 	HWND CreateListView(HWND parent, int id, const std::wstring& title, const std::vector<std::pair<std::wstring, int>>& columns);
 	std::wstring GetPrompt() const;
 	void SetPrompt(const std::wstring& text);
-	void AddListViewItem(HWND hwndListView, int index, const std::vector<std::wstring>& texts);
-	void RefreshTagList(HWND hwndListView, const TagList& tagItems);
+	void AddListViewItem(HWND hwndListView, int index, int columnCount);
+	void RefreshListView(HWND hwndListView, size_t count);
+	static void SetDispInfoText(NMLVDISPINFO* info, const std::wstring& text);
 
 
 	// 画像タグ検出関連
@@ -87,7 +88,8 @@ private:
 	HWND m_hwndStatusBar;  // ステータスバーのハンドル
 	HWND m_hwndProgressBar; // プログレスバーのハンドル
 	Suggestion m_suggestionManager;
-	TagList m_currentSuggestions;
+	TagHandleList m_currentSuggestions; // サジェストの結果（表示用の文字列は描画するときに求める）
+	TagList m_favoriteItems;            // お気に入りリスト表示中の内容
 	ImageTagDetector m_imageTagDetector; // 画像タグ検出機能
 
 	// サジェストリストのお気に入り表示モード
@@ -0,0 +1,24 @@
+﻿#include "framework.h"
+
+#include "CancellationToken.h"
+
+// 期限付き
+CancellationToken::CancellationToken(Clock::time_point deadline) : deadline_(deadline) {}
+
+// 世代の監視
+CancellationToken::CancellationToken(const std::atomic<uint64_t>& counter, uint64_t generation, Clock::time_point deadline)
+	: counter_(&counter), generation_(generation), deadline_(deadline) {
+}
+
+// 中断されたか
+bool CancellationToken::Cancelled() const {
+	if (cancelled_.load(std::memory_order_relaxed)) return true;
+	if (counter_ && counter_->load(std::memory_order_relaxed) != generation_) return true;
+	return deadline_ != Clock::time_point::max() && Clock::now() >= deadline_;
+}
+
+// 中断しないトークン
+const CancellationToken& CancellationToken::None() {
+	static const CancellationToken none;
+	return none;
+}
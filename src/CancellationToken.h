@@ -0,0 +1,44 @@
+﻿#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// 検索の中断の指示
+// 呼び出し側ごとに用意して検索に渡すので、ほかの呼び出し側の検索を打ち切ることはない
+// 次のいずれかで中断とみなす
+// ・Cancel が呼ばれた
+// ・期限を過ぎた
+// ・監視している世代のカウンターが作成時の値から変わった（新しいリクエストが来た）
+// 確認には時刻の取得などを伴うので、検索側は一定件数ごとにまとめて確認すること
+class CancellationToken {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	// 中断しない（Cancel を呼べば中断する）
+	CancellationToken() = default;
+
+	// 期限付き
+	explicit CancellationToken(Clock::time_point deadline);
+
+	// 世代の監視（counter が generation から変わったら中断）
+	CancellationToken(const std::atomic<uint64_t>& counter, uint64_t generation,
+		Clock::time_point deadline = Clock::time_point::max());
+
+	CancellationToken(const CancellationToken&) = delete;
+	CancellationToken& operator=(const CancellationToken&) = delete;
+
+	// 中断する（ほかのスレッドから呼んでもよい）
+	void Cancel() { cancelled_ = true; }
+
+	// 中断されたか
+	bool Cancelled() const;
+
+	// 中断しないトークン（検索の既定値）
+	static const CancellationToken& None();
+
+private:
+	std::atomic<bool> cancelled_{ false };
+	const std::atomic<uint64_t>* counter_ = nullptr;
+	uint64_t generation_ = 0;
+	Clock::time_point deadline_ = Clock::time_point::max();
+};
@@ -0,0 +1,58 @@
+﻿#include "framework.h"
+#include <algorithm>
+
+#include "DescriptionIndex.h"
+
+DescriptionIndex::DescriptionIndex(size_t minGram, size_t maxGram) : ngrams_(minGram, maxGram) {
+}
+
+// 索引を空にする
+void DescriptionIndex::Clear() {
+	ngrams_.Clear();
+	suffixes_.Clear();
+	pool_.clear();
+	docs_.clear();
+}
+
+// 文書を追加
+bool DescriptionIndex::Add(size_t tag, std::wstring_view text, DescriptionTier tier) {
+	if (text.empty()) return false;
+	for (auto it = docs_.rbegin(); it != docs_.rend() && it->tag == tag; ++it) {
+		if (Text(static_cast<uint32_t>(docs_.rend() - it - 1)) == text) return false;
+	}
+	docs_.push_back({ tag, static_cast<uint32_t>(pool_.size()), static_cast<uint32_t>(text.size()), tier });
+	pool_ += text;
+	pool_ += SuffixArray::SEPARATOR;
+	ngrams_.Add(text);
+	return true;
+}
+
+// 接尾辞配列を構築
+void DescriptionIndex::Build() {
+	suffixes_.Build(pool_);
+}
+
+// 文書の文字列
+std::wstring_view DescriptionIndex::Text(uint32_t doc) const {
+	const auto& entry = docs_[doc];
+	return std::wstring_view(pool_).substr(entry.offset, entry.length);
+}
+
+// 検索語を部分文字列として含む文書
+std::pmr::vector<uint32_t> DescriptionIndex::FindContaining(std::wstring_view query, std::pmr::memory_resource* resource) const {
+	std::pmr::vector<uint32_t> result(resource);
+	for (auto pos : suffixes_.FindAll(query, resource)) {
+		// 位置を含む文書（文書はバッファに文書ID順に並んでいる）
+		auto it = std::upper_bound(docs_.begin(), docs_.end(), pos,
+			[](uint32_t p, const Doc& doc) { return p < doc.offset; });
+		auto doc = static_cast<uint32_t>(it - docs_.begin() - 1);
+		if (result.empty() || result.back() != doc) result.push_back(doc);
+	}
+	return result;
+}
+
+// 似ている文書
+std::pmr::vector<uint32_t> DescriptionIndex::FindSimilar(std::wstring_view query, double ratio, size_t gram,
+	std::pmr::memory_resource* resource) const {
+	return ngrams_.FindSimilar(query, ratio, gram, resource);
+}
@@ -0,0 +1,63 @@
+﻿#pragma once
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Ranking.h"
+#include "NgramIndex.h"
+#include "SuffixArray.h"
+
+// 説明文の検索用索引
+// 説明文は区切り文字で1つのバッファに連結し、部分文字列は接尾辞配列、似た文字列は n-gram 索引で引く
+// 文書IDは追加順に振られる（タグごとにまとめて追加すれば、同じタグの文書は連続する）
+class DescriptionIndex {
+public:
+	// 文書
+	struct Doc {
+		size_t tag; // dictionary_ のインデックス
+		uint32_t offset;
+		uint32_t length;
+		DescriptionTier tier;
+	};
+
+	DescriptionIndex(size_t minGram, size_t maxGram);
+
+	// 接尾辞配列がバッファを参照するのでコピーしない
+	DescriptionIndex(const DescriptionIndex&) = delete;
+	DescriptionIndex& operator=(const DescriptionIndex&) = delete;
+
+	// 索引を空にする
+	void Clear();
+
+	// 文書を追加する
+	// 空文字列と、直前に追加した同じタグの文書と同じ文字列は追加しない（追加したら true）
+	bool Add(size_t tag, std::wstring_view text, DescriptionTier tier);
+
+	// 全ての文書を追加した後に呼ぶ（接尾辞配列を構築する）
+	void Build();
+
+	// 文書数
+	size_t Size() const { return docs_.size(); }
+
+	// 文書と文字列
+	const Doc& GetDoc(uint32_t doc) const { return docs_[doc]; }
+	std::wstring_view Text(uint32_t doc) const;
+
+	// 検索語を部分文字列として含む文書（文書IDの昇順）
+	// 結果と作業用の配列は resource から確保する
+	std::pmr::vector<uint32_t> FindContaining(std::wstring_view query,
+		std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+
+	// 検索語と n-gram を共有する割合が ratio 以上の文書（文書IDの昇順）
+	// 結果と作業用の配列は resource から確保する
+	std::pmr::vector<uint32_t> FindSimilar(std::wstring_view query, double ratio, size_t gram,
+		std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+
+private:
+	NgramIndex ngrams_;
+	SuffixArray suffixes_;
+	std::wstring pool_;
+	std::vector<Doc> docs_;
+};
@@ -10,7 +10,7 @@ std::vector<std::string> FavoriteTags::s_favorites;
 
 void FavoriteTags::ClearFavorites() {
 	s_favorites.clear();
-	Save();
+	OnChanged();
 }
 
 void FavoriteTags::Load() {
@@ -27,6 +27,7 @@ void FavoriteTags::Load() {
 		if (line.empty()) continue;
 		s_favorites.push_back(line);
 	}
+	BooruDB::GetInstance().SetUserTags(s_favorites);
 }
 
 void FavoriteTags::Save() {
@@ -50,14 +51,14 @@ bool FavoriteTags::AddFavorite(const std::string& tag) {
 	}
 
 	s_favorites.push_back(tag);
-	Save();
+	OnChanged();
 	return true;
 }
 
 void FavoriteTags::RemoveFavorite(int index) {
 	if (index < 0 || index >= static_cast<int>(s_favorites.size())) return;
 	s_favorites.erase(s_favorites.begin() + index);
-	Save();
+	OnChanged();
 }
 
 void FavoriteTags::MoveFavoriteToTop(int index) {
@@ -76,6 +77,12 @@ void FavoriteTags::MoveFavoriteToBottom(int index) {
 	Save();
 }
 
+// 変更を保存し、サジェストの優先タグにも反映
+void FavoriteTags::OnChanged() {
+	Save();
+	BooruDB::GetInstance().SetUserTags(s_favorites);
+}
+
 TagList FavoriteTags::GetFavorites() {
 	TagList result;
 	result.reserve(s_favorites.size());
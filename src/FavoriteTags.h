@@ -34,6 +34,9 @@ public:
 	static TagList GetFavorites();
 
 private:
+	// 変更を保存し、サジェストの優先タグにも反映
+	static void OnChanged();
+
 	// 内部ではタグ名だけを保持する
 	static std::vector<std::string> s_favorites;
 };
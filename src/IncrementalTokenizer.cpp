@@ -0,0 +1,105 @@
+﻿#include "framework.h"
+#include <algorithm>
+#include <iterator>
+
+#include "IncrementalTokenizer.h"
+#include "TextUtils.h"
+
+// テキスト全体を解析し直す
+void IncrementalTokenizer::Reset(const std::string& text) {
+	text_ = text;
+	spans_.clear();
+	checkpoints_.assign(1, { 0, 0 });
+	tokenize_prompt(text_, 0, spans_, [this](size_t offset) {
+		checkpoints_.push_back({ offset, spans_.size() });
+		return true;
+	});
+	last_relexed_ = text_.size();
+	last_relexed_end_ = text_.size();
+}
+
+// 編集を反映する
+void IncrementalTokenizer::Edit(size_t position, size_t deletedLength, std::string_view inserted) {
+	position = std::min(position, text_.size());
+	deletedLength = std::min(deletedLength, text_.size() - position);
+	last_relexed_ = 0;
+	if (deletedLength == 0 && inserted.empty()) return;
+	const size_t insertedLength = inserted.size();
+	const ptrdiff_t delta = static_cast<ptrdiff_t>(insertedLength) - static_cast<ptrdiff_t>(deletedLength);
+
+	// 編集位置以前で最後の再開位置から解析する（それより前のテキストは変わらないので、解析の状態も同じ）
+	auto restart = std::prev(std::upper_bound(checkpoints_.begin(), checkpoints_.end(), position,
+		[](size_t value, const Checkpoint& checkpoint) { return value < checkpoint.offset; }));
+	const Checkpoint from = *restart;
+
+	// 編集範囲より後ろの再開位置は、編集後の解析がその位置（をずらした位置）で区切りに来れば、そこから後ろを使い回せる
+	// 挿入だけの場合は再開位置そのものも候補になる
+	auto reuse = std::lower_bound(restart, checkpoints_.end(), position + deletedLength,
+		[](const Checkpoint& checkpoint, size_t value) { return checkpoint.offset < value; });
+
+	text_.replace(position, deletedLength, inserted);
+
+	TagSpanList fresh;
+	std::vector<Checkpoint> added;
+	auto matched = checkpoints_.end();
+	auto stop = tokenize_prompt(text_, from.offset, fresh, [&](size_t offset) {
+		if (offset >= position + insertedLength) {
+			size_t oldOffset = offset - insertedLength + deletedLength;
+			while (reuse != checkpoints_.end() && reuse->offset < oldOffset) ++reuse;
+			if (reuse != checkpoints_.end() && reuse->offset == oldOffset) {
+				matched = reuse;
+				return false;
+			}
+		}
+		added.push_back({ offset, from.tag + fresh.size() });
+		return true;
+	});
+	last_relexed_ = stop - from.offset;
+	last_relexed_end_ = stop;
+
+	// 解析し直した範囲のタグを置き換え、後ろのタグは位置をずらす
+	const size_t oldTagEnd = matched == checkpoints_.end() ? spans_.size() : matched->tag;
+	const ptrdiff_t tagDelta = static_cast<ptrdiff_t>(fresh.size()) - static_cast<ptrdiff_t>(oldTagEnd - from.tag);
+	for (auto it = spans_.begin() + oldTagEnd; it != spans_.end(); ++it) {
+		it->start += delta;
+		it->end += delta;
+	}
+	spans_.erase(spans_.begin() + from.tag, spans_.begin() + oldTagEnd);
+	spans_.insert(spans_.begin() + from.tag, fresh.begin(), fresh.end());
+
+	// 再開位置も同様に置き換える（使い回す位置が解析を始めた位置と同じなら、その位置は両方に残る）
+	std::vector<Checkpoint> updated;
+	updated.reserve(checkpoints_.size() + added.size() + 1);
+	updated.insert(updated.end(), checkpoints_.begin(), restart + 1);
+	updated.insert(updated.end(), added.begin(), added.end());
+	for (auto it = matched; it != checkpoints_.end(); ++it) {
+		updated.push_back({ it->offset + delta, it->tag + tagDelta });
+	}
+	checkpoints_ = std::move(updated);
+}
+
+// 現在のタグ（文字列を作る）
+TagList IncrementalTokenizer::Tags() const {
+	TagList tags;
+	tags.reserve(spans_.size());
+	for (const auto& span : spans_) {
+		Tag tag;
+		tag.tag = tag_span_text(text_, span);
+		tag.category = 0;
+		tag.start = span.start;
+		tag.end = span.end;
+		tags.push_back(std::move(tag));
+	}
+	return tags;
+}
+
+// 新しいテキストとの差分を反映する
+bool IncrementalTokenizer::Update(const std::string& text) {
+	size_t position, deletedLength, insertedLength;
+	if (!find_changed_range(text_, text, position, deletedLength, insertedLength)) {
+		last_relexed_ = 0;
+		return false;
+	}
+	Edit(position, deletedLength, std::string_view(text).substr(position, insertedLength));
+	return true;
+}
@@ -0,0 +1,47 @@
+﻿#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Tag.h"
+
+// 編集に合わせてプロンプトのタグの範囲の表を更新する字句解析
+// 編集位置の直前の区切りから解析し直し、編集前と同じ状態になる区切りまで来たら、
+// それより後ろのタグは位置をずらして使い回す（結果は tokenize_prompt と同じ）
+// 解析し直す範囲は編集したタグの周辺だけなので、プロンプトが長くても1文字の入力の解析は短い
+class IncrementalTokenizer {
+public:
+	// テキスト全体を解析し直す
+	void Reset(const std::string& text);
+
+	// 編集を反映する（position から deletedLength バイトを inserted で置き換える）
+	void Edit(size_t position, size_t deletedLength, std::string_view inserted);
+
+	// 新しいテキストとの差分を1つの編集として反映する（変更がなければ false）
+	// 差分は先頭と末尾の共通部分を除いた範囲とする
+	bool Update(const std::string& text);
+
+	// 現在のテキストとタグの範囲
+	const std::string& Text() const { return text_; }
+	const TagSpanList& Spans() const { return spans_; }
+
+	// 現在のタグ（文字列を作る。extract_tags_from_text と同じ）
+	TagList Tags() const;
+
+	// 直前の解析で読んだ範囲の長さ（バイト数）と末尾の位置
+	// 末尾より後ろのタグは、位置をずらしただけで前と同じ
+	size_t LastRelexedLength() const { return last_relexed_; }
+	size_t LastRelexedEnd() const { return last_relexed_end_; }
+
+private:
+	// 解析を再開できる位置（先頭か、括弧の外の区切りの直後）と、そこから始まるタグの spans_ 内の位置
+	struct Checkpoint {
+		size_t offset;
+		size_t tag;
+	};
+
+	std::string text_;
+	TagSpanList spans_;
+	std::vector<Checkpoint> checkpoints_{ { 0, 0 } }; // offset の昇順（先頭は常に位置0）
+	size_t last_relexed_ = 0;
+	size_t last_relexed_end_ = 0;
+};
@@ -0,0 +1,38 @@
+﻿#include "framework.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+#include "LatencyHistogram.h"
+
+// 処理時間を記録
+void LatencyHistogram::Record(std::chrono::microseconds latency) {
+	auto us = static_cast<uint64_t>(std::max<int64_t>(latency.count(), 0));
+	auto bucket = std::min<size_t>(std::bit_width(us), BUCKET_COUNT - 1);
+	buckets_[bucket]++;
+	count_++;
+	max_ = std::max(max_, latency);
+}
+
+// p パーセンタイルの上限
+std::chrono::microseconds LatencyHistogram::Percentile(double p) const {
+	if (count_ == 0) return std::chrono::microseconds(0);
+	auto rank = static_cast<uint64_t>(std::ceil(std::clamp(p, 0.0, 100.0) / 100.0 * count_));
+	rank = std::max<uint64_t>(rank, 1);
+	uint64_t seen = 0;
+	for (size_t i = 0; i < BUCKET_COUNT - 1; ++i) {
+		seen += buckets_[i];
+		if (seen >= rank) {
+			// 区間の上端（ただし実際の最大値を超えない）
+			return std::min(std::chrono::microseconds(int64_t(1) << i), max_);
+		}
+	}
+	return max_;
+}
+
+// 記録を消去
+void LatencyHistogram::Clear() {
+	buckets_.fill(0);
+	count_ = 0;
+	max_ = std::chrono::microseconds(0);
+}
@@ -0,0 +1,32 @@
+﻿#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+// 処理時間のヒストグラム（マイクロ秒単位、2の冪の区間）
+// 件数を数えるだけなので、毎回の記録でもほとんど負荷にならない
+class LatencyHistogram {
+public:
+	// 区間の数（i 番目の区間は 2^(i-1) 以上 2^i マイクロ秒未満、最後の区間は上限なし）
+	static constexpr size_t BUCKET_COUNT = 24;
+
+	// 処理時間を記録
+	void Record(std::chrono::microseconds latency);
+
+	// 記録した件数
+	uint64_t Count() const { return count_; }
+
+	// p パーセンタイル（0～100）の上限（その区間の上端、記録がなければ0）
+	std::chrono::microseconds Percentile(double p) const;
+
+	// 最大値
+	std::chrono::microseconds Max() const { return max_; }
+
+	// 記録を消去
+	void Clear();
+
+private:
+	std::array<uint64_t, BUCKET_COUNT> buckets_{};
+	uint64_t count_ = 0;
+	std::chrono::microseconds max_{ 0 };
+};
@@ -0,0 +1,155 @@
+﻿#include "framework.h"
+#include <algorithm>
+#include <cmath>
+
+#include "NgramIndex.h"
+
+NgramIndex::NgramIndex(size_t minGram, size_t maxGram)
+	: min_gram_(std::clamp<size_t>(minGram, 1, MAX_GRAM)), max_gram_(std::clamp<size_t>(maxGram, min_gram_, MAX_GRAM)),
+	gram_counts_(max_gram_ - min_gram_ + 1) {
+}
+
+// 索引を空にする
+void NgramIndex::Clear() {
+	postings_.clear();
+	for (auto& counts : gram_counts_) {
+		counts.clear();
+	}
+	size_ = 0;
+}
+
+// n-gram のキー
+uint64_t NgramIndex::MakeKey(std::wstring_view gram) {
+	uint64_t key = 0;
+	for (auto c : gram) {
+		key = (key << 16) | static_cast<uint16_t>(c);
+	}
+	return key;
+}
+
+// 文書を追加
+uint32_t NgramIndex::Add(std::wstring_view text) {
+	auto id = static_cast<uint32_t>(size_++);
+	for (size_t n = min_gram_; n <= max_gram_; ++n) {
+		uint16_t count = 0;
+		for (size_t i = 0; i + n <= text.size(); ++i) {
+			auto& postings = postings_[MakeKey(text.substr(i, n))];
+			// 同じ文書内で繰り返し現れる n-gram は1回だけ登録
+			if (postings.empty() || postings.back() != id) {
+				postings.push_back(id);
+				if (count < UINT16_MAX) ++count;
+			}
+		}
+		gram_counts_[n - min_gram_].push_back(count);
+	}
+	return id;
+}
+
+// 検索語から引く n-gram の文字数
+// 検索語が gram 文字より短ければ、検索語の長さの n-gram で引く（2文字の n-gram の索引でも1文字の検索語は1文字で引く）
+size_t NgramIndex::QueryGram(std::wstring_view query, size_t gram) const {
+	size_t n = std::min(gram ? gram : max_gram_, query.size());
+	if (n < min_gram_ || n > max_gram_) return 0;
+	return n;
+}
+
+// 検索語から引くポスティングリスト
+std::pmr::vector<const std::vector<uint32_t>*> NgramIndex::QueryPostings(std::wstring_view query, size_t gram,
+	std::pmr::memory_resource* resource) const {
+	std::pmr::vector<const std::vector<uint32_t>*> result(resource);
+	size_t n = QueryGram(query, gram);
+	if (!n) return result;
+
+	std::pmr::vector<uint64_t> keys(resource);
+	keys.reserve(query.size());
+	for (size_t i = 0; i + n <= query.size(); ++i) {
+		keys.push_back(MakeKey(query.substr(i, n)));
+	}
+	std::sort(keys.begin(), keys.end());
+	keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+	for (auto key : keys) {
+		auto it = postings_.find(key);
+		result.push_back(it != postings_.end() ? &it->second : nullptr);
+	}
+	return result;
+}
+
+// 検索語の n-gram を全て含む文書
+std::pmr::vector<uint32_t> NgramIndex::FindAll(std::wstring_view query, std::pmr::memory_resource* resource) const {
+	auto lists = QueryPostings(query, 0, resource);
+	if (lists.empty() || std::find(lists.begin(), lists.end(), nullptr) != lists.end()) return std::pmr::vector<uint32_t>(resource);
+
+	// 短いリストから順に積集合を取る
+	std::sort(lists.begin(), lists.end(), [](const auto* a, const auto* b) { return a->size() < b->size(); });
+	std::pmr::vector<uint32_t> result(lists.front()->begin(), lists.front()->end(), resource);
+	std::pmr::vector<uint32_t> merged(resource);
+	for (size_t i = 1; i < lists.size() && !result.empty(); ++i) {
+		merged.clear();
+		std::set_intersection(result.begin(), result.end(), lists[i]->begin(), lists[i]->end(), std::back_inserter(merged));
+		result.swap(merged);
+	}
+	return result;
+}
+
+// 検索語と n-gram を共有する割合が ratio 以上の文書
+// 検索語の n-gram が m 種類のとき、文書側も m 種類以上ある文書は T = ceil(ratio * m) 種類以上を共有するので、
+// 長い方から T - 1 本のリストを除いた残りのどれかに必ず含まれる
+// 除いたリストは走査せず、残りのリストで見つかった候補ごとに二分探索して共有数を数える
+// （ー や ン のように多くの説明文に現れる n-gram のリストを走査しない）
+// 文書側の種類が m より少ない文書は、除いたリストにしか現れなければ候補にならない
+// 短いリストは走査しても安いので除かない（短いリストしか引かない検索では全ての文書を数える）
+std::pmr::vector<uint32_t> NgramIndex::FindSimilar(std::wstring_view query, double ratio, size_t gram,
+	std::pmr::memory_resource* resource) const {
+	std::pmr::vector<uint32_t> result(resource);
+	size_t n = QueryGram(query, gram);
+	if (!n) return result;
+	auto lists = QueryPostings(query, n, resource);
+	size_t total = lists.size();
+	lists.erase(std::remove(lists.begin(), lists.end(), nullptr), lists.end());
+	if (lists.empty()) return result;
+
+	std::sort(lists.begin(), lists.end(), [](const auto* a, const auto* b) { return a->size() < b->size(); });
+	size_t required = std::max<size_t>(1, static_cast<size_t>(std::ceil(ratio * static_cast<double>(total))));
+	size_t scanned = lists.size();
+	while (scanned > 0 && lists.size() - scanned < required - 1 && lists[scanned - 1]->size() > SHORT_POSTINGS) {
+		--scanned;
+	}
+
+	// 走査するリストで文書ごとに一致した n-gram の種類数を数える
+	// 文書数分の計数の配列はスレッドごとに使い回し、一致した文書の分だけ0に戻す
+	// （検索のたびに辞書の大きさの配列を確保して全体を走査しない）
+	thread_local std::vector<uint16_t> hits;
+	thread_local std::vector<uint32_t> touched;
+	if (hits.size() < size_) hits.resize(size_);
+	touched.clear();
+	for (size_t i = 0; i < scanned; ++i) {
+		for (auto id : *lists[i]) {
+			if (!hits[id]++) touched.push_back(id);
+		}
+	}
+	std::sort(touched.begin(), touched.end());
+
+	// 除いたリストは候補の昇順に前から二分探索する
+	std::pmr::vector<std::vector<uint32_t>::const_iterator> cursors(resource);
+	cursors.reserve(lists.size() - scanned);
+	for (size_t i = scanned; i < lists.size(); ++i) {
+		cursors.push_back(lists[i]->begin());
+	}
+
+	const auto& counts = gram_counts_[n - min_gram_];
+	for (auto id : touched) {
+		size_t shared = hits[id];
+		hits[id] = 0;
+		for (size_t i = scanned; i < lists.size(); ++i) {
+			auto& cursor = cursors[i - scanned];
+			cursor = std::lower_bound(cursor, lists[i]->end(), id);
+			if (cursor != lists[i]->end() && *cursor == id) ++shared;
+		}
+		auto base = std::min(total, static_cast<size_t>(counts[id]));
+		if (shared >= std::ceil(ratio * static_cast<double>(base))) {
+			result.push_back(id);
+		}
+	}
+	return result;
+}
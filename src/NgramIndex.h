@@ -0,0 +1,58 @@
+﻿#pragma once
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// 文字 n-gram による転置インデックス
+// 文書IDは追加順に振られ、各ポスティングリストは文書IDの昇順になる
+// （人気の高い順に追加すれば、ポスティングリストも人気順になる）
+class NgramIndex {
+public:
+	// minGram～maxGram 文字の n-gram を索引に登録する
+	// 検索語が maxGram 文字以上なら maxGram 文字の n-gram で、それより短ければ検索語全体で引く
+	NgramIndex(size_t minGram, size_t maxGram);
+
+	// 索引を空にする
+	void Clear();
+
+	// 文書を追加して文書IDを返す
+	uint32_t Add(std::wstring_view text);
+
+	// 文書数
+	size_t Size() const { return size_; }
+
+	// 検索語の n-gram を全て含む文書（文書IDの昇順）
+	// 結果と作業用の配列は resource から確保する（FindSimilar も同じ）
+	std::pmr::vector<uint32_t> FindAll(std::wstring_view query,
+		std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+
+	// 検索語と n-gram を共有する割合が ratio 以上の文書（文書IDの昇順）
+	// 割合は検索語と文書のうち n-gram の種類が少ない方を基準にする
+	// 多くの文書に現れる n-gram のリストは走査しないので、検索語より n-gram の種類が少ない文書はそれ以外の n-gram を共有するものだけを返す
+	// gram には引く n-gram の文字数を指定する（0なら FindAll と同じ、検索語がそれより短ければ検索語の長さ）
+	std::pmr::vector<uint32_t> FindSimilar(std::wstring_view query, double ratio, size_t gram = 0,
+		std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+
+private:
+	static constexpr size_t MAX_GRAM = 3; // キーに詰められる最大文字数（1文字16ビット）
+	static constexpr size_t SHORT_POSTINGS = 256; // FindSimilar で常に走査するポスティングリストの長さ
+
+	size_t min_gram_;
+	size_t max_gram_;
+	size_t size_ = 0;
+	std::unordered_map<uint64_t, std::vector<uint32_t>> postings_;
+	std::vector<std::vector<uint16_t>> gram_counts_; // [n - min_gram_][文書ID] → n-gram の種類数
+
+	// n-gram のキー
+	static uint64_t MakeKey(std::wstring_view gram);
+
+	// 検索語から引く n-gram の文字数（引けない場合は0）
+	size_t QueryGram(std::wstring_view query, size_t gram) const;
+
+	// 検索語から引くポスティングリスト（重複なし、見つからないものは nullptr）
+	std::pmr::vector<const std::vector<uint32_t>*> QueryPostings(std::wstring_view query, size_t gram,
+		std::pmr::memory_resource* resource) const;
+};
@@ -0,0 +1,186 @@
+﻿#include "framework.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+#include "PartialRatio.h"
+
+CachedPartialRatioScorer::Pattern::Pattern(std::pmr::memory_resource* resource)
+	: chars_(resource), masks_(resource), s_(resource) {
+}
+
+// 比較元を設定
+void CachedPartialRatioScorer::Pattern::Assign(std::wstring_view s) {
+	length_ = s.size();
+	blocks_ = (s.size() + 63) / 64;
+	chars_.assign(s.begin(), s.end());
+	std::sort(chars_.begin(), chars_.end());
+	chars_.erase(std::unique(chars_.begin(), chars_.end()), chars_.end());
+	masks_.assign(chars_.size() * blocks_, 0);
+	for (size_t i = 0; i < s.size(); ++i) {
+		size_t c = std::lower_bound(chars_.begin(), chars_.end(), s[i]) - chars_.begin();
+		masks_[c * blocks_ + i / 64] |= uint64_t(1) << (i % 64);
+	}
+	s_.resize(blocks_);
+}
+
+// 比較元に含まれる文字か
+bool CachedPartialRatioScorer::Pattern::Contains(wchar_t c) const {
+	return std::binary_search(chars_.begin(), chars_.end(), c);
+}
+
+// 文字のビット列
+const uint64_t* CachedPartialRatioScorer::Pattern::Find(wchar_t c) const {
+	auto it = std::lower_bound(chars_.begin(), chars_.end(), c);
+	if (it == chars_.end() || *it != c) return nullptr;
+	return masks_.data() + (it - chars_.begin()) * blocks_;
+}
+
+// Indel 距離
+// 最長共通部分列の長さ（Hyyrö のビット並列アルゴリズム）から求める（CachedIndelDistance と同じ計算）
+// 比較元に無い文字ではビット列が変わらないので飛ばす
+size_t CachedPartialRatioScorer::Pattern::Distance(std::wstring_view s2) const {
+	std::fill(s_.begin(), s_.end(), ~uint64_t(0));
+	for (auto c : s2) {
+		const uint64_t* mask = Find(c);
+		if (!mask) continue;
+		uint64_t carry = 0;
+		for (size_t w = 0; w < blocks_; ++w) {
+			uint64_t u = s_[w] & mask[w];
+			uint64_t sum = s_[w] + u;
+			uint64_t x = sum + carry;
+			carry = (sum < u) || (x < sum);
+			s_[w] = x | (s_[w] - u);
+		}
+	}
+	size_t lcs = 0;
+	for (auto bits : s_) {
+		lcs += std::popcount(~bits);
+	}
+	return length_ + s2.size() - 2 * lcs;
+}
+
+// 類似度
+// rapidfuzz の CachedRatio::similarity（正規化した Indel 類似度）と同じ丸めで求める
+// 上限を超える距離は rapidfuzz では上限 + 1 になるが、どちらも正規化すると上限を超えるので結果は変わらない
+double CachedPartialRatioScorer::Pattern::Ratio(std::wstring_view s2, double score_cutoff) const {
+	double cutoff = score_cutoff / 100;
+	double cutoff_dist = std::min(1.0, 1.0 - cutoff + 0.00001);
+	size_t maximum = length_ + s2.size();
+	double dist = static_cast<double>(Distance(s2));
+	double norm_dist = maximum != 0 ? dist / static_cast<double>(maximum) : 0.0;
+	if (norm_dist > cutoff_dist) norm_dist = 1.0;
+	double norm_sim = 1.0 - norm_dist;
+	return (norm_sim >= cutoff ? norm_sim : 0.0) * 100;
+}
+
+CachedPartialRatioScorer::CachedPartialRatioScorer(std::wstring_view s1, std::pmr::memory_resource* resource)
+	: s1_(s1, resource), pattern_(resource), swapped_(resource), scores_(resource), windows_(resource), new_windows_(resource) {
+	pattern_.Assign(s1_);
+}
+
+// 類似度
+// rapidfuzz::fuzz::CachedPartialRatio::similarity と同じ手順
+// 比較元の方が長ければ比較先を比較元にし、同じ長さで100に届かなければ入れ替えても求めて高い方を返す
+double CachedPartialRatioScorer::Similarity(std::wstring_view s2, double score_cutoff) const {
+	size_t len1 = s1_.size();
+	size_t len2 = s2.size();
+	if (score_cutoff > 100) return 0;
+
+	if (len1 > len2) {
+		if (!len2) return 0;
+		swapped_.Assign(s2);
+		return PartialRatio(swapped_, s2, s1_, score_cutoff);
+	}
+
+	if (!len1 || !len2) return len1 == len2 ? 100.0 : 0.0;
+
+	double score = PartialRatio(pattern_, s1_, s2, score_cutoff);
+	if (score != 100 && len1 == len2) {
+		score_cutoff = std::max(score_cutoff, score);
+		swapped_.Assign(s2);
+		double score2 = PartialRatio(swapped_, s2, s1_, score_cutoff);
+		if (score2 > score) return score2;
+	}
+	return score;
+}
+
+// 短い方の文字列と最もよく一致する長い方の部分文字列との類似度
+// 長い方の同じ長さの窓は二分しながら距離の下限で枝刈りし、両端からはみ出す位置は前後の部分文字列と比べる
+double CachedPartialRatioScorer::PartialRatio(const Pattern& pattern, std::wstring_view needle, std::wstring_view haystack,
+	double score_cutoff) const {
+	constexpr size_t UNKNOWN = std::numeric_limits<size_t>::max();
+	size_t len1 = needle.size();
+	size_t len2 = haystack.size();
+	double result = 0;
+
+	if (len2 > len1) {
+		size_t maximum = len1 * 2;
+		double norm_cutoff_sim = std::min(1.0, 1.0 - score_cutoff / 100 + 0.00001);
+		size_t cutoff_dist = static_cast<size_t>(std::ceil(static_cast<double>(maximum) * norm_cutoff_sim));
+		size_t best_dist = UNKNOWN;
+		scores_.assign(len2 - len1, UNKNOWN);
+		windows_.clear();
+		windows_.emplace_back(0, len2 - len1 - 1);
+		new_windows_.clear();
+
+		// 窓の距離を求め、上限を下回れば最良とする（完全に一致すれば true）
+		auto measure = [&](size_t start) {
+			if (scores_[start] != UNKNOWN) return false;
+			scores_[start] = pattern.Distance(haystack.substr(start, len1));
+			if (scores_[start] < cutoff_dist) {
+				cutoff_dist = best_dist = scores_[start];
+				if (best_dist == 0) return true;
+			}
+			return false;
+		};
+		while (!windows_.empty()) {
+			for (const auto& [first, second] : windows_) {
+				if (measure(first) || measure(second)) return 100;
+
+				size_t cell_diff = second - first;
+				if (cell_diff == 1) continue;
+
+				// 窓の範囲で取りうる最小の距離
+				size_t known_edits = scores_[first] > scores_[second] ? scores_[first] - scores_[second] : scores_[second] - scores_[first];
+				size_t max_score_improvement = (cell_diff - known_edits / 2) / 2 * 2;
+				ptrdiff_t min_score = static_cast<ptrdiff_t>(std::min(scores_[first], scores_[second]))
+					- static_cast<ptrdiff_t>(max_score_improvement);
+				if (min_score < static_cast<ptrdiff_t>(cutoff_dist)) {
+					size_t center = cell_diff / 2;
+					new_windows_.emplace_back(first, first + center);
+					new_windows_.emplace_back(first + center, second);
+				}
+			}
+			windows_.swap(new_windows_);
+			new_windows_.clear();
+		}
+
+		double score = (1.0 - static_cast<double>(best_dist) / static_cast<double>(maximum)) * 100;
+		if (score >= score_cutoff) score_cutoff = result = score;
+	}
+
+	// 長い方の先頭から短い方より短い範囲
+	for (size_t i = 1; i < len1; ++i) {
+		auto sub = haystack.substr(0, i);
+		if (!pattern.Contains(sub.back())) continue;
+		double ratio = pattern.Ratio(sub, score_cutoff);
+		if (ratio > result) {
+			score_cutoff = result = ratio;
+			if (result == 100.0) return result;
+		}
+	}
+
+	// 長い方の末尾までの短い方より短い範囲
+	for (size_t i = len2 - len1; i < len2; ++i) {
+		auto sub = haystack.substr(i);
+		if (!pattern.Contains(sub.front())) continue;
+		double ratio = pattern.Ratio(sub, score_cutoff);
+		if (ratio > result) {
+			score_cutoff = result = ratio;
+			if (result == 100.0) return result;
+		}
+	}
+	return result;
+}
@@ -0,0 +1,58 @@
+﻿#pragma once
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+#include <utility>
+
+// 比較元を固定した partial_ratio（ワイド文字列）
+// 結果は rapidfuzz::fuzz::CachedPartialRatio<wchar_t> の similarity と一致する
+// 比較元の文字ごとの出現位置をビット列（64文字ごとのブロック）にしておき、ビット並列で Indel 距離を求める
+// ビット列と作業用の配列は resource から確保して使い回す（検索ごとの作業領域を渡せばヒープから確保しない）
+class CachedPartialRatioScorer {
+public:
+	CachedPartialRatioScorer(std::wstring_view s1, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+	// 類似度（0～100、score_cutoff 未満は0）
+	double Similarity(std::wstring_view s2, double score_cutoff = 0.0) const;
+
+private:
+	// 文字ごとの出現位置のビット列
+	class Pattern {
+	public:
+		explicit Pattern(std::pmr::memory_resource* resource);
+
+		// 比較元を設定する（確保済みの配列を使い回す）
+		void Assign(std::wstring_view s);
+
+		// 比較元に含まれる文字か
+		bool Contains(wchar_t c) const;
+
+		// Indel 距離
+		size_t Distance(std::wstring_view s2) const;
+
+		// rapidfuzz::fuzz::ratio と同じ類似度（0～100、score_cutoff 未満は0）
+		double Ratio(std::wstring_view s2, double score_cutoff) const;
+
+	private:
+		size_t length_ = 0;
+		size_t blocks_ = 0;
+		std::pmr::wstring chars_;          // 比較元に含まれる文字（昇順、重複なし）
+		std::pmr::vector<uint64_t> masks_; // 文字ごとのビット列（chars_ の位置 * blocks_ + ブロック）
+		mutable std::pmr::vector<uint64_t> s_; // 計算用のビット列（使い回し）
+
+		// 文字のビット列（比較元に無ければ nullptr）
+		const uint64_t* Find(wchar_t c) const;
+	};
+
+	std::pmr::wstring s1_;
+	Pattern pattern_;
+	mutable Pattern swapped_; // 比較先を比較元にして求める場合（使い回し）
+
+	// 比較元より長い比較先の窓の距離と、探索する窓の範囲（使い回し）
+	mutable std::pmr::vector<size_t> scores_;
+	mutable std::pmr::vector<std::pair<size_t, size_t>> windows_;
+	mutable std::pmr::vector<std::pair<size_t, size_t>> new_windows_;
+
+	// rapidfuzz の fuzz_detail::partial_ratio_impl と同じ計算（needle は haystack 以下の長さ）
+	double PartialRatio(const Pattern& pattern, std::wstring_view needle, std::wstring_view haystack, double score_cutoff) const;
+};
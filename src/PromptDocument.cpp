@@ -0,0 +1,86 @@
+﻿#include "framework.h"
+#include <algorithm>
+
+#include "PromptDocument.h"
+#include "TextUtils.h"
+
+// 編集を反映する
+void PromptDocument::Edit(size_t position, size_t deletedLength, std::string_view inserted) {
+	const auto& text = tokenizer_.Text();
+	position = std::min(position, text.size());
+	deletedLength = std::min(deletedLength, text.size() - position);
+	if (deletedLength == 0 && inserted.empty()) return;
+
+	tokenizer_.Edit(position, deletedLength, inserted);
+	const size_t parsedEnd = tokenizer_.LastRelexedEnd();
+	history_.push_back({ ++version_, position, deletedLength, inserted.size(), parsedEnd - tokenizer_.LastRelexedLength(), parsedEnd });
+	if (history_.size() > MAX_HISTORY) {
+		history_.pop_front();
+	}
+}
+
+// 新しいテキストとの差分を反映する
+bool PromptDocument::Update(const std::string& text) {
+	size_t position, deletedLength, insertedLength;
+	if (!find_changed_range(tokenizer_.Text(), text, position, deletedLength, insertedLength)) {
+		return false;
+	}
+	Edit(position, deletedLength, std::string_view(text).substr(position, insertedLength));
+	return true;
+}
+
+// position を含むか、position より後ろで最初のタグの範囲
+size_t PromptDocument::SpanIndexAt(size_t position) const {
+	const auto& spans = tokenizer_.Spans();
+	return std::upper_bound(spans.begin(), spans.end(), position,
+		[](size_t value, const TagSpan& span) { return value < span.end; }) - spans.begin();
+}
+
+// カーソル位置の前後の区切りの間の範囲
+std::tuple<size_t, size_t> PromptDocument::WordRangeAt(size_t position) const {
+	return get_span_at_cursor(tokenizer_.Text(), static_cast<int>(position));
+}
+
+// version より後の変更
+bool PromptDocument::ChangesSince(uint64_t version, std::vector<DocumentChange>& changes) const {
+	changes.clear();
+	if (version >= version_) return true;
+	if (history_.empty() || history_.front().version > version + 1) return false;
+	for (const auto& change : history_) {
+		if (change.version > version) {
+			changes.push_back(change);
+		}
+	}
+	return true;
+}
+
+// version より後の変更をまとめた範囲
+// 変更ごとに、それまでの範囲を変更後の位置に移してから変更した範囲と合わせる
+std::tuple<size_t, size_t> PromptDocument::ChangedRangeSince(uint64_t version) const {
+	if (version >= version_) return { 0, 0 };
+	if (history_.empty() || history_.front().version > version + 1) return { 0, Text().size() };
+
+	bool any = false;
+	size_t start = 0;
+	size_t end = 0;
+	for (const auto& change : history_) {
+		if (change.version <= version) continue;
+		const size_t changeStart = std::min(change.position, change.parsedStart);
+		const size_t changeEnd = std::max(change.position + change.insertedLength, change.parsedEnd);
+		if (!any) {
+			start = changeStart;
+			end = changeEnd;
+			any = true;
+			continue;
+		}
+		// 変更より後ろの位置はずらし、削除された範囲の中の位置は挿入した範囲の末尾に寄せる
+		if (end >= change.position + change.deletedLength) {
+			end = end - change.deletedLength + change.insertedLength;
+		} else if (end > change.position) {
+			end = changeEnd;
+		}
+		start = std::min(start, changeStart);
+		end = std::max(end, changeEnd);
+	}
+	return { start, end };
+}
@@ -0,0 +1,65 @@
+﻿#pragma once
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+#include "Tag.h"
+#include "IncrementalTokenizer.h"
+
+// プロンプトの1回の変更（position から deletedLength バイトを insertedLength バイトで置き換えた）
+struct DocumentChange {
+	uint64_t version; // 変更後の版
+	size_t position;
+	size_t deletedLength;
+	size_t insertedLength;
+	size_t parsedStart; // 解析し直した範囲（これより前のタグは同じで、後ろのタグは位置がずれただけ）
+	size_t parsedEnd;
+};
+
+// プロンプトの文書モデル
+// テキストとその版、タグの範囲の表を持ち、変更のたびに1回だけ解析する
+// ハイライト、タグリスト、サジェストはそれぞれ解析せずにこの表を参照し、
+// 前に参照した版からの変更を ChangesSince / ChangedRangeSince で求める
+class PromptDocument {
+public:
+	// 保持する変更の履歴の数（これより古い版からの変更は求められない）
+	static constexpr size_t MAX_HISTORY = 64;
+
+	// 編集を反映する（position から deletedLength バイトを inserted で置き換える）
+	void Edit(size_t position, size_t deletedLength, std::string_view inserted);
+
+	// 新しいテキストとの差分を1つの編集として反映する（変更がなければ false で、版も変わらない）
+	bool Update(const std::string& text);
+
+	// 現在の版（変更のたびに1ずつ増える。空の文書は0）
+	uint64_t Version() const { return version_; }
+
+	// 現在のテキストとタグの範囲
+	const std::string& Text() const { return tokenizer_.Text(); }
+	const TagSpanList& Spans() const { return tokenizer_.Spans(); }
+
+	// 現在のタグ（文字列を作る）
+	TagList Tags() const { return tokenizer_.Tags(); }
+
+	// position を含むか、position より後ろで最初のタグの範囲の Spans() 内の位置
+	size_t SpanIndexAt(size_t position) const;
+
+	// カーソル位置の前後の区切り（カンマ、改行）の間の範囲（get_span_at_cursor と同じ）
+	std::tuple<size_t, size_t> WordRangeAt(size_t position) const;
+
+	// version より後の変更を古い順に changes に入れる
+	// 履歴が version まで遡れなければ false（テキスト全体が変わったものとして扱う）
+	bool ChangesSince(uint64_t version, std::vector<DocumentChange>& changes) const;
+
+	// version より後の変更をまとめた、現在のテキストでの範囲 [start, end)
+	// テキストが変わった範囲に加え、タグの区切りが変わりうる解析し直した範囲を含む
+	// 変更がなければ空の範囲、履歴が遡れなければテキスト全体を返す
+	std::tuple<size_t, size_t> ChangedRangeSince(uint64_t version) const;
+
+private:
+	IncrementalTokenizer tokenizer_;
+	uint64_t version_ = 0;
+	std::deque<DocumentChange> history_; // 古い順
+};
@@ -2,7 +2,10 @@
 #include "PromptEditor.h"
 #include <Scintilla.h>
 #include <windowsx.h>
+#include <algorithm>
 #include <vector>
+#include <cstdio>
+#include <utility>
 #include "TextUtils.h"
 
 const int FONT_SIZE = 11;
@@ -29,7 +32,19 @@ const int STYLE_BRACKET = 10;
 const COLORREF BRACKET_BACKGROUND_COLOR = RGB(0, 60, 100);
 const COLORREF BRACKET_TEXT_COLOR = RGB(255, 255, 255);
 
-PromptEditor::PromptEditor() : m_hwnd(nullptr), m_originalProc(nullptr) {}
+// インライン補完用スタイル番号
+const int STYLE_GHOST = 11;
+
+// インライン補完の文字色
+const COLORREF GHOST_TEXT_COLOR = RGB(110, 110, 110);
+
+// インライン補完の制限時間（1フレーム 16ms のうち、再描画の分を残す）
+const std::chrono::microseconds GHOST_BUDGET(2000);
+
+// インライン補完の所要時間をログに出す間隔（回数）
+const size_t GHOST_LOG_INTERVAL = 256;
+
+PromptEditor::PromptEditor() : m_hwnd(nullptr), m_styledVersion(0), m_styledEnd(0), m_procDepth(0), m_pendingChange(false), m_ghostLine(-1), m_swallowTab(false), m_originalProc(nullptr) {}
 
 PromptEditor::~PromptEditor() {}
 
@@ -59,9 +74,16 @@ bool PromptEditor::Initialize(HWND hwndParent, int x, int y, int width, int heig
 	return true;
 }
 
+// プログラムからテキストを設定する
+// 文書には SCN_MODIFIED で反映するが、変更のコールバックは呼ばない
+// （SCI_SETTEXT は全体の削除と挿入の2回通知するので、途中の空の文書でも呼んでしまう。
+//   タグリストやサジェストの更新は呼び出し側が行う）
 void PromptEditor::SetText(const std::string& text) {
+	bool pendingChange = m_pendingChange;
+	++m_procDepth;
 	SendMessage(m_hwnd, SCI_SETTEXT, 0, (LPARAM)text.c_str());
-	ApplySyntaxHighlighting(text);
+	--m_procDepth;
+	m_pendingChange = pendingChange;
 }
 
 std::string PromptEditor::GetText() const {
@@ -71,22 +93,128 @@ std::string PromptEditor::GetText() const {
 	return std::string(buffer.data());
 }
 
-void PromptEditor::ApplySyntaxHighlighting(const std::string& text) {
-	auto tags = extract_tags_from_text(text);
-	SendMessage(m_hwnd, SCI_STARTSTYLING, 0, 0);
-	SendMessage(m_hwnd, SCI_SETSTYLING, (int)SendMessage(m_hwnd, SCI_GETLENGTH, 0, 0), STYLE_DEFAULT);
-	int index = 0;
-	for (const auto& tag : tags) {
+// 親ウィンドウに届く Scintilla の通知
+void PromptEditor::OnNotify(const NMHDR* header) {
+	auto notification = reinterpret_cast<const SCNotification*>(header);
+	switch (notification->nmhdr.code) {
+	case SCN_MODIFIED:
+		if (notification->modificationType & (SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT)) {
+			OnModified(static_cast<size_t>(notification->position), static_cast<size_t>(notification->length),
+				notification->text, (notification->modificationType & SC_MOD_INSERTTEXT) != 0);
+		}
+		break;
+	case SCN_STYLENEEDED:
+		OnStyleNeeded(static_cast<size_t>(notification->position));
+		break;
+	}
+}
+
+// 挿入・削除を文書に反映する
+void PromptEditor::OnModified(size_t position, size_t length, const char* text, bool inserted) {
+	if (inserted && text == nullptr) {
+		// 挿入した文字列が届かなければテキスト全体との差分を反映する
+		m_document.Update(GetText());
+	} else if (inserted) {
+		m_document.Edit(position, 0, std::string_view(text, length));
+	} else {
+		m_document.Edit(position, length, std::string_view());
+	}
+
+	// 元のプロシージャの処理中ならキャレットが動くのを待つ（ScintillaProc で呼ぶ）
+	if (m_procDepth > 0) {
+		m_pendingChange = true;
+	} else if (m_textChangeCallback) {
+		m_textChangeCallback();
+	}
+}
+
+// スタイルが付いていない位置から endNeeded までスタイルを付ける
+// 直前のタグの後ろから付け直し、変更された範囲より後ろで色の巡回が前と揃ったら、
+// そこから前にスタイルを付けた範囲の末尾までは前のスタイルをそのまま使う（入力1文字の手間はプロンプトの長さによらない）
+void PromptEditor::OnStyleNeeded(size_t endNeeded) {
+	const auto& text = m_document.Text();
+	const auto& spans = m_document.Spans();
+	if ((size_t)SendMessage(m_hwnd, SCI_GETLENGTH, 0, 0) != text.size()) {
+		// 文書への反映がまだ（反映した後の通知で付ける）
+		return;
+	}
+	endNeeded = std::min(endNeeded, text.size());
+
+	// 前にスタイルを付けてからの変更
+	const bool changed = m_styledVersion != m_document.Version();
+	const auto [changedStart, changedEnd] = m_document.ChangedRangeSince(m_styledVersion);
+	size_t previousEnd = 0;
+	if (m_document.ChangesSince(m_styledVersion, m_changes)) {
+		// 前にスタイルを付けた範囲の末尾を変更に合わせてずらす（削除された範囲にかかれば削除した位置まで）
+		previousEnd = m_styledEnd;
+		for (const auto& change : m_changes) {
+			if (previousEnd >= change.position + change.deletedLength) {
+				previousEnd = previousEnd - change.deletedLength + change.insertedLength;
+			} else if (previousEnd > change.position) {
+				previousEnd = change.position;
+			}
+		}
+	}
+
+	// スタイルが付いている位置（タグの区切りが変わった範囲があればその先頭）を含むタグの直前のタグの後ろから付け直す
+	auto endStyled = (size_t)SendMessage(m_hwnd, SCI_GETENDSTYLED, 0, 0);
+	if (changed) {
+		endStyled = std::min(endStyled, changedStart);
+	}
+	size_t index = m_document.SpanIndexAt(endStyled);
+	size_t position = index > 0 ? spans[index - 1].end : 0;
+
+	// 色の巡回の位置は、直前の通常のタグのスタイルから求める
+	int color = 0;
+	for (size_t i = index; i > 0; --i) {
+		if (!is_bracket_span(text, spans[i - 1])) {
+			auto style = (int)SendMessage(m_hwnd, SCI_GETSTYLEAT, spans[i - 1].start, 0);
+			if (style >= 1 && style <= _countof(TAG_COLORS)) color = style;
+			break;
+		}
+	}
+
+	SendMessage(m_hwnd, SCI_STARTSTYLING, position, 0);
+	bool resynced = false;
+	for (; index < spans.size() && spans[index].start < endNeeded; ++index) {
+		const auto& span = spans[index];
+		// タグの前の区切り
+		SendMessage(m_hwnd, SCI_SETSTYLING, span.start - position, STYLE_DEFAULT);
+		position = span.start;
+
 		int style;
-		if (is_bracket_tag(tag.tag)) {
+		if (is_bracket_span(text, span)) {
 			// 括弧記号は専用スタイル
 			style = STYLE_BRACKET;
 		} else {
 			// 通常のタグは色をローテーション
-			style = (index++ % _countof(TAG_COLORS)) + 1;
+			style = (color++ % _countof(TAG_COLORS)) + 1;
+			// 変更された範囲より後ろで前と同じ色なら、ここから後ろは前のスタイルのままでよい
+			if (changed && span.start >= changedEnd && span.end <= previousEnd &&
+				style == (int)SendMessage(m_hwnd, SCI_GETSTYLEAT, span.start, 0)) {
+				resynced = true;
+				break;
+			}
 		}
-		SendMessage(m_hwnd, SCI_STARTSTYLING, tag.start, 0);
-		SendMessage(m_hwnd, SCI_SETSTYLING, tag.end - tag.start, style);
+		SendMessage(m_hwnd, SCI_SETSTYLING, span.end - span.start, style);
+		position = span.end;
+	}
+
+	if (resynced) {
+		// 前のスタイルが残っている範囲までスタイルが付いたことにする
+		SendMessage(m_hwnd, SCI_STARTSTYLING, previousEnd, 0);
+	} else {
+		// 次のタグの前（最後のタグなら末尾）までの区切り
+		size_t next = index < spans.size() ? spans[index].start : text.size();
+		SendMessage(m_hwnd, SCI_SETSTYLING, next - position, STYLE_DEFAULT);
+	}
+
+	m_styledVersion = m_document.Version();
+	m_styledEnd = (size_t)SendMessage(m_hwnd, SCI_GETENDSTYLED, 0, 0);
+
+	// 前のスタイルが残っている範囲が必要な位置まで届かなければ、その先を続けて付ける
+	if (resynced && m_styledEnd < endNeeded) {
+		OnStyleNeeded(endNeeded);
 	}
 }
 
@@ -111,7 +239,17 @@ void PromptEditor::SetTextChangeCallback(std::function<void()> callback) {
 	m_textChangeCallback = callback;
 }
 
+void PromptEditor::SetCompletionProvider(CompletionProvider provider) {
+	m_completionProvider = provider;
+}
+
 void PromptEditor::SetupStyles() {
+	// ハイライトは SCN_STYLENEEDED でこちらから付ける（字句解析器を使わない）
+	SendMessage(m_hwnd, SCI_SETILEXER, 0, 0);
+
+	// 変更の通知は挿入と削除だけ（スタイルの変更などは通知しない）
+	SendMessage(m_hwnd, SCI_SETMODEVENTMASK, SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT, 0);
+
 	// フォントサイズ
 	SendMessage(m_hwnd, SCI_STYLESETSIZE, 0, FONT_SIZE);
 	SendMessage(m_hwnd, SCI_STYLESETSIZE, STYLE_DEFAULT, FONT_SIZE);
@@ -135,6 +273,12 @@ void PromptEditor::SetupStyles() {
 	SendMessage(m_hwnd, SCI_STYLESETBACK, STYLE_BRACKET, BRACKET_BACKGROUND_COLOR);
 	SendMessage(m_hwnd, SCI_STYLESETFORE, STYLE_BRACKET, BRACKET_TEXT_COLOR);
 
+	// インライン補完用スタイル（行末の注釈として枠なしで表示する）
+	SendMessage(m_hwnd, SCI_STYLESETBACK, STYLE_GHOST, BACKGROUND_COLOR);
+	SendMessage(m_hwnd, SCI_STYLESETFORE, STYLE_GHOST, GHOST_TEXT_COLOR);
+	SendMessage(m_hwnd, SCI_STYLESETSIZE, STYLE_GHOST, FONT_SIZE);
+	SendMessage(m_hwnd, SCI_EOLANNOTATIONSETVISIBLE, EOLANNOTATION_STANDARD, 0);
+
 	// 選択範囲の色設定
 	SendMessage(m_hwnd, SCI_SETSELBACK, TRUE, TEXT_COLOR);
 	SendMessage(m_hwnd, SCI_SETSELFORE, TRUE, BACKGROUND_COLOR);
@@ -155,22 +299,113 @@ void PromptEditor::SetupStyles() {
 	SendMessage(m_hwnd, SCI_SETVIEWWS, SCWS_INVISIBLE, 0);
 }
 
-void PromptEditor::OnTextChanged() {
-	std::string currentText = GetText();
-	if (currentText != m_lastText) {
-		m_lastText = currentText;
-		ApplySyntaxHighlighting(currentText);
-		if (m_textChangeCallback) {
-			m_textChangeCallback();
+// キャレットの位置に応じてインライン補完を更新
+// キャレットが行末にあり、選択範囲がないときだけ表示する（行末の注釈として描画するため）
+void PromptEditor::UpdateGhostText() {
+	if (!m_completionProvider) return;
+	auto started = std::chrono::steady_clock::now();
+
+	std::string completion;
+	std::string prefix;
+	auto caret = (Sci_Position)SendMessage(m_hwnd, SCI_GETCURRENTPOS, 0, 0);
+	auto anchor = (Sci_Position)SendMessage(m_hwnd, SCI_GETANCHOR, 0, 0);
+	auto line = (int)SendMessage(m_hwnd, SCI_LINEFROMPOSITION, caret, 0);
+	auto lineEnd = (Sci_Position)SendMessage(m_hwnd, SCI_GETLINEENDPOSITION, line, 0);
+	if (caret == anchor && caret == lineEnd) {
+		// 行頭からキャレットまでのうち、最後のカンマより後ろが入力中のタグ
+		auto length = (int)SendMessage(m_hwnd, SCI_GETCURLINE, 0, 0);
+		std::vector<char> buffer(length + 2);
+		auto column = (int)SendMessage(m_hwnd, SCI_GETCURLINE, length + 1, (LPARAM)buffer.data());
+		std::string text(buffer.data(), column);
+
+		auto comma = text.find_last_of(',');
+		prefix = text.substr(comma == std::string::npos ? 0 : comma + 1);
+		prefix.erase(0, prefix.find_first_not_of(' '));
+		if (!prefix.empty()) {
+			completion = m_completionProvider(prefix, GHOST_BUDGET);
 		}
 	}
+
+	ClearGhostText();
+	if (completion.size() > prefix.size() && completion.starts_with(prefix)) {
+		m_ghostText = completion.substr(prefix.size());
+		m_ghostLine = line;
+		SendMessage(m_hwnd, SCI_EOLANNOTATIONSETTEXT, line, (LPARAM)m_ghostText.c_str());
+		SendMessage(m_hwnd, SCI_EOLANNOTATIONSETSTYLE, line, STYLE_GHOST);
+	}
+
+	// 入力から表示までの時間を記録し、一定回数ごとに分布をログに出す
+	auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started);
+	m_ghostLatency.Record(elapsed);
+	if (m_ghostLatency.Count() % GHOST_LOG_INTERVAL == 0) {
+		char message[128];
+		snprintf(message, sizeof(message), "ghost completion: %llu samples, p50 %lldus, p99 %lldus, max %lldus\n",
+			static_cast<unsigned long long>(m_ghostLatency.Count()),
+			static_cast<long long>(m_ghostLatency.Percentile(50).count()),
+			static_cast<long long>(m_ghostLatency.Percentile(99).count()),
+			static_cast<long long>(m_ghostLatency.Max().count()));
+		OutputDebugStringA(message);
+	}
+}
+
+// インライン補完を消す
+void PromptEditor::ClearGhostText() {
+	if (m_ghostLine >= 0) {
+		SendMessage(m_hwnd, SCI_EOLANNOTATIONSETTEXT, m_ghostLine, 0);
+	}
+	m_ghostText.clear();
+	m_ghostLine = -1;
+}
+
+// インライン補完を確定する
+void PromptEditor::AcceptGhostText() {
+	if (m_ghostText.empty()) return;
+	std::string text = m_ghostText;
+	ClearGhostText();
+	SendMessage(m_hwnd, SCI_ADDTEXT, text.size(), (LPARAM)text.c_str());
+	UpdateGhostText();
 }
 
 LRESULT CALLBACK PromptEditor::ScintillaProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
 	PromptEditor* self = (PromptEditor*)GetWindowLongPtr(hwnd, GWLP_USERDATA);
 	if (!self) return CallWindowProc(DefWindowProc, hwnd, uMsg, wParam, lParam);
-	if (uMsg == WM_CHAR || uMsg == WM_PASTE || uMsg == WM_CUT || uMsg == WM_CLEAR || uMsg == WM_KEYDOWN) {
-		self->OnTextChanged();
+
+	// Tab でインライン補完を確定、Esc で取り消す
+	if (uMsg == WM_KEYDOWN && !self->m_ghostText.empty()) {
+		if (wParam == VK_TAB) {
+			self->AcceptGhostText();
+			self->m_swallowTab = true;
+			return 0;
+		}
+		if (wParam == VK_ESCAPE) {
+			self->ClearGhostText();
+			return 0;
+		}
+	}
+	// 確定に使った Tab の文字は入力しない
+	if (uMsg == WM_CHAR && std::exchange(self->m_swallowTab, false) && wParam == '\t') {
+		return 0;
+	}
+
+	// テキストの変更は SCN_MODIFIED で文書に反映し、コールバックは元のプロシージャの処理を終えてから呼ぶ
+	// （キャレットの移動だけのキー入力では何もしない）
+	++self->m_procDepth;
+	LRESULT result = CallWindowProc(self->m_originalProc, hwnd, uMsg, wParam, lParam);
+	--self->m_procDepth;
+	if (self->m_procDepth == 0 && std::exchange(self->m_pendingChange, false) && self->m_textChangeCallback) {
+		self->m_textChangeCallback();
+	}
+
+	// インライン補完は元のプロシージャが入力を反映した後のテキストで求める
+	// 文字を入力するキーは TranslateMessage が WM_CHAR を積んでいるので、WM_KEYDOWN では求めずに WM_CHAR で1回だけ求める
+	// （WM_KEYDOWN で求めるのはキャレットの移動や Delete など、文字を入力しないキーのとき）
+	if (uMsg == WM_KEYDOWN) {
+		MSG next;
+		if (!PeekMessage(&next, hwnd, WM_CHAR, WM_CHAR, PM_NOREMOVE)) {
+			self->UpdateGhostText();
+		}
+	} else if (uMsg == WM_CHAR || uMsg == WM_PASTE || uMsg == WM_CUT || uMsg == WM_CLEAR || uMsg == WM_LBUTTONDOWN) {
+		self->UpdateGhostText();
 	}
-	return CallWindowProc(self->m_originalProc, hwnd, uMsg, wParam, lParam);
+	return result;
 }
@@ -1,9 +1,12 @@
 ﻿#pragma once
 #include <string>
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <vector>
 #include "Tag.h"
+#include "LatencyHistogram.h"
+#include "PromptDocument.h"
 
 class PromptEditor {
 public:
@@ -15,7 +18,6 @@ public:
 	void SetText(const std::string& text);
     std::string GetText() const;
 
-	void ApplySyntaxHighlighting(const std::string& text);
     DWORD GetSelectionStart() const;
     DWORD GetSelectionEnd() const;
     void SetSelection(DWORD start, DWORD end);
@@ -23,13 +25,48 @@ public:
     HWND GetHandle() const { return m_hwnd; }
     void SetTextChangeCallback(std::function<void()> callback);
 
+    // 表示中のプロンプトの文書モデル（ハイライト、タグリスト、サジェストで共有する）
+    const PromptDocument& GetDocument() const { return m_document; }
+
+    // 親ウィンドウに届く Scintilla の通知（WM_NOTIFY）
+    // 変更（SCN_MODIFIED）は挿入・削除した位置と長さのまま文書に反映し、ハイライト（SCN_STYLENEEDED）を付ける
+    void OnNotify(const NMHDR* header);
+
+    // インライン補完の候補を返す関数（入力中のタグと制限時間を受け取り、補完後のタグか空文字列を返す）
+    // 入力のたびに UI スレッドで同期的に呼ぶ
+    using CompletionProvider = std::function<std::string(const std::string& prefix, std::chrono::microseconds budget)>;
+    void SetCompletionProvider(CompletionProvider provider);
+
+    // インライン補完の所要時間の分布
+    const LatencyHistogram& GetCompletionLatency() const { return m_ghostLatency; }
+
 private:
     HWND m_hwnd;
     std::function<void()> m_textChangeCallback;
-    std::string m_lastText;
+    PromptDocument m_document; // 表示中のテキストとタグ（変更された範囲だけ解析し直す）
+
+    // ハイライト（SCN_STYLENEEDED で、スタイルが付いていない位置から必要な位置まで付ける）
+    uint64_t m_styledVersion;               // 最後にスタイルを付けたときの文書の版
+    size_t m_styledEnd;                     // そのときスタイルが付いていた範囲の末尾
+    std::vector<DocumentChange> m_changes;  // 作業用
+
+    // 変更の通知（元のプロシージャが処理を終えて、キャレットが動いた後にコールバックを呼ぶ）
+    int m_procDepth;       // 元のプロシージャや SetText を呼び出し中の深さ
+    bool m_pendingChange;  // コールバックを呼んでいない変更がある
+
+    // インライン補完（キャレットの後ろに薄く表示する補完の残り）
+    CompletionProvider m_completionProvider;
+    std::string m_ghostText;
+    int m_ghostLine;
+    bool m_swallowTab; // 確定に使った Tab の WM_CHAR を捨てる
+    LatencyHistogram m_ghostLatency;
 
     void SetupStyles();
-	void OnTextChanged();
+    void OnStyleNeeded(size_t endNeeded);
+    void OnModified(size_t position, size_t length, const char* text, bool inserted);
+    void UpdateGhostText();
+    void ClearGhostText();
+    void AcceptGhostText();
     static LRESULT CALLBACK ScintillaProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
     WNDPROC m_originalProc;
 };
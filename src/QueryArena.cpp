@@ -0,0 +1,75 @@
+﻿#include "framework.h"
+#include <algorithm>
+
+#include "QueryArena.h"
+
+QueryArena::QueryArena(size_t blockSize) : block_size_(std::max<size_t>(blockSize, 64)) {
+}
+
+// ブロックを追加
+void QueryArena::AddBlock(size_t size) {
+	blocks_.push_back({ std::make_unique<std::byte[]>(size), size });
+	++heap_allocations_;
+}
+
+// 確保
+// 最後のブロックに収まらなければ、倍の大きさ（要求がそれより大きければ要求の大きさ）のブロックを追加する
+void* QueryArena::do_allocate(size_t bytes, size_t alignment) {
+	if (!blocks_.empty()) {
+		auto& block = blocks_.back();
+		auto base = reinterpret_cast<uintptr_t>(block.data.get());
+		auto aligned = (base + offset_ + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+		auto end = aligned - base + bytes;
+		if (end <= block.size) {
+			offset_ = end;
+			return reinterpret_cast<void*>(aligned);
+		}
+		used_ += offset_;
+	}
+
+	size_t size = blocks_.empty() ? block_size_ : blocks_.back().size * 2;
+	AddBlock(std::max(size, bytes + alignment));
+	offset_ = 0;
+	return do_allocate(bytes, alignment);
+}
+
+// 空にする
+void QueryArena::Reset() {
+	if (blocks_.size() > 1) {
+		auto total = Capacity();
+		blocks_.clear();
+		AddBlock(total);
+	}
+	offset_ = 0;
+	used_ = 0;
+}
+
+// 使用中のバイト数
+size_t QueryArena::Used() const {
+	return used_ + offset_;
+}
+
+// 確保済みのブロックの合計の大きさ
+size_t QueryArena::Capacity() const {
+	size_t total = 0;
+	for (const auto& block : blocks_) {
+		total += block.size;
+	}
+	return total;
+}
+
+// このスレッドの作業領域
+QueryArena& QueryArena::ForThread() {
+	thread_local QueryArena arena;
+	return arena;
+}
+
+QueryArena::Scope::Scope() : arena_(ForThread()) {
+	++arena_.depth_;
+}
+
+QueryArena::Scope::~Scope() {
+	if (--arena_.depth_ == 0) {
+		arena_.Reset();
+	}
+}
@@ -0,0 +1,74 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+// 検索1回分の作業領域（モノトニックなアロケーター）
+// 確保は領域の末尾を進めるだけで、個々の解放はせず Reset でまとめて空にする
+// ブロックは解放せずに次の検索で使い回すので、同じ規模の検索が続けば作業領域は拡張しない
+// スレッドごとに1つ用意し、Scope で検索の範囲を示して使う
+class QueryArena : public std::pmr::memory_resource {
+public:
+	// 最初に確保するブロックの大きさ
+	static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+	explicit QueryArena(size_t blockSize = DEFAULT_BLOCK_SIZE);
+
+	QueryArena(const QueryArena&) = delete;
+	QueryArena& operator=(const QueryArena&) = delete;
+
+	// 確保した領域をすべて空にする
+	// 複数のブロックを使っていたら、合計の大きさの1ブロックにまとめ直す
+	void Reset();
+
+	// ヒープからブロックを確保した回数（作業領域を使わない確保は含まない）
+	uint64_t HeapAllocations() const { return heap_allocations_; }
+
+	// 使用中のバイト数
+	size_t Used() const;
+
+	// 確保済みのブロックの合計の大きさ
+	size_t Capacity() const;
+
+	// このスレッドの作業領域
+	static QueryArena& ForThread();
+
+	// 検索の範囲
+	// 入れ子にでき、最も外側の範囲を抜けたときに作業領域を空にする
+	// 範囲の中で確保したものを範囲の外に持ち出さないこと
+	class Scope {
+	public:
+		Scope();
+		~Scope();
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+		QueryArena& Arena() const { return arena_; }
+
+	private:
+		QueryArena& arena_;
+	};
+
+private:
+	struct Block {
+		std::unique_ptr<std::byte[]> data;
+		size_t size;
+	};
+
+	std::vector<Block> blocks_;
+	size_t block_size_;
+	size_t offset_ = 0; // 最後のブロック内の使用位置
+	size_t used_ = 0;   // 最後のブロックより前のブロックで使用したバイト数
+	uint64_t heap_allocations_ = 0;
+	int depth_ = 0;
+
+	// size バイト以上のブロックを追加
+	void AddBlock(size_t size);
+
+	void* do_allocate(size_t bytes, size_t alignment) override;
+	void do_deallocate(void*, size_t, size_t) override {}
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
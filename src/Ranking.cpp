@@ -0,0 +1,29 @@
+﻿#include "framework.h"
+#include <algorithm>
+#include <cmath>
+
+#include "Ranking.h"
+
+// タグ固有の静的スコア
+double static_tag_score(int postCount, int category, bool isUserTag, const RankingWeights& weights) {
+	double score = weights.popularity * std::log10(static_cast<double>(std::max(postCount, 0)) + 1.0);
+	if (category >= 0 && category < static_cast<int>(weights.category.size())) {
+		score += weights.category[category];
+	}
+	if (isUserTag) {
+		score += weights.userBoost;
+	}
+	return score;
+}
+
+// 総合スコア
+double rank_score(MatchType type, double similarity, double staticScore, const RankingWeights& weights) {
+	double base = 0.0;
+	switch (type) {
+	case MatchType::Exact: base = weights.exact; break;
+	case MatchType::Prefix: base = weights.prefix; break;
+	case MatchType::WordPrefix: base = weights.wordPrefix; break;
+	case MatchType::Fuzzy: base = weights.fuzzy; break;
+	}
+	return base + weights.similarity * similarity + staticScore;
+}
@@ -0,0 +1,62 @@
+﻿#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+
+// 一致の種類（上にあるほど優先）
+enum class MatchType {
+	Exact,      // 完全一致
+	Prefix,     // 前方一致
+	WordPrefix, // 単語の前方一致
+	Fuzzy,      // 曖昧一致
+};
+
+// 説明文の出典（上にあるほど優先）
+enum class DescriptionTier : uint8_t {
+	Curated,     // 人手による翻訳（danbooru-jp.csv）
+	Machine,     // 機械翻訳（danbooru-machine-jp.csv）
+	MachineOnly, // 機械翻訳のみ（danbooru-only-machine-jp.csv）
+};
+
+// ランキングの重み
+struct RankingWeights {
+	// 一致の種類ごとの基礎点
+	double exact = 300.0;
+	double prefix = 200.0;
+	double wordPrefix = 150.0;
+	double fuzzy = 0.0;
+
+	// 類似度（0～100）に掛ける係数
+	double similarity = 2.0;
+
+	// log10(投稿数 + 1) に掛ける係数
+	double popularity = 20.0;
+
+	// カテゴリーごとの加点（0: general、1: artist、3: copyright、4: character、5: meta、9: カスタムタグ）
+	std::array<double, 10> category = { 0.0, -15.0, 0.0, -5.0, 0.0, -20.0, 0.0, 0.0, 0.0, 30.0 };
+
+	// お気に入りタグへの加点
+	double userBoost = 50.0;
+
+	// 逆引きで一致した説明文の出典ごとの加点（DescriptionTier の順）
+	std::array<double, 3> descriptionTier = { 20.0, 0.0, -10.0 };
+};
+
+// 入力に対する一致の種類を判定（単語の区切りは空白）
+template <typename String>
+MatchType classify_match(const String& input, const String& entry) {
+	if (input.empty() || entry.size() < input.size()) return MatchType::Fuzzy;
+	if (entry.compare(0, input.size(), input) == 0) {
+		return entry.size() == input.size() ? MatchType::Exact : MatchType::Prefix;
+	}
+	for (size_t pos = entry.find(' '); pos != String::npos; pos = entry.find(' ', pos + 1)) {
+		if (entry.compare(pos + 1, input.size(), input) == 0) return MatchType::WordPrefix;
+	}
+	return MatchType::Fuzzy;
+}
+
+// タグ固有の静的スコア（辞書の読み込み時に事前計算する）
+double static_tag_score(int postCount, int category, bool isUserTag, const RankingWeights& weights);
+
+// 総合スコア
+double rank_score(MatchType type, double similarity, double staticScore, const RankingWeights& weights);
@@ -0,0 +1,102 @@
+﻿#include "framework.h"
+#include <algorithm>
+
+#include "SuffixArray.h"
+
+// 索引を空にする
+void SuffixArray::Clear() {
+	text_ = {};
+	positions_.clear();
+	lcp_.clear();
+}
+
+// 位置 a と b から始まる接尾辞の共通接頭辞の長さ
+uint32_t SuffixArray::CommonPrefix(uint32_t a, uint32_t b) const {
+	uint32_t k = 0;
+	while (a + k < text_.size() && b + k < text_.size()) {
+		auto c = text_[a + k];
+		if (c == SEPARATOR || c != text_[b + k]) break;
+		++k;
+	}
+	return k;
+}
+
+// 位置 pos から始まる接尾辞とパターンの共通接頭辞の長さ
+size_t SuffixArray::MatchPattern(uint32_t pos, std::wstring_view pattern, size_t known) const {
+	size_t k = known;
+	while (k < pattern.size() && pos + k < text_.size() && text_[pos + k] == pattern[k]) {
+		++k;
+	}
+	return k;
+}
+
+// テキストから構築
+void SuffixArray::Build(std::wstring_view text) {
+	Clear();
+	text_ = text;
+
+	// 区切り文字から始まる接尾辞は検索に使わないので登録しない
+	positions_.reserve(text.size());
+	for (uint32_t i = 0; i < text.size(); ++i) {
+		if (text[i] != SEPARATOR) positions_.push_back(i);
+	}
+
+	// 説明文は短いので、区切り文字までの比較でソートしても十分速い
+	// 同じ接尾辞はテキスト内の位置順に並べる
+	std::sort(positions_.begin(), positions_.end(), [this](uint32_t a, uint32_t b) {
+		auto k = CommonPrefix(a, b);
+		wchar_t ca = a + k < text_.size() ? text_[a + k] : SEPARATOR;
+		wchar_t cb = b + k < text_.size() ? text_[b + k] : SEPARATOR;
+		if (ca == SEPARATOR && cb == SEPARATOR) return a < b;
+		if (ca == SEPARATOR || cb == SEPARATOR) return ca == SEPARATOR;
+		return ca < cb;
+	});
+
+	lcp_.resize(positions_.size());
+	for (size_t i = 0; i < positions_.size(); ++i) {
+		lcp_[i] = i == 0 ? 0 : CommonPrefix(positions_[i - 1], positions_[i]);
+	}
+}
+
+// パターンで始まる接尾辞の範囲
+std::pair<size_t, size_t> SuffixArray::Find(std::wstring_view pattern) const {
+	if (pattern.empty() || positions_.empty()) return { 0, 0 };
+
+	// パターン以上となる最初の接尾辞を二分探索
+	// 両端の接尾辞とパターンの共通接頭辞の短い方までは比較を省ける
+	size_t lo = 0, hi = positions_.size();
+	size_t lo_lcp = 0, hi_lcp = 0;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		auto pos = positions_[mid];
+		size_t k = MatchPattern(pos, pattern, std::min(lo_lcp, hi_lcp));
+		bool less = k < pattern.size() && (pos + k >= text_.size() || text_[pos + k] < pattern[k]);
+		if (less) {
+			lo = mid + 1;
+			lo_lcp = k;
+		} else {
+			hi = mid;
+			hi_lcp = k;
+		}
+	}
+
+	size_t first = lo;
+	if (first == positions_.size() || MatchPattern(positions_[first], pattern, 0) < pattern.size()) {
+		return { first, first };
+	}
+
+	// パターンで始まる接尾辞は連続するので、LCP がパターン長以上の間は範囲に含まれる
+	size_t last = first + 1;
+	while (last < positions_.size() && lcp_[last] >= pattern.size()) {
+		++last;
+	}
+	return { first, last };
+}
+
+// パターンを含む位置
+std::pmr::vector<uint32_t> SuffixArray::FindAll(std::wstring_view pattern, std::pmr::memory_resource* resource) const {
+	auto [first, last] = Find(pattern);
+	std::pmr::vector<uint32_t> result(positions_.begin() + first, positions_.begin() + last, resource);
+	std::sort(result.begin(), result.end());
+	return result;
+}
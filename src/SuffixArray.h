@@ -0,0 +1,49 @@
+﻿#pragma once
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// 接尾辞配列と LCP 配列
+// 区切り文字で区切った複数の文書を連結したテキストに対して構築し、部分文字列を含む位置を求める
+// 接尾辞の比較は区切り文字までで打ち切るので、文書をまたいだ一致は起きない
+class SuffixArray {
+public:
+	// 文書の区切り文字（検索語には含まれないものとする）
+	static constexpr wchar_t SEPARATOR = L'\0';
+
+	// 索引を空にする
+	void Clear();
+
+	// テキストから構築する（テキストは参照するだけなので、索引より長く保持すること）
+	void Build(std::wstring_view text);
+
+	// 接尾辞の数
+	size_t Size() const { return positions_.size(); }
+
+	// 接尾辞配列の i 番目の接尾辞のテキスト内の位置
+	uint32_t Position(size_t i) const { return positions_[i]; }
+
+	// 接尾辞配列の i - 1 番目と i 番目の接尾辞の共通接頭辞の長さ（0番目は0）
+	uint32_t Lcp(size_t i) const { return lcp_[i]; }
+
+	// パターンで始まる接尾辞の範囲 [first, last)
+	// 二分探索は O(|パターン| log n)、範囲の末尾は LCP 配列をたどって求める
+	std::pair<size_t, size_t> Find(std::wstring_view pattern) const;
+
+	// パターンを含む位置（昇順、resource から確保する）
+	std::pmr::vector<uint32_t> FindAll(std::wstring_view pattern,
+		std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+
+private:
+	std::wstring_view text_;
+	std::vector<uint32_t> positions_;
+	std::vector<uint32_t> lcp_;
+
+	// 位置 a と b から始まる接尾辞の共通接頭辞の長さ（区切り文字まで）
+	uint32_t CommonPrefix(uint32_t a, uint32_t b) const;
+
+	// 位置 pos から始まる接尾辞とパターンの共通接頭辞の長さ（先頭 known 文字は一致済み）
+	size_t MatchPattern(uint32_t pos, std::wstring_view pattern, size_t known) const;
+};
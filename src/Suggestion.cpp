@@ -1,10 +1,15 @@
 ﻿#include "framework.h"
 #include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <future>
 #include <iterator>
+#include <memory>
 #include "TextUtils.h"
 #include "Suggestion.h"
 
-Suggestion::Suggestion() : m_SuggestTimer(nullptr) {
+Suggestion::Suggestion() : m_hwnd(nullptr), m_wakeEvent(nullptr), m_mailbox(nullptr), m_results(nullptr),
+	m_stopping(false), m_generation(0), m_cancelledCount(0), m_cancelledMs(0.0), m_speculated(0), m_speculativeCpuMs(0.0) {
 }
 
 Suggestion::~Suggestion() {
@@ -12,64 +17,347 @@ Suggestion::~Suggestion() {
 }
 
 // サジェスト処理の開始
-void Suggestion::StartSuggestion(std::function<void(const TagList&)> callback) {
+void Suggestion::StartSuggestion(std::function<void(const SuggestionBatch&)> callback, HWND hwnd) {
 	m_callback = callback;
+	m_hwnd = hwnd;
 	BooruDB::GetInstance().LoadDictionary();
+
+	if (m_worker.joinable()) return;
+	m_stopping = false;
+	m_wakeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+	m_worker = std::thread(&Suggestion::WorkerLoop, this);
 }
 
 // リクエスト
 void Suggestion::Request(const std::string& input) {
 	if (!m_callback) return;
-	if (m_currentInput == input) return;
-	m_callback({});
-	CancelTimer();
-	m_currentInput = input;
-	CreateTimerQueueTimer(&m_SuggestTimer, nullptr, SuggestTimerProc, this, SUGGEST_DELAY_MS, 0, 0);
+	if (m_lastInput == input) return;
+	m_lastInput = input;
+	m_callback({ SuggestionStage::Clear, 0, input.empty(), {} });
+
+	// 未処理のリクエストは新しいもので上書きする
+	// 世代を進めるので、処理中の検索は打ち切られ、古いリクエストの結果が後から届いても表示しない
+	auto now = AdaptiveDebounce::Clock::now();
+	m_debounce.OnRequest(now);
+	auto generation = ++m_generation;
+	Job* job = input.empty() ? nullptr : new Job{ generation, input, now };
+	delete m_mailbox.exchange(job);
+	if (job && m_wakeEvent) SetEvent(m_wakeEvent);
+}
+
+// 結果の受け取り（UIスレッド）
+void Suggestion::DeliverResults() {
+	// 新しいものが先頭なので、逆順にして届いた順に渡す
+	Result* reversed = nullptr;
+	for (Result* result = m_results.exchange(nullptr); result;) {
+		auto next = result->next;
+		result->next = reversed;
+		reversed = result;
+		result = next;
+	}
+	for (Result* result = reversed; result; result = result->next) {
+		if (result->generation == m_generation && m_callback) m_callback(result->batch);
+	}
+	FreeResults(reversed);
+}
+
+// 結果の連結リストを解放
+void Suggestion::FreeResults(Result* results) {
+	while (results) {
+		auto next = results->next;
+		delete results;
+		results = next;
+	}
 }
 
 // シャットダウン
 void Suggestion::Shutdown() {
 	m_callback = nullptr;
-	CancelTimer();
-	BooruDB::GetInstance().Cancel();
+	m_stopping = true;
+	++m_generation;
+	if (m_worker.joinable()) {
+		SetEvent(m_wakeEvent);
+		m_worker.join();
+	}
+	if (m_wakeEvent) {
+		CloseHandle(m_wakeEvent);
+		m_wakeEvent = nullptr;
+	}
+	delete m_mailbox.exchange(nullptr);
+	FreeResults(m_results.exchange(nullptr));
+}
+
+// ワーカースレッド
+void Suggestion::WorkerLoop() {
+	while (!m_stopping) {
+		// 未処理のリクエストがなければ来るまで待つ
+		// 待つ前に、次に入力されそうな入力の結果を先に求めておく（リクエストが来たらすぐにやめる）
+		if (!m_mailbox.load()) Speculate();
+		if (!m_mailbox.load()) WaitForSingleObject(m_wakeEvent, INFINITE);
+		if (m_stopping) break;
+
+		// 貼り付けなどで続けて届いたリクエストをまとめるため、少しだけ待ってから最新のものを取り出す
+		WaitForSingleObject(m_wakeEvent, QUICK_DELAY_MS);
+		if (m_stopping) break;
+
+		std::unique_ptr<Job> job(m_mailbox.exchange(nullptr));
+		if (job) Tag(*job);
+	}
+}
+
+// このスレッドが使った CPU 時間（ミリ秒）
+static double ThreadCpuMs() {
+	FILETIME creation, exit, kernel, user;
+	if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) return 0.0;
+	auto ticks = [](const FILETIME& time) {
+		return (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+	};
+	return static_cast<double>(ticks(kernel) + ticks(user)) / 10000.0;
 }
 
-void Suggestion::CancelTimer() {
-	if (m_SuggestTimer) {
-		DeleteTimerQueueTimer(nullptr, m_SuggestTimer, nullptr);
-		m_SuggestTimer = nullptr;
+// 先読み（ワーカースレッドが空いている間）
+// 最後に求めた入力に1文字を加えた入力のうち見込みの高いものを、優先度を下げたスレッドで求めて m_cache に入れる
+// 新しいリクエストが来たら（世代が進んだら）すぐに打ち切る
+void Suggestion::Speculate() {
+	if (m_lastCompleted.empty() || m_lastCompleted == m_speculatedFrom) return;
+	m_speculatedFrom = m_lastCompleted;
+
+	// 1文字を加えた入力は英語の経路で求めるので、日本語を含む入力は先読みしない
+	if (utf8_has_multibyte(m_lastCompleted)) return;
+
+	auto& db = BooruDB::GetInstance();
+	auto version = db.Version();
+	CancellationToken cancel(m_generation, m_generation.load());
+
+	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+	auto cpuStart = ThreadCpuMs();
+	for (const auto& input : db.LikelyContinuations(m_lastCompleted, SPECULATIVE_INPUTS)) {
+		if (Superseded()) break;
+		if (m_cache.Contains(input, version)) continue;
+		TagHandleList suggestions;
+		if (!SearchEnglish(input, suggestions, cancel) || Superseded()) break;
+		m_cache.Store(input, version, std::move(suggestions), true);
+		m_speculated++;
 	}
+	m_speculativeCpuMs += ThreadCpuMs() - cpuStart;
+	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_NORMAL);
+
+	char buffer[256];
+	snprintf(buffer, sizeof(buffer),
+		"speculate: cache hits %llu/%llu, speculative hits %llu/%llu, cpu %.1fms total\n",
+		static_cast<unsigned long long>(m_cache.Hits()), static_cast<unsigned long long>(m_cache.Lookups()),
+		static_cast<unsigned long long>(m_cache.SpeculativeHits()), static_cast<unsigned long long>(m_cache.SpeculativeStores()),
+		m_speculativeCpuMs);
+	OutputDebugStringA(buffer);
 }
 
-void CALLBACK Suggestion::SuggestTimerProc(PVOID lpParameter, BOOLEAN TimerOrWaitFired) {
-	auto* instance = static_cast<Suggestion*>(lpParameter);
-	if (instance) {
-		instance->Tag();
+// 英語の入力の結果をまとめて求める（先読み用）
+// Tag の英語の経路と同じ順に並べる（完全一致→前方一致→別名→ローマ字の逆引きと曖昧検索をスコアでまとめたもの）
+bool Suggestion::SearchEnglish(const std::string& input, TagHandleList& suggestions, const CancellationToken& cancel) {
+	auto& db = BooruDB::GetInstance();
+	if (!db.ExactSuggestion(suggestions, input, cancel)) return false;
+	SetStage(suggestions, 0, SuggestionStage::Exact);
+
+	size_t prefixOffset = suggestions.size();
+	if (!db.QuickSuggestion(suggestions, input, QUICK_SUGGESTIONS - static_cast<int>(prefixOffset), cancel)) return false;
+	SetStage(suggestions, prefixOffset, SuggestionStage::Prefix);
+
+	size_t aliasOffset = suggestions.size();
+	if (!db.AliasSuggestion(suggestions, input, ALIAS_SUGGESTIONS, cancel)) return false;
+	SetStage(suggestions, aliasOffset, SuggestionStage::Alias);
+
+	// ローマ字の逆引きは英語のタグに前方一致しない場合だけ使う
+	size_t offset = suggestions.size();
+	if (!HasEnglishPrefix(suggestions)) {
+		db.RomajiSuggestion(suggestions, input, ROMAJI_SUGGESTIONS, cancel);
+		if (cancel.Cancelled()) return false;
+		SetStage(suggestions, offset, SuggestionStage::Romaji);
 	}
+
+	size_t fuzzyOffset = suggestions.size();
+	if (!db.FuzzySuggestion(suggestions, input, FUZZY_SUGGESTIONS, cancel)) return false;
+	SetStage(suggestions, fuzzyOffset, SuggestionStage::Fuzzy);
+	MergeByScore(suggestions, offset, fuzzyOffset);
+	return true;
 }
 
-void Suggestion::Tag() {
-	if (!m_callback) return;
-	auto input = m_currentInput;
-	if (input.empty()) {
-		m_callback({});
+// 完全一致・前方一致・別名の結果に英語のタグがあるか
+// ASCII の入力は全てローマ字としても引くが、英語のタグやその別名に前方一致する入力（long hair など）は英語として打っているので、
+// ローマ字読みがたまたま部分一致しただけのタグ（はい → hai など）を出すと雑音になる
+bool Suggestion::HasEnglishPrefix(const TagHandleList& prefixSuggestions) {
+	return !prefixSuggestions.empty();
+}
+
+// offset 以降の結果に見つかった段階を設定
+void Suggestion::SetStage(TagHandleList& suggestions, size_t offset, SuggestionStage stage) {
+	for (size_t i = offset; i < suggestions.size(); ++i) {
+		suggestions[i].stage = stage;
+	}
+}
+
+// first～middle と middle 以降（それぞれスコアの高い順）を1つのランキングにまとめる
+// ローマ字の逆引きと曖昧検索のスコアは同じ基準（rank_score）なので、そのまま比べられる
+// 同点なら first～middle の方を先にする
+void Suggestion::MergeByScore(TagHandleList& suggestions, size_t first, size_t middle) {
+	std::inplace_merge(suggestions.begin() + first, suggestions.begin() + middle, suggestions.end(),
+		[](const TagHandle& a, const TagHandle& b) { return a.score > b.score; });
+}
+
+// 曖昧検索を始める前に待つ（待っている間に新しいリクエストが来たら false）
+bool Suggestion::WaitForFuzzy(std::chrono::milliseconds delay) {
+	if (delay.count() > 0 && !Superseded()) {
+		WaitForSingleObject(m_wakeEvent, static_cast<DWORD>(delay.count()));
+	}
+	return !Superseded();
+}
+
+// 処理時間の記録（方針の調整用）
+void Suggestion::LogLatency(const Job& job, const char* stage, double workMs, bool cancelled) {
+	auto elapsed = std::chrono::duration<double, std::milli>(AdaptiveDebounce::Clock::now() - job.requested).count();
+	if (cancelled) {
+		m_cancelledCount++;
+		m_cancelledMs += workMs;
+	}
+	char buffer[256];
+	snprintf(buffer, sizeof(buffer),
+		"suggest %s%s: latency %.1fms, work %.1fms, fuzzy avg %.1fms, typing avg %.1fms, cancelled %llu (%.1fms total)\n",
+		stage, cancelled ? " cancelled" : "", elapsed, workMs,
+		m_debounce.AverageFuzzyLatency(), m_debounce.AverageTypingInterval(),
+		static_cast<unsigned long long>(m_cancelledCount), m_cancelledMs);
+	OutputDebugStringA(buffer);
+}
+
+// 新しいリクエストが来ているか（来ていれば今の処理は打ち切る）
+bool Suggestion::Superseded() const {
+	return m_stopping || m_mailbox.load() != nullptr;
+}
+
+// 結果を UI スレッドに渡す（未受け取りの結果の先頭に積む）
+void Suggestion::Publish(uint64_t generation, SuggestionBatch&& batch) {
+	auto result = new Result{ generation, std::move(batch), m_results.load() };
+	while (!m_results.compare_exchange_weak(result->next, result)) {
+	}
+	if (m_hwnd) PostMessage(m_hwnd, WM_SUGGESTION_READY, 0, 0);
+}
+
+// サジェストを求める（ワーカースレッド）
+// 安価な段階（前方一致、逆引き）はすぐに、高価な段階（曖昧検索）は AdaptiveDebounce の待ち時間の後に行う
+// 段階ごとに前の段階までに表示した分との差分だけを渡す
+void Suggestion::Tag(const Job& job) {
+	const auto& input = job.input;
+	auto& db = BooruDB::GetInstance();
+
+	// 新しいリクエストが来たら（世代が進んだら）検索を打ち切る
+	CancellationToken cancel(m_generation, job.generation);
+
+	// 表示済みのサジェスト（曖昧検索ではこれを除いて検索する）
+	TagHandleList shown;
+	auto publish = [&](SuggestionStage stage, size_t offset, bool final) {
+		if (stage != SuggestionStage::Cached) SetStage(shown, offset, stage);
+		Publish(job.generation, { stage, offset, final, TagHandleList(shown.begin() + offset, shown.end()) });
+	};
+	auto since = [](AdaptiveDebounce::Clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(AdaptiveDebounce::Clock::now() - start).count();
+	};
+
+	// 前に求めた（または先読みした）結果があればそのまま表示する
+	auto version = db.Version();
+	if (auto cached = m_cache.Find(input, version)) {
+		shown = *cached;
+		publish(SuggestionStage::Cached, 0, true);
+		LogLatency(job, "cached", 0.0, false);
+		m_lastCompleted = input;
 		return;
 	}
-	bool has_multibyte = utf8_has_multibyte(input);
-	if (!has_multibyte) {
-		// 通常のサジェスト（前方一致→曖昧検索）
-		TagList saggestions;
-		if (!BooruDB::GetInstance().QuickSuggestion(saggestions, input, 8)) return;
-		if (m_currentInput != input) return;
-		if (m_callback) m_callback(saggestions);
-		if (!BooruDB::GetInstance().FuzzySuggestion(saggestions, input, 32)) return;
-		if (m_currentInput != input) return;
-		if (m_callback) m_callback(saggestions);
+
+	if (split_script_runs(input).size() > 1) {
+		// 英語と日本語が混在しているので、部分ごとに並行して検索して1つのランキングにまとめる
+		if (!WaitForFuzzy(m_debounce.FuzzyDelay())) return;
+		auto start = AdaptiveDebounce::Clock::now();
+		bool ok = db.MixedSuggestion(shown, input, 40, cancel) && !Superseded();
+		LogLatency(job, "mixed", since(start), !ok);
+		if (!ok) return;
+		m_debounce.OnFuzzyCompleted(since(start));
+		publish(SuggestionStage::Mixed, 0, true);
+	} else if (!utf8_has_multibyte(input)) {
+		// ローマ字の逆引きは英語の検索と並行して行う
+		auto romaji = std::async(std::launch::async, [&input, &cancel]() {
+			TagHandleList romajiSuggestions;
+			BooruDB::GetInstance().RomajiSuggestion(romajiSuggestions, input, ROMAJI_SUGGESTIONS, cancel);
+			return romajiSuggestions;
+		});
+
+		// 通常のサジェスト（完全一致→索引から前方一致→別名→残りを1回の走査で曖昧検索）
+		// 完全一致は1件だけなので、見つかれば前方一致のランキングを待たずに先頭に表示する
+		auto start = AdaptiveDebounce::Clock::now();
+		if (!db.ExactSuggestion(shown, input, cancel)) return;
+		if (Superseded()) return;
+		if (!shown.empty()) publish(SuggestionStage::Exact, 0, false);
+
+		size_t prefixOffset = shown.size();
+		if (!db.QuickSuggestion(shown, input, QUICK_SUGGESTIONS - static_cast<int>(prefixOffset), cancel)) return;
+		if (Superseded()) return;
+		publish(SuggestionStage::Prefix, prefixOffset, false);
+
+		size_t aliasOffset = shown.size();
+		if (!db.AliasSuggestion(shown, input, ALIAS_SUGGESTIONS, cancel)) return;
+		if (Superseded()) return;
+		if (shown.size() > aliasOffset) publish(SuggestionStage::Alias, aliasOffset, false);
+		LogLatency(job, "quick", since(start), false);
+
+		// ローマ字の逆引きの結果は英語のタグやその別名に前方一致しない場合だけ前方一致の後に並べ、
+		// 曖昧検索の結果が届いたらスコアで1つのランキングにまとめる
+		// （前方一致が無いので重複は無い）
+		size_t romajiOffset = shown.size();
+		auto romajiSuggestions = romaji.get();
+		if (Superseded()) return;
+		if (!HasEnglishPrefix(shown) && !romajiSuggestions.empty()) {
+			shown.insert(shown.end(), romajiSuggestions.begin(), romajiSuggestions.end());
+			publish(SuggestionStage::Romaji, romajiOffset, false);
+		}
+
+		// まずは制限時間内に見つかった分だけ表示
+		if (!WaitForFuzzy(m_debounce.FuzzyDelay())) return;
+		start = AdaptiveDebounce::Clock::now();
+		size_t offset = shown.size();
+		FuzzyProgress progress;
+		auto budget = std::chrono::milliseconds(FUZZY_FRAME_BUDGET_MS);
+		bool ok = db.FuzzySuggestion(shown, input, FUZZY_SUGGESTIONS, budget, progress, cancel) && !Superseded();
+		if (!ok) {
+			LogLatency(job, "fuzzy", since(start), true);
+			return;
+		}
+		// ローマ字の逆引きの位置から、曖昧検索の結果とまとめたランキングに差し替える
+		// 続きから走査するときに曖昧検索の分だけを取り除けるよう、shown の並びは最後にまとめる
+		auto publishFuzzy = [&](bool final) {
+			SetStage(shown, offset, SuggestionStage::Fuzzy);
+			TagHandleList ranked(shown.begin() + romajiOffset, shown.end());
+			MergeByScore(ranked, 0, offset - romajiOffset);
+			Publish(job.generation, { SuggestionStage::Fuzzy, romajiOffset, final, std::move(ranked) });
+		};
+		publishFuzzy(progress.exhaustive);
+		if (!progress.exhaustive) {
+			// 走査しきれなかった場合は時間切れの位置から続きを走査して、曖昧検索の分だけ差し替え
+			ok = db.FuzzySuggestion(shown, input, FUZZY_SUGGESTIONS, std::chrono::milliseconds::max(), progress, cancel) && !Superseded();
+			if (!ok) {
+				LogLatency(job, "fuzzy", since(start), true);
+				return;
+			}
+			publishFuzzy(true);
+		}
+		MergeByScore(shown, romajiOffset, offset);
+		m_debounce.OnFuzzyCompleted(since(start));
+		LogLatency(job, "fuzzy", since(start), false);
 	} else {
-		// 日本語を含むので逆引きサジェスト
-		TagList saggestions;
-		if (!BooruDB::GetInstance().ReverseSuggestion(saggestions, input, 40)) return;
-		if (m_currentInput != input) return;
-		if (m_callback) m_callback(saggestions);
+		// 日本語を含むので逆引きサジェスト（索引を引くだけなのですぐに行う）
+		auto start = AdaptiveDebounce::Clock::now();
+		if (!db.ReverseSuggestion(shown, input, 40, cancel)) return;
+		if (Superseded()) return;
+		publish(SuggestionStage::Reverse, 0, true);
+		LogLatency(job, "reverse", since(start), false);
 	}
+
+	// 全ての段階を終えたので結果を残し、次の先読みの起点にする
+	m_cache.Store(input, version, std::move(shown), false);
+	m_lastCompleted = input;
 }
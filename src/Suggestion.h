@@ -1,34 +1,104 @@
 ﻿#pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "AdaptiveDebounce.h"
 #include "BooruDB.h"
+#include "SuggestionCache.h"
 #include "Tag.h"
 
+// サジェストの結果が届いたことを UI スレッドに知らせるメッセージ
+constexpr UINT WM_SUGGESTION_READY = WM_APP + 1;
+
+// 段階ごとの結果（前の段階までの結果との差分）
+// 表示中のサジェストを offset 件に切り詰めてから suggestions を末尾に追加する
+// 通常は offset が表示中の件数と同じなので追加するだけだが、曖昧検索を全件で検索し直したときは同じ offset で差し替える
+struct SuggestionBatch {
+	SuggestionStage stage;
+	size_t offset;
+	bool final;          // このリクエストの最後の結果か
+	TagHandleList suggestions; // タグ名と説明は表示するときに BooruDB から求める
+};
+
 class Suggestion {
 public:
 	Suggestion();
 	~Suggestion();
 
-	// サジェスト処理の開始
-	void StartSuggestion(std::function<void(const TagList&)> callback);
+	// サジェスト処理の開始（ワーカースレッドを起動）
+	// hwnd を指定すると、結果が届くたびに WM_SUGGESTION_READY を送るので DeliverResults を呼ぶこと
+	// コールバックには段階ごとの結果が届いた順に渡される
+	void StartSuggestion(std::function<void(const SuggestionBatch&)> callback, HWND hwnd = nullptr);
 
-	// リクエスト
+	// リクエスト（UIスレッド）
+	// 未処理のリクエストは新しいもので上書きされ、処理中の検索は打ち切られる
 	void Request(const std::string& input);
 
+	// 届いた結果を届いた順にコールバックに渡す（UIスレッド）
+	void DeliverResults();
+
 	// シャットダウン
 	void Shutdown();
 
+	// 先読みで求めた入力の数
+	uint64_t SpeculatedCount() const { return m_speculated; }
+
 private:
-	static constexpr int SUGGEST_DELAY_MS = 500;
+	static constexpr int QUICK_DELAY_MS = 5; // 続けて届いたリクエストをまとめる時間
+	static constexpr int FUZZY_FRAME_BUDGET_MS = 8; // 曖昧検索の初回表示までの制限時間
+	static constexpr int QUICK_SUGGESTIONS = 8;      // 完全一致と前方一致を合わせた件数
+	static constexpr int ALIAS_SUGGESTIONS = 4;      // 別名の前方一致の件数
+	static constexpr int ROMAJI_SUGGESTIONS = 8;     // ローマ字の逆引きの件数
+	static constexpr int FUZZY_SUGGESTIONS = 32;     // 曖昧検索の件数
+	static constexpr size_t SPECULATIVE_INPUTS = 3;  // 1回のリクエストの後に先読みする入力の数
+
+	// リクエスト
+	struct Job {
+		uint64_t generation;
+		std::string input;
+		AdaptiveDebounce::Clock::time_point requested;
+	};
+
+	// 結果（新しいものが先頭の連結リスト）
+	struct Result {
+		uint64_t generation;
+		SuggestionBatch batch;
+		Result* next;
+	};
 
-	std::function<void(const std::vector<Tag>&)> m_callback;
-	HANDLE m_SuggestTimer;
-	std::string m_currentInput;
+	std::function<void(const SuggestionBatch&)> m_callback;
+	HWND m_hwnd;
+	std::thread m_worker;
+	HANDLE m_wakeEvent;                // リクエストが来たことをワーカーに知らせる
+	std::atomic<Job*> m_mailbox;       // 最新のリクエスト（UIスレッド → ワーカー）
+	std::atomic<Result*> m_results;    // 未受け取りの結果（ワーカー → UIスレッド）
+	std::atomic<bool> m_stopping;
+	std::atomic<uint64_t> m_generation; // 最新のリクエストの世代（更新は UIスレッドのみ、ワーカーは中断の確認に使う）
+	std::string m_lastInput;           // 最後にリクエストされた入力（UIスレッドのみ）
+	AdaptiveDebounce m_debounce;       // 曖昧検索を始めるまでの待ち時間
+	uint64_t m_cancelledCount;         // 打ち切った処理の数（ワーカーのみ）
+	double m_cancelledMs;              // 打ち切った処理に費やした時間の合計（ワーカーのみ）
+	SuggestionCache m_cache;           // 入力ごとの結果（ワーカーのみ）
+	std::string m_lastCompleted;       // 最後に全ての段階を終えた入力（ワーカーのみ）
+	std::string m_speculatedFrom;      // 最後に先読みの起点にした入力（ワーカーのみ）
+	std::atomic<uint64_t> m_speculated; // 先読みで求めた入力の数
+	double m_speculativeCpuMs;         // 先読みに使った CPU 時間の合計（ワーカーのみ）
 
-	void CancelTimer();
-	static void CALLBACK SuggestTimerProc(PVOID lpParameter, BOOLEAN TimerOrWaitFired);
-	void Tag();
+	void WorkerLoop();
+	void Speculate();
+	static bool SearchEnglish(const std::string& input, TagHandleList& suggestions, const CancellationToken& cancel);
+	static bool HasEnglishPrefix(const TagHandleList& prefixSuggestions);
+	static void SetStage(TagHandleList& suggestions, size_t offset, SuggestionStage stage);
+	static void MergeByScore(TagHandleList& suggestions, size_t first, size_t middle);
+	bool Superseded() const;
+	bool WaitForFuzzy(std::chrono::milliseconds delay);
+	void LogLatency(const Job& job, const char* stage, double workMs, bool cancelled);
+	void Publish(uint64_t generation, SuggestionBatch&& batch);
+	void Tag(const Job& job);
+	static void FreeResults(Result* results);
 };
@@ -0,0 +1,52 @@
+﻿#include "framework.h"
+
+#include "SuggestionCache.h"
+
+// 結果を引く
+const TagHandleList* SuggestionCache::Find(const std::string& input, uint64_t version) {
+	lookups_++;
+	auto it = index_.find(input);
+	if (it == index_.end() || it->second->version != version) return nullptr;
+
+	// 使ったものを先頭に移す
+	entries_.splice(entries_.begin(), entries_, it->second);
+	auto& entry = entries_.front();
+	hits_++;
+	if (entry.speculative) {
+		speculative_hits_++;
+		entry.speculative = false;
+	}
+	return &entry.suggestions;
+}
+
+// 結果があるか
+bool SuggestionCache::Contains(const std::string& input, uint64_t version) const {
+	auto it = index_.find(input);
+	return it != index_.end() && it->second->version == version;
+}
+
+// 結果を登録
+void SuggestionCache::Store(const std::string& input, uint64_t version, TagHandleList suggestions, bool speculative) {
+	if (capacity_ == 0) return;
+	if (speculative) speculative_stores_++;
+
+	auto it = index_.find(input);
+	if (it != index_.end()) {
+		entries_.erase(it->second);
+		index_.erase(it);
+	}
+	entries_.push_front({ input, version, std::move(suggestions), speculative });
+	index_[input] = entries_.begin();
+
+	// 最も長く使っていないものから削除
+	while (entries_.size() > capacity_) {
+		index_.erase(entries_.back().input);
+		entries_.pop_back();
+	}
+}
+
+// 全て削除
+void SuggestionCache::Clear() {
+	entries_.clear();
+	index_.clear();
+}
@@ -0,0 +1,54 @@
+﻿#pragma once
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+#include "Tag.h"
+
+// 入力ごとのサジェストの結果（最近使った順に一定件数まで保持する）
+// 辞書の版（BooruDB::Version）が変わった結果は使わない
+// 先読みで求めた結果も同じ場所に入れ、実際に使われた割合を数える
+// ワーカースレッドからのみ使う
+class SuggestionCache {
+public:
+	static constexpr size_t DEFAULT_CAPACITY = 64;
+
+	explicit SuggestionCache(size_t capacity = DEFAULT_CAPACITY) : capacity_(capacity) {}
+
+	// 結果を引く（なければ nullptr、次に Store するまで有効）
+	const TagHandleList* Find(const std::string& input, uint64_t version);
+
+	// 結果があるか（統計には数えない）
+	bool Contains(const std::string& input, uint64_t version) const;
+
+	// 結果を登録（speculative は先読みで求めた結果）
+	void Store(const std::string& input, uint64_t version, TagHandleList suggestions, bool speculative);
+
+	// 全て削除
+	void Clear();
+
+	size_t Size() const { return entries_.size(); }
+
+	// 統計
+	uint64_t Lookups() const { return lookups_; }
+	uint64_t Hits() const { return hits_; }
+	uint64_t SpeculativeStores() const { return speculative_stores_; } // 先読みで登録した数
+	uint64_t SpeculativeHits() const { return speculative_hits_; }     // そのうち実際に使われた数
+
+private:
+	struct Entry {
+		std::string input;
+		uint64_t version;
+		TagHandleList suggestions;
+		bool speculative; // 先読みで登録してからまだ使われていない
+	};
+
+	size_t capacity_;
+	std::list<Entry> entries_; // 最近使ったものが先頭
+	std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+	uint64_t lookups_ = 0;
+	uint64_t hits_ = 0;
+	uint64_t speculative_stores_ = 0;
+	uint64_t speculative_hits_ = 0;
+};
@@ -4,30 +4,80 @@
 #include "TextUtils.h"
 #include "TagListHandler.h"
 #include "FavoriteTags.h"
+#include "BooruDB.h"
 
-void SuggestionHandler::UpdateSuggestionList(BooruPrompter* pThis, const TagList& suggestions) {
-	pThis->m_currentSuggestions = suggestions;
-	pThis->RefreshTagList(pThis->m_hwndSuggestions, suggestions);
+// お気に入りリストを表示
+void SuggestionHandler::UpdateSuggestionList(BooruPrompter* pThis, const TagList& favorites) {
+	pThis->m_favoriteItems = favorites;
+	pThis->m_currentSuggestions.clear();
+	pThis->RefreshListView(pThis->m_hwndSuggestions, favorites.size());
+}
+
+// 段階ごとの結果を反映（offset 件に切り詰めてから末尾に追加する）
+// 行の文字列は描画するときに求めるので、ここではハンドルを並べ替えるだけ
+void SuggestionHandler::AppendSuggestions(BooruPrompter* pThis, const SuggestionBatch& batch) {
+	auto& current = pThis->m_currentSuggestions;
+	auto offset = std::min(batch.offset, current.size());
+	current.erase(current.begin() + offset, current.end());
+	current.insert(current.end(), batch.suggestions.begin(), batch.suggestions.end());
+	pThis->RefreshListView(pThis->m_hwndSuggestions, current.size());
+}
+
+// 描画する行の文字列を求める
+void SuggestionHandler::OnGetDispInfo(BooruPrompter* pThis, NMLVDISPINFO* info) {
+	int row = info->item.iItem;
+	if (row < 0 || static_cast<size_t>(row) >= GetCount(pThis)) return;
+	if (pThis->m_showingFavorites) {
+		const auto& item = pThis->m_favoriteItems[row];
+		BooruPrompter::SetDispInfoText(info, info->item.iSubItem == 0 ? utf8_to_unicode(item.tag) : item.description);
+		return;
+	}
+	auto tag = BooruDB::GetInstance().GetTagName(pThis->m_currentSuggestions[row]);
+	if (info->item.iSubItem == 0) {
+		BooruPrompter::SetDispInfoText(info, utf8_to_unicode(tag));
+	} else {
+		BooruPrompter::SetDispInfoText(info, BooruDB::GetInstance().GetDescription(tag));
+	}
+}
+
+// 行のタグ名
+std::string SuggestionHandler::GetTagName(BooruPrompter* pThis, int index) {
+	if (index < 0 || static_cast<size_t>(index) >= GetCount(pThis)) return {};
+	if (pThis->m_showingFavorites) return pThis->m_favoriteItems[index].tag;
+	return BooruDB::GetInstance().GetTagName(pThis->m_currentSuggestions[index]);
+}
+
+// 行のカテゴリー
+int SuggestionHandler::GetCategory(BooruPrompter* pThis, int index) {
+	if (index < 0 || static_cast<size_t>(index) >= GetCount(pThis)) return 0;
+	if (pThis->m_showingFavorites) return pThis->m_favoriteItems[index].category;
+	return BooruDB::GetInstance().GetTagCategory(pThis->m_currentSuggestions[index]);
+}
+
+// 行数
+size_t SuggestionHandler::GetCount(BooruPrompter* pThis) {
+	return pThis->m_showingFavorites ? pThis->m_favoriteItems.size() : pThis->m_currentSuggestions.size();
 }
 
 void SuggestionHandler::OnSuggestionSelected(BooruPrompter* pThis, int index) {
-	if (index < 0 || index >= static_cast<int>(pThis->m_currentSuggestions.size())) {
+	if (index < 0 || index >= static_cast<int>(GetCount(pThis))) {
 		return;
 	}
 
 	// 選択したタグを取得
-	const auto& selectedTag = pThis->m_currentSuggestions[index].tag;
+	const auto selectedTag = GetTagName(pThis, index);
 
 	// 現在のカーソル位置を取得
 	DWORD startPos = pThis->m_promptEditor->GetSelectionStart();
 	DWORD endPos = pThis->m_promptEditor->GetSelectionEnd();
 
-	// 現在のテキストを取得
-	auto currentText = pThis->m_promptEditor->GetText();
+	// 現在のテキスト（エディターの文書）
+	const auto& document = pThis->m_promptEditor->GetDocument();
+	const auto& currentText = document.Text();
 
 	// カーソル位置のワード範囲を取得
 	if (startPos > 0) --startPos;
-	const auto [start, end] = get_span_at_cursor(currentText, static_cast<int>(startPos));
+	const auto [start, end] = document.WordRangeAt(startPos);
 
 	// タグを挿入
 	auto insertTag = selectedTag;
@@ -42,7 +92,7 @@ void SuggestionHandler::OnSuggestionSelected(BooruPrompter* pThis, int index) {
 	pThis->m_promptEditor->SetFocus();
 
 	// タグリストを更新
-	TagListHandler::SyncTagListFromPrompt(pThis, newText);
+	TagListHandler::SyncTagListFromDocument(pThis, document);
 
 	pThis->m_suggestionManager.Request({});
 }
@@ -55,7 +105,7 @@ void SuggestionHandler::OnSuggestionContextMenu(BooruPrompter* pThis, int x, int
 	ht.pt = pt;
 	int itemIndex = ListView_HitTest(pThis->m_hwndSuggestions, &ht);
 
-	if (itemIndex < 0 || itemIndex >= static_cast<int>(pThis->m_currentSuggestions.size())) {
+	if (itemIndex < 0 || itemIndex >= static_cast<int>(GetCount(pThis))) {
 		return;
 	}
 
@@ -82,11 +132,11 @@ void SuggestionHandler::OnSuggestionContextMenu(BooruPrompter* pThis, int x, int
 	}
 
 	if (!pThis->m_showingFavorites && commandId == ID_CONTEXT_ADD_FAVORITE) {
-		const auto& tag = pThis->m_currentSuggestions[itemIndex];
-		if (FavoriteTags::AddFavorite(tag.tag)) {
-			pThis->UpdateStatusText(L"お気に入りに追加: " + utf8_to_unicode(tag.tag));
+		const auto tag = GetTagName(pThis, itemIndex);
+		if (FavoriteTags::AddFavorite(tag)) {
+			pThis->UpdateStatusText(L"お気に入りに追加: " + utf8_to_unicode(tag));
 		} else {
-			pThis->UpdateStatusText(L"既にお気に入りに登録されています: " + utf8_to_unicode(tag.tag));
+			pThis->UpdateStatusText(L"既にお気に入りに登録されています: " + utf8_to_unicode(tag));
 		}
 		return;
 	}
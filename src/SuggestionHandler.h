@@ -1,12 +1,25 @@
 ﻿#pragma once
+#include <windows.h>
+#include <commctrl.h>
+
 #include "Tag.h"
+#include "Suggestion.h"
 
 class BooruPrompter;
 
 // サジェスト関連のメソッド
 class SuggestionHandler {
 public:
-	static void UpdateSuggestionList(BooruPrompter* pThis, const TagList& suggestions);
+	// お気に入りリストを表示
+	static void UpdateSuggestionList(BooruPrompter* pThis, const TagList& favorites);
+	// 段階ごとの結果を反映
+	static void AppendSuggestions(BooruPrompter* pThis, const SuggestionBatch& batch);
+	// 描画する行の文字列を求める（LVN_GETDISPINFO）
+	static void OnGetDispInfo(BooruPrompter* pThis, NMLVDISPINFO* info);
+	// 行のタグ名とカテゴリー（表示中の内容がお気に入りかサジェストかによらない）
+	static std::string GetTagName(BooruPrompter* pThis, int index);
+	static int GetCategory(BooruPrompter* pThis, int index);
+	static size_t GetCount(BooruPrompter* pThis);
 	static void OnSuggestionSelected(BooruPrompter* pThis, int index);
 	static void OnSuggestionContextMenu(BooruPrompter* pThis, int x, int y);
 };
@@ -1,4 +1,5 @@
 ﻿#pragma once
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -11,3 +12,43 @@ struct Tag {
 
 typedef std::vector<Tag> TagList;
 
+// プロンプト内のタグの種類
+enum class TagSpanKind : uint8_t {
+	Tag,          // タグ
+	OpenBracket,  // 開き括弧
+	CloseBracket, // 閉じ括弧
+	Weight,       // 重み（コロンから閉じ括弧まで）
+	Newline,      // 改行
+};
+
+// プロンプト内のタグの範囲（文字列は持たず、必要なときに tag_span_text で求める）
+struct TagSpan {
+	size_t start, end;
+	TagSpanKind kind;
+};
+
+typedef std::vector<TagSpan> TagSpanList;
+
+// サジェストの段階（どの検索で見つかったか）
+enum class SuggestionStage : uint8_t {
+	Clear,   // リクエストの直後（表示を消す）
+	Exact,   // 完全一致
+	Prefix,  // 前方一致（索引）
+	Alias,   // 別名の前方一致
+	Romaji,  // ローマ字の逆引き
+	Fuzzy,   // 曖昧検索
+	Reverse, // 日本語の逆引き
+	Mixed,   // 英語と日本語の混在
+	Cached,  // 前に求めた結果（先読みした結果を含む）
+};
+
+// サジェストの結果（辞書内のタグを指すハンドル）
+// 検索では文字列を作らず、タグ名や説明は表示するときに BooruDB から求める
+struct TagHandle {
+	uint32_t id;           // 辞書内のインデックス
+	float score;           // ランキングのスコア
+	SuggestionStage stage; // 見つかった段階
+};
+
+typedef std::vector<TagHandle> TagHandleList;
+
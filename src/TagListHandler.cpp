@@ -10,12 +10,27 @@
 
 // 静的メンバー変数の定義
 TagList TagListHandler::s_tagItems;
+PromptDocument TagListHandler::s_promptDocument;
+const PromptDocument* TagListHandler::s_syncedDocument = nullptr;
+uint64_t TagListHandler::s_syncedVersion = 0;
 int TagListHandler::s_dragIndex = -1;
 int TagListHandler::s_dragTargetIndex = -1;
 bool TagListHandler::s_isDragging = false;
 
 void TagListHandler::RefreshTagList(BooruPrompter* pThis) {
-	pThis->RefreshTagList(pThis->m_hwndTagList, s_tagItems);
+	pThis->RefreshListView(pThis->m_hwndTagList, s_tagItems.size());
+}
+
+// 描画する行の文字列を求める（説明は描画する行の分だけ作る）
+void TagListHandler::OnGetDispInfo(BooruPrompter* pThis, NMLVDISPINFO* info) {
+	int row = info->item.iItem;
+	if (row < 0 || row >= static_cast<int>(s_tagItems.size())) return;
+	const auto& tag = s_tagItems[row].tag;
+	if (info->item.iSubItem == 0) {
+		BooruPrompter::SetDispInfoText(info, utf8_to_unicode(tag));
+	} else {
+		BooruPrompter::SetDispInfoText(info, BooruDB::GetInstance().GetDescription(tag));
+	}
 }
 
 void TagListHandler::OnTagListDragDrop(BooruPrompter* pThis, int fromIndex, int toIndex) {
@@ -67,24 +82,31 @@ void TagListHandler::UpdatePromptFromTagList(BooruPrompter* pThis) {
 }
 
 void TagListHandler::SyncTagListFromPrompt(BooruPrompter* pThis, const std::string& prompt) {
-	s_tagItems = extract_tags_from_text(prompt);
+	s_promptDocument.Update(prompt);
+	SyncTagListFromDocument(pThis, s_promptDocument);
+}
+
+// 文書のタグの表からタグリストを作る（文書の解析結果をそのまま使い、解析し直さない）
+void TagListHandler::SyncTagListFromDocument(BooruPrompter* pThis, const PromptDocument& document) {
+	if (s_syncedDocument == &document && s_syncedVersion == document.Version()) {
+		return;
+	}
+	s_tagItems = document.Tags();
 	for (auto& tag : s_tagItems) {
-		// start と end の位置情報を保持
-		size_t start = tag.start;
-		size_t end = tag.end;
-		tag = BooruDB::GetInstance().MakeSuggestion(tag.tag);
-		tag.start = start;
-		tag.end = end;
+		// 説明は描画するときに求めるので、ここではカテゴリー（色分けと整理に使う）だけを設定
+		tag.category = BooruDB::GetInstance().GetTagCategory(tag.tag);
 	}
+	s_syncedDocument = &document;
+	s_syncedVersion = document.Version();
 	RefreshTagList(pThis);
 }
 
 void TagListHandler::SyncTagList(BooruPrompter* pThis, const std::vector<std::string>& tags) {
 	s_tagItems.clear();
 	s_tagItems.reserve(tags.size());
+	s_syncedDocument = nullptr;
 	for (const auto& tag : tags) {
-		Tag sug = BooruDB::GetInstance().MakeSuggestion(tag);
-		s_tagItems.push_back(sug);
+		s_tagItems.push_back({ tag, L"", BooruDB::GetInstance().GetTagCategory(tag), 0, 0 });
 	}
 	RefreshTagList(pThis);
 }
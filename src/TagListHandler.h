@@ -2,8 +2,10 @@
 
 #include <vector>
 #include <windows.h>
+#include <commctrl.h>
 
 #include "Tag.h"
+#include "PromptDocument.h"
 
 class BooruPrompter;
 
@@ -20,6 +22,7 @@ class TagListHandler {
 public:
 	// タグリスト関連
 	static void RefreshTagList(BooruPrompter* pThis);
+	static void OnGetDispInfo(BooruPrompter* pThis, NMLVDISPINFO* info);
 	static void OnTagListDragDrop(BooruPrompter* pThis, int fromIndex, int toIndex);
 	static void OnTagListDragStart(BooruPrompter* pThis, int index);
 	static void OnTagListDragEnd(BooruPrompter* pThis);
@@ -27,6 +30,7 @@ public:
 	// プロンプト・タグ同期
 	static void UpdatePromptFromTagList(BooruPrompter* pThis);
 	static void SyncTagListFromPrompt(BooruPrompter* pThis, const std::string& prompt);
+	static void SyncTagListFromDocument(BooruPrompter* pThis, const PromptDocument& document);
 	static void SyncTagList(BooruPrompter* pThis, const std::vector<std::string>& tags);
 
 	// コンテキストメニュー関連
@@ -60,6 +64,9 @@ public:
 private:
 	// タグリスト関連のメンバー変数
 	static TagList s_tagItems;
+	static PromptDocument s_promptDocument;         // エディターを通さずに同期したプロンプト
+	static const PromptDocument* s_syncedDocument;  // 最後に同期した文書とその版（同じ版なら同期し直さない）
+	static uint64_t s_syncedVersion;
 	static int s_dragIndex;        // ドラッグ中のアイテムインデックス
 	static int s_dragTargetIndex;  // ドラッグ先のアイテムインデックス
 	static bool s_isDragging;      // ドラッグ中かどうか
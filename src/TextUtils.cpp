@@ -1,27 +1,42 @@
 ﻿#include "framework.h"
+#include <algorithm>
 #include <filesystem>
 #include <sstream>
+#include <cctype>
 
 #include "TextUtils.h"
 
-// UTF-8→ユニコード変換
-std::wstring utf8_to_unicode(const std::string& utf8_string) {
+// UTF-8→ユニコード変換（変換できなければ空文字列）
+template <typename String>
+static void convert_utf8_to_unicode(std::string_view utf8_string, String& result) {
+	result.clear();
 	if (utf8_string.empty()) {
-		return std::wstring();
+		return;
 	}
 
-	int size = MultiByteToWideChar(CP_UTF8, 0, utf8_string.c_str(), -1, nullptr, 0);
+	int length = static_cast<int>(utf8_string.size());
+	int size = MultiByteToWideChar(CP_UTF8, 0, utf8_string.data(), length, nullptr, 0);
 	if (size == 0) {
-		return std::wstring();
+		return;
 	}
 
-	std::vector<wchar_t> buffer(size);
-	int result = MultiByteToWideChar(CP_UTF8, 0, utf8_string.c_str(), -1, buffer.data(), size);
-	if (result == 0) {
-		return std::wstring();
+	result.resize(size);
+	int converted = MultiByteToWideChar(CP_UTF8, 0, utf8_string.data(), length, result.data(), size);
+	if (converted == 0) {
+		result.clear();
 	}
+}
+
+std::wstring utf8_to_unicode(std::string_view utf8_string) {
+	std::wstring result;
+	convert_utf8_to_unicode(utf8_string, result);
+	return result;
+}
 
-	return std::wstring(buffer.begin(), buffer.end() - 1);
+std::pmr::wstring utf8_to_unicode(std::string_view utf8_string, std::pmr::memory_resource* resource) {
+	std::pmr::wstring result(resource);
+	convert_utf8_to_unicode(utf8_string, result);
+	return result;
 }
 
 // ユニコード→UTF-8変換
@@ -66,12 +81,53 @@ std::string booru_to_image_tag(const std::string& booru_tag) {
 }
 
 // UTF-8文字列にマルチバイト文字が含まれているかを判定
-bool utf8_has_multibyte(const std::string& str) {
+bool utf8_has_multibyte(std::string_view str) {
 	return std::any_of(str.begin(), str.end(), [](unsigned char c) {
 		return c >= 0x80;
 		});
 }
 
+// 文字種の連続ごとに分割
+// 分割した部分ごとに run(部分) を呼ぶ
+template <typename Callback>
+static void for_each_script_run(std::string_view str, Callback&& run) {
+	auto trimmed = [&](size_t first, size_t last) {
+		auto part = str.substr(first, last - first);
+		size_t begin = part.find_first_not_of(" \t\n\r");
+		size_t end = part.find_last_not_of(" \t\n\r");
+		return part.substr(begin, end - begin + 1);
+	};
+	size_t start = 0;      // 現在の部分の開始位置
+	bool content = false;  // 現在の部分に空白以外の文字があるか
+	bool current_multibyte = false;
+	for (size_t i = 0; i < str.size(); ++i) {
+		unsigned char c = str[i];
+		if (c != ' ' && c != '\t') {
+			bool multibyte = c >= 0x80;
+			if (multibyte != current_multibyte && content) {
+				run(trimmed(start, i));
+				start = i;
+				content = false;
+			}
+			current_multibyte = multibyte;
+		}
+		if (c != ' ' && c != '\t' && c != '\n' && c != '\r') content = true;
+	}
+	if (content) run(trimmed(start, str.size()));
+}
+
+std::vector<std::string> split_script_runs(std::string_view str) {
+	std::vector<std::string> runs;
+	for_each_script_run(str, [&](std::string_view run) { runs.emplace_back(run); });
+	return runs;
+}
+
+std::pmr::vector<std::string_view> split_script_runs(std::string_view str, std::pmr::memory_resource* resource) {
+	std::pmr::vector<std::string_view> runs(resource);
+	for_each_script_run(str, [&](std::string_view run) { runs.push_back(run); });
+	return runs;
+}
+
 // カーソル位置のワード範囲取得
 std::tuple<size_t, size_t> get_span_at_cursor(const std::string& text, int pos) {
 	// カーソル位置の前後のカンマまたは改行を探す
@@ -96,6 +152,23 @@ std::tuple<size_t, size_t> get_span_at_cursor(const std::string& text, int pos)
 	return { start, end };
 }
 
+// 2つのテキストの異なる範囲
+bool find_changed_range(std::string_view before, std::string_view after, size_t& position, size_t& deletedLength, size_t& insertedLength) {
+	size_t common = std::min(before.size(), after.size());
+	size_t prefix = std::mismatch(after.begin(), after.begin() + common, before.begin()).first - after.begin();
+	if (prefix == common && before.size() == after.size()) {
+		return false;
+	}
+	size_t suffix = 0;
+	while (suffix < common - prefix && after[after.size() - 1 - suffix] == before[before.size() - 1 - suffix]) {
+		++suffix;
+	}
+	position = prefix;
+	deletedLength = before.size() - prefix - suffix;
+	insertedLength = after.size() - prefix - suffix;
+	return true;
+}
+
 // トリミング
 std::wstring trim(const std::wstring& text) {
 	if (text.empty()) {
@@ -255,7 +328,7 @@ bool is_delimiter_tag(const std::string& tag) {
 }
 
 // 括弧タグかどうかを判定（開き括弧、閉じ括弧）
-bool is_bracket_tag(const std::string& tag) {
+bool is_bracket_tag(std::string_view tag) {
 	if (tag.empty()) {
 		return false;
 	}
@@ -269,55 +342,114 @@ bool is_bracket_tag(const std::string& tag) {
 	return false;
 }
 
+// タグの範囲から除く空白と、タグの文字列から除く空白（trim と同じ）
+static constexpr std::string_view SPAN_SPACES = " \t\n";
+static constexpr std::string_view TRIM_SPACES = " \t\n\r";
 
-// カンマ区切り文字列からタグを抽出
-TagList extract_tags_from_text(const std::string& text) {
-	TagList result;
-	if (text.empty()) {
-		return result;
+// 前後の空白を除いた部分（文字列は作らない）
+static std::string_view trim_view(std::string_view text) {
+	size_t first = text.find_first_not_of(TRIM_SPACES);
+	if (first == std::string_view::npos) return std::string_view();
+	size_t last = text.find_last_not_of(TRIM_SPACES);
+	return text.substr(first, last - first + 1);
+}
+
+// 重み付きの範囲のうち、閉じ括弧の前の空白を除いたコロンからの部分
+static std::string_view weight_view(std::string_view text, const TagSpan& span) {
+	auto weight = text.substr(span.start, span.end - 1 - span.start);
+	return weight.substr(0, weight.find_last_not_of(TRIM_SPACES) + 1);
+}
+
+// [first, last) の前後の空白を除いた範囲をタグとして追加（空白だけなら追加しない）
+static void add_tag_span(std::string_view text, size_t first, size_t last, TagSpanList& spans) {
+	auto segment = text.substr(first, last - first);
+	if (segment.find_first_not_of(TRIM_SPACES) == std::string_view::npos) {
+		return;
 	}
-	result.reserve(text.length());
+	size_t begin = segment.find_first_not_of(SPAN_SPACES);
+	size_t end = segment.find_last_not_of(SPAN_SPACES);
+	spans.push_back({ first + begin, first + end + 1, TagSpanKind::Tag });
+}
 
-	size_t pos = 0;
-	size_t segmentStart = 0;
+// 括弧の中身 [contentStart, closePos) と閉じ括弧を追加
+static void add_bracket_spans(std::string_view text, size_t contentStart, size_t closePos, TagSpanList& spans) {
+	if (closePos > contentStart) {
+		// 最後のカンマの位置を探す（エスケープを考慮）
+		size_t lastComma = std::string_view::npos;
+		for (size_t i = closePos; i > contentStart; ) {
+			i--;
+			if (text[i] == ',' && (i == contentStart || text[i - 1] != '\\')) {
+				lastComma = i;
+				break;
+			}
+		}
+
+		// 最後のカンマより前の部分をカンマで区切る
+		if (lastComma != std::string_view::npos) {
+			size_t pos = contentStart;
+			size_t start = contentStart;
+			while (pos < lastComma) {
+				// エスケープ文字の処理
+				if (text[pos] == '\\' && pos + 1 < lastComma) {
+					pos += 2;
+					continue;
+				}
+				if (text[pos] == ',') {
+					if (pos > start) {
+						add_tag_span(text, start, pos, spans);
+					}
+					start = pos + 1;
+				}
+				pos++;
+			}
+			if (pos > start) {
+				add_tag_span(text, start, pos, spans);
+			}
+		}
+
+		// 最後のセグメント（最後のカンマから閉じ括弧まで）を処理
+		size_t lastStart = (lastComma == std::string_view::npos) ? contentStart : lastComma + 1;
+		auto lastSegment = text.substr(lastStart, closePos - lastStart);
+		auto trimmed = trim_view(lastSegment);
+		size_t colon = trimmed.find(':');
+		if (!trimmed.empty() && colon != std::string_view::npos) {
+			// コロンが含まれている場合は閉じ括弧も含めて1つのタグにする（コロンの前の部分は先に追加）
+			size_t colonPos = static_cast<size_t>(trimmed.data() - text.data()) + colon;
+			if (colon > 0 && !trim_view(trimmed.substr(0, colon)).empty()) {
+				spans.push_back({ lastStart + lastSegment.find_first_not_of(SPAN_SPACES), colonPos, TagSpanKind::Tag });
+			}
+			spans.push_back({ colonPos, closePos + 1, TagSpanKind::Weight });
+			return;
+		}
+		if (!trimmed.empty()) {
+			add_tag_span(text, lastStart, closePos, spans);
+		}
+	}
+
+	// 閉じ括弧を単独タグとして追加
+	spans.push_back({ closePos, closePos + 1, TagSpanKind::CloseBracket });
+}
+
+// プロンプトの start 以降をタグの範囲に分ける
+size_t tokenize_prompt(std::string_view text, size_t start, TagSpanList& spans, const std::function<bool(size_t)>& boundary) {
+	size_t pos = start;
+	size_t segmentStart = start;
 	bool inBracket = false;
 
 	while (pos < text.length()) {
-		// エスケープ文字の処理
+		// エスケープ文字の処理（次の文字をスキップ）
 		if (text[pos] == '\\' && pos + 1 < text.length()) {
-			// エスケープされた文字なので、次の文字をスキップ
 			pos += 2;
 			continue;
 		}
 
 		// 括弧の処理
 		if (text[pos] == '(' && !inBracket) {
-			// 開き括弧の前の部分を処理
+			// 開き括弧の前の部分と、開き括弧自体を追加
 			if (pos > segmentStart) {
-				std::string segment = text.substr(segmentStart, pos - segmentStart);
-				std::string trimmed = trim(segment);
-				if (!trimmed.empty()) {
-					size_t first = segment.find_first_not_of(" \t\n");
-					size_t last = segment.find_last_not_of(" \t\n");
-					size_t trimmedStart = segmentStart + first;
-					size_t trimmedEnd = segmentStart + last + 1;
-
-					Tag tag;
-					tag.tag = trimmed;
-					tag.category = 0;
-					tag.start = trimmedStart;
-					tag.end = trimmedEnd;
-					result.push_back(tag);
-				}
+				add_tag_span(text, segmentStart, pos, spans);
 			}
-
-			// 開き括弧自体をタグとして追加
-			Tag openBracket;
-			openBracket.tag = "(";
-			openBracket.category = 0;
-			openBracket.start = pos;
-			openBracket.end = pos + 1;
-			result.push_back(openBracket);
+			spans.push_back({ pos, pos + 1, TagSpanKind::OpenBracket });
 
 			segmentStart = pos + 1;
 			inBracket = true;
@@ -326,220 +458,254 @@ TagList extract_tags_from_text(const std::string& text) {
 		}
 
 		if (text[pos] == ')' && inBracket) {
-			// 閉じ括弧の前の部分を処理（カンマで区切る）
-			if (pos > segmentStart) {
-				std::string bracketContent = text.substr(segmentStart, pos - segmentStart);
-				size_t contentPos = 0;
-				size_t contentStart = 0;
-
-				// 最後のカンマの位置を探す（エスケープを考慮）
-				size_t lastCommaPos = std::string::npos;
-				for (size_t i = bracketContent.length(); i > 0; ) {
-					i--;
-					if (bracketContent[i] == ',' && (i == 0 || bracketContent[i - 1] != '\\')) {
-						lastCommaPos = i;
-						break;
-					}
-				}
-
-				// 最後のカンマより前の部分を処理
-				if (lastCommaPos != std::string::npos) {
-					std::string beforeLastComma = bracketContent.substr(0, lastCommaPos);
-					size_t beforePos = 0;
-					size_t beforeStart = 0;
-
-					while (beforePos < beforeLastComma.length()) {
-						// エスケープ文字の処理
-						if (beforeLastComma[beforePos] == '\\' && beforePos + 1 < beforeLastComma.length()) {
-							beforePos += 2;
-							continue;
-						}
-
-						// カンマで区切る
-						if (beforeLastComma[beforePos] == ',') {
-							if (beforePos > beforeStart) {
-								std::string tag = beforeLastComma.substr(beforeStart, beforePos - beforeStart);
-								std::string trimmed = trim(tag);
-								if (!trimmed.empty()) {
-									size_t first = tag.find_first_not_of(" \t\n");
-									size_t last = tag.find_last_not_of(" \t\n");
-									size_t trimmedStart = segmentStart + beforeStart + first;
-									size_t trimmedEnd = segmentStart + beforeStart + last + 1;
-
-									Tag tagObj;
-									tagObj.tag = trimmed;
-									tagObj.category = 0;
-									tagObj.start = trimmedStart;
-									tagObj.end = trimmedEnd;
-									result.push_back(tagObj);
-								}
-							}
-							beforeStart = beforePos + 1;
-						}
-						beforePos++;
-					}
-
-					// 最後の部分を処理
-					if (beforePos > beforeStart) {
-						std::string tag = beforeLastComma.substr(beforeStart, beforePos - beforeStart);
-						std::string trimmed = trim(tag);
-						if (!trimmed.empty()) {
-							size_t first = tag.find_first_not_of(" \t\n");
-							size_t last = tag.find_last_not_of(" \t\n");
-							size_t trimmedStart = segmentStart + beforeStart + first;
-							size_t trimmedEnd = segmentStart + beforeStart + last + 1;
-
-							Tag tagObj;
-							tagObj.tag = trimmed;
-							tagObj.category = 0;
-							tagObj.start = trimmedStart;
-							tagObj.end = trimmedEnd;
-							result.push_back(tagObj);
-						}
-					}
-				}
-
-				// 最後のセグメント（最後のカンマから閉じ括弧まで）を処理
-				size_t lastSegmentStart = (lastCommaPos == std::string::npos) ? 0 : lastCommaPos + 1;
-				std::string lastSegment = bracketContent.substr(lastSegmentStart);
-				std::string trimmed = trim(lastSegment);
-
-				// コロンが含まれている場合は閉じ括弧も含めて1つのタグにする
-				size_t colonPos = trimmed.find(':');
-				if (!trimmed.empty() && colonPos != std::string::npos) {
-					// コロンの前の部分を先に処理（あれば）
-					if (colonPos > 0) {
-						std::string beforeColon = trimmed.substr(0, colonPos);
-						std::string beforeColonTrimmed = trim(beforeColon);
-						if (!beforeColonTrimmed.empty()) {
-							size_t first = lastSegment.find_first_not_of(" \t\n");
-							size_t beforeColonStartPos = segmentStart + lastSegmentStart + first;
-							size_t beforeColonEndPos = segmentStart + lastSegmentStart + first + colonPos;
-
-							Tag beforeTagObj;
-							beforeTagObj.tag = beforeColonTrimmed;
-							beforeTagObj.category = 0;
-							beforeTagObj.start = beforeColonStartPos;
-							beforeTagObj.end = beforeColonEndPos;
-							result.push_back(beforeTagObj);
-						}
-					}
-
-					// コロンから閉じ括弧までを含めたタグ
-					std::string colonPart = trimmed.substr(colonPos);
-					size_t first = lastSegment.find_first_not_of(" \t\n");
-					size_t colonStartInOriginal = segmentStart + lastSegmentStart + first + colonPos;
-					size_t trimmedEnd = pos + 1;  // 閉じ括弧を含む
-
-					Tag tagObj;
-					tagObj.tag = colonPart + ")";
-					tagObj.category = 0;
-					tagObj.start = colonStartInOriginal;
-					tagObj.end = trimmedEnd;
-					result.push_back(tagObj);
-				} else if (!trimmed.empty()) {
-					// コロンがない場合は通常通り処理
-					size_t first = lastSegment.find_first_not_of(" \t\n");
-					size_t last = lastSegment.find_last_not_of(" \t\n");
-					size_t trimmedStart = segmentStart + lastSegmentStart + first;
-					size_t trimmedEnd = segmentStart + lastSegmentStart + last + 1;
-
-					Tag tagObj;
-					tagObj.tag = trimmed;
-					tagObj.category = 0;
-					tagObj.start = trimmedStart;
-					tagObj.end = trimmedEnd;
-					result.push_back(tagObj);
-
-					// 閉じ括弧を単独タグとして追加
-					Tag closeBracket;
-					closeBracket.tag = ")";
-					closeBracket.category = 0;
-					closeBracket.start = pos;
-					closeBracket.end = pos + 1;
-					result.push_back(closeBracket);
-				} else {
-					// 空の場合は閉じ括弧だけ
-					Tag closeBracket;
-					closeBracket.tag = ")";
-					closeBracket.category = 0;
-					closeBracket.start = pos;
-					closeBracket.end = pos + 1;
-					result.push_back(closeBracket);
-				}
-			} else {
-				// 括弧が空の場合は閉じ括弧を単独タグとして追加
-				Tag closeBracket;
-				closeBracket.tag = ")";
-				closeBracket.category = 0;
-				closeBracket.start = pos;
-				closeBracket.end = pos + 1;
-				result.push_back(closeBracket);
-			}
+			add_bracket_spans(text, segmentStart, pos, spans);
 
 			segmentStart = pos + 1;
 			inBracket = false;
 			pos++;
+			if (!boundary(pos)) return pos;
 			continue;
 		}
 
 		// カンマまたは改行の処理（括弧の外のみ）
-		if (!inBracket) {
-			if (text[pos] == ',' || text[pos] == '\n') {
-				// セグメントを処理
-				if (pos > segmentStart) {
-					std::string segment = text.substr(segmentStart, pos - segmentStart);
-					std::string trimmed = trim(segment);
-					if (!trimmed.empty()) {
-						size_t first = segment.find_first_not_of(" \t\n");
-						size_t last = segment.find_last_not_of(" \t\n");
-						size_t trimmedStart = segmentStart + first;
-						size_t trimmedEnd = segmentStart + last + 1;
-
-						Tag tag;
-						tag.tag = trimmed;
-						tag.category = 0;
-						tag.start = trimmedStart;
-						tag.end = trimmedEnd;
-						result.push_back(tag);
-					}
-				}
-
-				// 改行コードの場合、改行コード自体もタグとして追加
-				if (text[pos] == '\n') {
-					Tag newlineTag;
-					newlineTag.tag = "\n";
-					newlineTag.category = 0;
-					newlineTag.start = pos;
-					newlineTag.end = pos + 1;
-					result.push_back(newlineTag);
-				}
+		if (!inBracket && (text[pos] == ',' || text[pos] == '\n')) {
+			if (pos > segmentStart) {
+				add_tag_span(text, segmentStart, pos, spans);
+			}
 
-				segmentStart = pos + 1;
+			// 改行コードの場合、改行コード自体もタグとして追加
+			if (text[pos] == '\n') {
+				spans.push_back({ pos, pos + 1, TagSpanKind::Newline });
 			}
+
+			segmentStart = pos + 1;
+			if (!boundary(segmentStart)) return segmentStart;
 		}
 
 		pos++;
 	}
 
-	// 最後のセグメントを処理
+	// 最後のセグメントを処理（閉じていない括弧の中身は追加しない）
 	if (pos > segmentStart && !inBracket) {
-		std::string segment = text.substr(segmentStart, pos - segmentStart);
-		std::string trimmed = trim(segment);
-		if (!trimmed.empty()) {
-			size_t first = segment.find_first_not_of(" \t\n");
-			size_t last = segment.find_last_not_of(" \t\n");
-			size_t trimmedStart = segmentStart + first;
-			size_t trimmedEnd = segmentStart + last + 1;
-
-			Tag tag;
-			tag.tag = trimmed;
-			tag.category = 0;
-			tag.start = trimmedStart;
-			tag.end = trimmedEnd;
-			result.push_back(tag);
+		add_tag_span(text, segmentStart, pos, spans);
+	}
+
+	return pos;
+}
+
+void tokenize_prompt(std::string_view text, TagSpanList& spans) {
+	spans.clear();
+	tokenize_prompt(text, 0, spans, [](size_t) { return true; });
+}
+
+// タグの範囲の文字列
+std::string tag_span_text(std::string_view text, const TagSpan& span) {
+	switch (span.kind) {
+	case TagSpanKind::Tag:
+		return std::string(trim_view(text.substr(span.start, span.end - span.start)));
+	case TagSpanKind::Weight:
+		return std::string(weight_view(text, span)) + ")";
+	default:
+		return std::string(text.substr(span.start, span.end - span.start));
+	}
+}
+
+// 括弧のタグかどうか（is_bracket_tag(tag_span_text(...)) と同じ）
+bool is_bracket_span(std::string_view text, const TagSpan& span) {
+	switch (span.kind) {
+	case TagSpanKind::OpenBracket:
+	case TagSpanKind::CloseBracket:
+		return true;
+	case TagSpanKind::Weight:
+		return weight_view(text, span).back() != '\\';
+	case TagSpanKind::Tag:
+		return is_bracket_tag(trim_view(text.substr(span.start, span.end - span.start)));
+	default:
+		return false;
+	}
+}
+
+// タグの範囲をタグにする
+static void append_span_tags(const std::string& text, const TagSpanList& spans, TagList& result) {
+	result.reserve(result.size() + spans.size());
+	for (const auto& span : spans) {
+		Tag tag;
+		tag.tag = tag_span_text(text, span);
+		tag.category = 0;
+		tag.start = span.start;
+		tag.end = span.end;
+		result.push_back(std::move(tag));
+	}
+}
+
+// カンマ区切り文字列からタグを抽出
+TagList extract_tags_from_text(const std::string& text) {
+	TagList result;
+	if (text.empty()) {
+		return result;
+	}
+	TagSpanList spans;
+	tokenize_prompt(text, spans);
+	append_span_tags(text, spans, result);
+	return result;
+}
+
+// 半角カタカナ（U+FF61～U+FF9F）→全角
+static const wchar_t HALFWIDTH_KATAKANA[] =
+	L"。「」、・ヲァィゥェォャュョッーアイウエオカキクケコサシスセソタチツテトナニヌネノハヒフヘホマミムメモヤユヨラリルレロワン゛゜";
+
+// 濁点を付けられるカタカナか
+static bool can_add_dakuten(wchar_t c) {
+	if (c >= L'カ' && c <= L'ヂ') return (c - L'カ') % 2 == 0;
+	if (c >= L'ツ' && c <= L'ト') return (c - L'ツ') % 2 == 0;
+	if (c >= L'ハ' && c <= L'ホ') return (c - L'ハ') % 3 == 0;
+	return c == L'ウ';
+}
+
+// 半濁点を付けられるカタカナか
+static bool can_add_handakuten(wchar_t c) {
+	return c >= L'ハ' && c <= L'ホ' && (c - L'ハ') % 3 == 0;
+}
+
+// 長音として扱う記号か
+static bool is_long_vowel_variant(wchar_t c) {
+	return c == L'ー' || (c >= 0x2010 && c <= 0x2015) || c == 0x2212 || c == 0x301C || c == 0xFF5E;
+}
+
+// 日本語の表記ゆれを吸収した検索用の文字列に変換
+template <typename String>
+static void normalize_japanese_into(std::wstring_view text, String& result) {
+	result.clear();
+	result.reserve(text.size());
+	for (auto c : text) {
+		if (c >= 0xFF61 && c <= 0xFF9F) {
+			// 半角カタカナ→全角
+			c = HALFWIDTH_KATAKANA[c - 0xFF61];
+		} else if (c >= 0xFF01 && c <= 0xFF5D) {
+			// 全角英数記号→半角（～は長音の揺れとして後で扱う）
+			c = static_cast<wchar_t>(c - 0xFF01 + 0x21);
+		} else if (c == 0x3000) {
+			c = L' ';
+		}
+
+		// ひらがな→カタカナ
+		if ((c >= L'ぁ' && c <= L'ゖ') || c == L'ゝ' || c == L'ゞ') {
+			c = static_cast<wchar_t>(c + (L'ァ' - L'ぁ'));
+		}
+
+		// 濁点・半濁点は直前のカナと合成
+		if (!result.empty()) {
+			wchar_t& prev = result.back();
+			if ((c == L'゛' || c == 0x3099) && can_add_dakuten(prev)) {
+				prev = prev == L'ウ' ? L'ヴ' : static_cast<wchar_t>(prev + 1);
+				continue;
+			}
+			if ((c == L'゜' || c == 0x309A) && can_add_handakuten(prev)) {
+				prev = static_cast<wchar_t>(prev + 2);
+				continue;
+			}
+		}
+
+		// カナの後に続くダッシュや波ダッシュは長音記号に統一
+		if (is_long_vowel_variant(c) && !result.empty() && result.back() >= L'ァ' && result.back() <= L'ヺ') {
+			c = L'ー';
+		} else if (c == 0xFF5E) {
+			c = L'~';
 		}
+
+		result.push_back(c);
 	}
+}
 
+std::wstring normalize_japanese(const std::wstring& text) {
+	std::wstring result;
+	normalize_japanese_into(text, result);
 	return result;
 }
+
+std::pmr::wstring normalize_japanese(std::wstring_view text, std::pmr::memory_resource* resource) {
+	std::pmr::wstring result(resource);
+	normalize_japanese_into(text, result);
+	return result;
+}
+
+// カタカナ（U+30A1～U+30F6）→ローマ字（ヘボン式、小書きの仮名は単独の場合の読み）
+static const char* const KATAKANA_ROMAJI[] = {
+	"a", "a", "i", "i", "u", "u", "e", "e", "o", "o",                 // ァ～オ
+	"ka", "ga", "ki", "gi", "ku", "gu", "ke", "ge", "ko", "go",       // カ～ゴ
+	"sa", "za", "shi", "ji", "su", "zu", "se", "ze", "so", "zo",      // サ～ゾ
+	"ta", "da", "chi", "ji", "", "tsu", "zu", "te", "de", "to", "do", // タ～ド（ッは別に扱う）
+	"na", "ni", "nu", "ne", "no",                                     // ナ～ノ
+	"ha", "ba", "pa", "hi", "bi", "pi", "fu", "bu", "pu",             // ハ～プ
+	"he", "be", "pe", "ho", "bo", "po",                               // ヘ～ポ
+	"ma", "mi", "mu", "me", "mo",                                     // マ～モ
+	"ya", "ya", "yu", "yu", "yo", "yo",                               // ャ～ヨ
+	"ra", "ri", "ru", "re", "ro",                                     // ラ～ロ
+	"wa", "wa", "i", "e", "o", "n", "vu", "ka", "ke",                 // ヮ～ヶ
+};
+
+static bool is_romaji_vowel(char c) {
+	return c == 'a' || c == 'i' || c == 'u' || c == 'e' || c == 'o';
+}
+
+// カタカナをローマ字に変換
+std::string kana_to_romaji(const std::wstring& text) {
+	std::string result;
+	result.reserve(text.size() * 2);
+	bool has_kana = false;
+	bool sokuon = false;      // 直前が「ッ」
+	size_t syllable = std::string::npos; // 直前の仮名の result 内の位置
+	for (auto c : text) {
+		if (c >= L'ァ' && c <= L'ヶ') {
+			has_kana = true;
+			if (c == L'ッ') {
+				sokuon = true;
+				continue;
+			}
+			std::string romaji = KATAKANA_ROMAJI[c - L'ァ'];
+			bool small_y = c == L'ャ' || c == L'ュ' || c == L'ョ';
+			bool small_vowel = c == L'ァ' || c == L'ィ' || c == L'ゥ' || c == L'ェ' || c == L'ォ';
+			if ((small_y || small_vowel) && syllable != std::string::npos && syllable + 1 < result.size()) {
+				// 拗音（キャ→kya、シャ→sha）と外来音（ファ→fa、ティ→ti）は直前の母音を置き換える
+				char vowel = romaji.back();
+				result.pop_back();
+				bool palatal = result.back() == 'h' || result.back() == 'j';
+				if (small_y && !palatal) result.push_back('y');
+				result.push_back(vowel);
+				continue;
+			}
+			if ((small_y || small_vowel) && syllable != std::string::npos && syllable + 1 == result.size()) {
+				// 母音の後の外来音（ウィ→wi、イェ→ye）
+				char prev = result.back();
+				if (prev == 'u' || prev == 'i') {
+					result.back() = prev == 'u' ? 'w' : 'y';
+					result.push_back(romaji.back());
+					continue;
+				}
+			}
+			// 促音は次の子音を重ねる
+			if (sokuon && !is_romaji_vowel(romaji.front()) && romaji.front() != 'n') {
+				result.push_back(romaji.front());
+			}
+			sokuon = false;
+			syllable = result.size();
+			result += romaji;
+		} else if (c == L'ー') {
+			// 長音は直前の母音を繰り返す
+			if (!result.empty() && is_romaji_vowel(result.back())) {
+				result.push_back(result.back());
+			}
+		} else {
+			sokuon = false;
+			syllable = std::string::npos;
+			if (c < 0x80 && std::isalnum(static_cast<unsigned char>(c))) {
+				result.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+			} else if (result.empty() || result.back() != ' ') {
+				// 漢字や記号は読みが分からないので区切りにする
+				result.push_back(' ');
+			}
+		}
+	}
+	if (!has_kana) return "";
+	return trim(result);
+}
@@ -1,10 +1,14 @@
 ﻿#pragma once
+#include <functional>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 #include "Tag.h"
 
 // UTF-8→ユニコード変換
-std::wstring utf8_to_unicode(const std::string& utf8_string);
+std::wstring utf8_to_unicode(std::string_view utf8_string);
+std::pmr::wstring utf8_to_unicode(std::string_view utf8_string, std::pmr::memory_resource* resource);
 
 // ユニコード→UTF-8変換
 std::string unicode_to_utf8(const std::wstring& unicode_string);
@@ -16,11 +20,22 @@ std::wstring fullpath(std::wstring filename);
 std::string booru_to_image_tag(const std::string& booru_tag);
 
 // UTF-8文字列にマルチバイト文字が含まれているかを判定
-bool utf8_has_multibyte(const std::string& str);
+bool utf8_has_multibyte(std::string_view str);
+
+// UTF-8文字列を文字種（ASCII とマルチバイト文字）の連続ごとに分割
+// 空白はどちらの文字種の間にも入るので分割の境界にせず、分割後に前後の空白を取り除く（空になった部分は返さない）
+std::vector<std::string> split_script_runs(std::string_view str);
+// str の部分文字列として返す（配列は resource から確保する）
+std::pmr::vector<std::string_view> split_script_runs(std::string_view str, std::pmr::memory_resource* resource);
 
 // カーソル位置のワード範囲取得
 std::tuple<size_t, size_t> get_span_at_cursor(const std::string& text, int pos);
 
+// 2つのテキストの異なる範囲を求める（先頭と末尾の共通部分を除いた範囲）
+// before の position から deletedLength バイトを、after の position から insertedLength バイトで置き換えると after になる
+// 同じテキストなら false
+bool find_changed_range(std::string_view before, std::string_view after, size_t& position, size_t& deletedLength, size_t& insertedLength);
+
 // 文字列を指定した区切り文字で分割
 std::vector<std::string> split_string(const std::string& str, char delimiter);
 
@@ -41,9 +56,33 @@ std::wstring unescape_newlines(const std::wstring& text);
 
 std::string unescape_newlines(const std::string& text);
 
+// 日本語の表記ゆれを吸収した検索用の文字列に変換
+// ひらがな→カタカナ、全角英数記号→半角、半角カタカナ→全角（濁点・半濁点は合成）、長音記号の統一
+std::wstring normalize_japanese(const std::wstring& text);
+std::pmr::wstring normalize_japanese(std::wstring_view text, std::pmr::memory_resource* resource);
+
+// カタカナをローマ字（ヘボン式）に変換
+// normalize_japanese で変換した文字列を想定し、漢字や記号は空白に置き換える（カタカナを含まなければ空文字列）
+std::string kana_to_romaji(const std::wstring& text);
+
+// プロンプトの start 以降をタグの範囲に分けて spans に追加（文字列は作らない）
+// start は先頭か、括弧の外の区切り（カンマ、改行、閉じ括弧）の直後であること
+// 括弧の外の区切りの直後に来るたびに boundary(位置) を呼び、false が返ればそこで分けるのをやめる
+// 分けるのをやめた位置（最後まで分けたら text の長さ）を返す
+size_t tokenize_prompt(std::string_view text, size_t start, TagSpanList& spans, const std::function<bool(size_t)>& boundary);
+
+// プロンプト全体をタグの範囲に分ける（spans は空にしてから追加する）
+void tokenize_prompt(std::string_view text, TagSpanList& spans);
+
+// タグの範囲の文字列（extract_tags_from_text のタグと同じ）
+std::string tag_span_text(std::string_view text, const TagSpan& span);
+
+// 括弧のタグかどうか（文字列を作らずに is_bracket_tag と同じ判定をする）
+bool is_bracket_span(std::string_view text, const TagSpan& span);
+
 // カンマ区切り文字列からタグを抽出
 TagList extract_tags_from_text(const std::string& text);
 
 // 区切りタグかどうかを判定（改行、開き括弧、閉じ括弧）
 bool is_delimiter_tag(const std::string& tag);
-bool is_bracket_tag(const std::string& tag);
+bool is_bracket_tag(std::string_view tag);
@@ -0,0 +1,203 @@
+﻿#include "framework.h"
+#include <algorithm>
+#include <bit>
+
+#include "TokenSet.h"
+#include "rapidfuzz/fuzz.hpp"
+
+// rapidfuzz と同じ順序（char の辞書順）での比較
+static bool token_less(std::string_view a, std::string_view b) {
+	return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end());
+}
+
+// rapidfuzz と同じ規則で分割・ソート
+static std::vector<std::string_view> split_tokens(const std::string& text) {
+	std::vector<std::string_view> words;
+	auto splitted = rapidfuzz::detail::sorted_split(text.begin(), text.end());
+	words.reserve(splitted.word_count());
+	for (const auto& word : splitted.words()) {
+		words.emplace_back(&*word.begin(), word.size());
+	}
+	return words;
+}
+
+// 分割・ソートして重複を除く
+// 分割とソートの規則は split_tokens と同じだが、rapidfuzz の作業用配列を使わずに resource から確保する
+static std::pmr::vector<std::string_view> unique_tokens(std::string_view text, std::pmr::memory_resource* resource) {
+	std::pmr::vector<std::string_view> words(resource);
+	for (size_t first = 0; first < text.size();) {
+		auto second = first;
+		while (second < text.size() && !rapidfuzz::detail::is_space(text[second])) ++second;
+		if (second != first) words.push_back(text.substr(first, second - first));
+		first = second + 1;
+	}
+	std::sort(words.begin(), words.end(), token_less);
+	words.erase(std::unique(words.begin(), words.end()), words.end());
+	return words;
+}
+
+// 空白で結合
+static std::pmr::string join_tokens(const std::pmr::vector<std::string_view>& words) {
+	std::pmr::string joined(words.get_allocator());
+	for (const auto& word : words) {
+		if (!joined.empty()) joined += ' ';
+		joined += word;
+	}
+	return joined;
+}
+
+// エントリ群を分割してトークン表を構築
+void TokenTable::Build(const std::vector<std::string>& entries) {
+	// 全エントリのトークンを連結して並べる
+	std::vector<std::string_view> words;
+	words.reserve(entries.size() * 3);
+	offsets_.clear();
+	offsets_.reserve(entries.size() + 1);
+	for (const auto& entry : entries) {
+		offsets_.push_back(static_cast<uint32_t>(words.size()));
+		auto splitted = split_tokens(entry);
+		words.insert(words.end(), splitted.begin(), splitted.end());
+	}
+	offsets_.push_back(static_cast<uint32_t>(words.size()));
+
+	// トークンの位置を辞書順に並べ替え、同じトークンに同じIDを振る
+	std::vector<uint32_t> order(words.size());
+	for (size_t i = 0; i < order.size(); ++i) {
+		order[i] = static_cast<uint32_t>(i);
+	}
+	std::sort(order.begin(), order.end(),
+		[&words](uint32_t a, uint32_t b) { return token_less(words[a], words[b]); });
+
+	tokens_.clear();
+	ids_.resize(words.size());
+	for (size_t i = 0; i < order.size(); ++i) {
+		const auto& word = words[order[i]];
+		if (tokens_.empty() || tokens_.back() != word) {
+			tokens_.emplace_back(word);
+		}
+		ids_[order[i]] = static_cast<uint32_t>(tokens_.size() - 1);
+	}
+}
+
+// token 以上となる最初のトークンID
+uint32_t TokenTable::LowerBound(std::string_view token) const {
+	auto it = std::lower_bound(tokens_.begin(), tokens_.end(), token,
+		[](const std::string& a, std::string_view b) { return token_less(a, b); });
+	return static_cast<uint32_t>(it - tokens_.begin());
+}
+
+CachedIndelDistance::CachedIndelDistance(std::string_view s1, std::pmr::memory_resource* resource)
+	: length_(s1.size()), blocks_((s1.size() + 63) / 64), masks_(256 * ((s1.size() + 63) / 64), 0, resource), s_(resource) {
+	for (size_t i = 0; i < s1.size(); ++i) {
+		masks_[static_cast<unsigned char>(s1[i]) * blocks_ + i / 64] |= uint64_t(1) << (i % 64);
+	}
+	s_.resize(blocks_);
+}
+
+// 距離
+// 最長共通部分列の長さ（Hyyrö のビット並列アルゴリズム）から Indel 距離を求める
+size_t CachedIndelDistance::Distance(std::string_view s2, size_t score_cutoff) const {
+	// 長さの差だけで上限を超える場合は計算しない
+	size_t lengthDiff = length_ > s2.size() ? length_ - s2.size() : s2.size() - length_;
+	if (lengthDiff > score_cutoff) return score_cutoff + 1;
+
+	std::fill(s_.begin(), s_.end(), ~uint64_t(0));
+	for (unsigned char c : s2) {
+		const uint64_t* mask = masks_.data() + c * blocks_;
+		uint64_t carry = 0;
+		for (size_t w = 0; w < blocks_; ++w) {
+			uint64_t u = s_[w] & mask[w];
+			uint64_t sum = s_[w] + u;
+			uint64_t x = sum + carry;
+			carry = (sum < u) || (x < sum);
+			s_[w] = x | (s_[w] - u);
+		}
+	}
+	size_t lcs = 0;
+	for (auto bits : s_) {
+		lcs += std::popcount(~bits);
+	}
+	size_t dist = length_ + s2.size() - 2 * lcs;
+	return dist <= score_cutoff ? dist : score_cutoff + 1;
+}
+
+CachedTokenSetScorer::CachedTokenSetScorer(std::string_view input, const TokenTable& table, std::pmr::memory_resource* resource)
+	: table_(table), input_(input, resource), words_(unique_tokens(input_, resource)), keys_(resource),
+	joined_(join_tokens(words_)), indel_(joined_, resource), diff_ab_(resource), diff_ba_(resource) {
+	// 表のトークンと同じ順序で比較できるようにキーへ変換
+	keys_.reserve(words_.size());
+	for (const auto& word : words_) {
+		uint32_t id = table_.LowerBound(word);
+		bool found = id < table_.TokenCount() && table_.Token(id) == word;
+		keys_.push_back(static_cast<uint64_t>(id) * 2 + (found ? 1 : 0));
+	}
+}
+
+// 類似度
+// rapidfuzz の fuzz_detail::token_set_ratio と同じ計算をトークンIDの列に対して行う
+double CachedTokenSetScorer::Similarity(size_t entry, double score_cutoff) const {
+	using rapidfuzz::fuzz::fuzz_detail::norm_distance;
+	using rapidfuzz::fuzz::fuzz_detail::score_cutoff_to_distance;
+
+	if (score_cutoff > 100) return 0;
+
+	auto ids = table_.EntryTokens(entry);
+	if (keys_.empty() || ids.empty()) return 0;
+
+	// 集合の分解（どちらもソート済みなのでマージで求める）
+	diff_ab_.clear();
+	diff_ba_.clear();
+	size_t ab_count = 0, ba_count = 0, sect_count = 0;
+	size_t sect_len = 0;
+	size_t i = 0, j = 0;
+	while (i < keys_.size() || j < ids.size()) {
+		// エントリ側の重複トークンは除く
+		if (j > 0 && j < ids.size() && ids[j] == ids[j - 1]) {
+			++j;
+			continue;
+		}
+		uint64_t inputKey = i < keys_.size() ? keys_[i] : UINT64_MAX;
+		uint64_t entryKey = j < ids.size() ? static_cast<uint64_t>(ids[j]) * 2 + 1 : UINT64_MAX;
+		if (inputKey == entryKey) {
+			sect_len += words_[i].size() + (sect_count ? 1 : 0);
+			++sect_count;
+			++i;
+			++j;
+		} else if (inputKey < entryKey) {
+			if (ab_count++) diff_ab_ += ' ';
+			diff_ab_ += words_[i];
+			++i;
+		} else {
+			if (ba_count++) diff_ba_ += ' ';
+			diff_ba_ += table_.Token(ids[j]);
+			++j;
+		}
+	}
+
+	// 一方が他方に含まれる
+	if (sect_count && (!ab_count || !ba_count)) return 100;
+
+	size_t ab_len = diff_ab_.size();
+	size_t ba_len = diff_ba_.size();
+
+	size_t sect_ab_len = sect_len + bool(sect_len) + ab_len;
+	size_t sect_ba_len = sect_len + bool(sect_len) + ba_len;
+
+	double result = 0;
+	size_t cutoff_distance = score_cutoff_to_distance(score_cutoff, sect_ab_len + sect_ba_len);
+	size_t dist = sect_count
+		? rapidfuzz::indel_distance(diff_ab_, diff_ba_, cutoff_distance)
+		: indel_.Distance(diff_ba_, cutoff_distance);
+
+	if (dist <= cutoff_distance) result = norm_distance(dist, sect_ab_len + sect_ba_len, score_cutoff);
+
+	if (!sect_len) return result;
+
+	size_t sect_ab_dist = bool(sect_len) + ab_len;
+	double sect_ab_ratio = norm_distance(sect_ab_dist, sect_len + sect_ab_len, score_cutoff);
+
+	size_t sect_ba_dist = bool(sect_len) + ba_len;
+	double sect_ba_ratio = norm_distance(sect_ba_dist, sect_len + sect_ba_len, score_cutoff);
+
+	return std::max({ result, sect_ab_ratio, sect_ba_ratio });
+}
@@ -0,0 +1,81 @@
+﻿#pragma once
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 辞書エントリを空白で分割したトークンの表
+// トークンIDは rapidfuzz の分割・ソートと同じ順序（char の辞書順）で振るため、
+// エントリごとのID列は rapidfuzz::fuzz::token_set_ratio が内部で作るトークン列と同じ並びになる
+class TokenTable {
+public:
+	// エントリ群を分割してトークン表を構築
+	void Build(const std::vector<std::string>& entries);
+
+	// エントリのトークンID列（昇順、重複あり）
+	std::span<const uint32_t> EntryTokens(size_t entry) const {
+		return std::span<const uint32_t>(ids_.data() + offsets_[entry], offsets_[entry + 1] - offsets_[entry]);
+	}
+
+	// トークンの文字列
+	const std::string& Token(uint32_t id) const { return tokens_[id]; }
+
+	// トークンの種類数
+	size_t TokenCount() const { return tokens_.size(); }
+
+	// エントリ数
+	size_t EntryCount() const { return offsets_.empty() ? 0 : offsets_.size() - 1; }
+
+	// token 以上となる最初のトークンID（見つからない場合は TokenCount()）
+	uint32_t LowerBound(std::string_view token) const;
+
+private:
+	std::vector<std::string> tokens_; // 辞書順に並べたトークン
+	std::vector<uint32_t> ids_;       // 全エントリのトークンIDを連結したもの
+	std::vector<uint32_t> offsets_;   // エントリごとの ids_ の開始位置（末尾は番兵）
+};
+
+// 比較元を固定した Indel 距離（rapidfuzz::CachedIndel と同じ結果）
+// 比較元の文字ごとの出現位置をビット列（64文字ごとのブロック）にしておき、ビット並列で最長共通部分列を求める
+// ビット列と作業用の配列は resource から確保する
+class CachedIndelDistance {
+public:
+	CachedIndelDistance(std::string_view s1, std::pmr::memory_resource* resource);
+
+	// 距離（score_cutoff を超える場合は score_cutoff + 1）
+	size_t Distance(std::string_view s2, size_t score_cutoff) const;
+
+private:
+	size_t length_;
+	size_t blocks_;
+	std::pmr::vector<uint64_t> masks_;     // 文字ごとのビット列（文字 * blocks_ + ブロック）
+	mutable std::pmr::vector<uint64_t> s_; // 計算用のビット列（使い回し）
+};
+
+// 事前に分割したエントリを対象にした token_set_ratio
+// rapidfuzz::fuzz::CachedTokenSetRatio と同様に入力側の分割結果をキャッシュし、
+// エントリ側は TokenTable のID列を使うので検索のたびに分割・ソートし直さない
+// 結果は rapidfuzz::fuzz::token_set_ratio(input, entry, score_cutoff) と一致する
+// 作業用の文字列と配列は resource から確保する（検索ごとの作業領域を渡せばヒープから確保しない）
+class CachedTokenSetScorer {
+public:
+	CachedTokenSetScorer(std::string_view input, const TokenTable& table,
+		std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+	// 類似度（0～100、score_cutoff 未満は0）
+	double Similarity(size_t entry, double score_cutoff = 0.0) const;
+
+private:
+	const TokenTable& table_;
+	std::pmr::string input_;
+	std::pmr::vector<std::string_view> words_; // 重複を除いてソートした入力のトークン
+	std::pmr::vector<uint64_t> keys_;          // 比較用のキー（表にあれば 2*ID+1、なければ挿入位置の 2*ID）
+	std::pmr::string joined_;                  // words_ を空白で結合したもの
+	CachedIndelDistance indel_;                // 共通トークンが無い場合の比較用
+
+	// 差分の結合結果（使い回し）
+	mutable std::pmr::string diff_ab_;
+	mutable std::pmr::string diff_ba_;
+};
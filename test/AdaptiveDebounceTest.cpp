@@ -0,0 +1,82 @@
+﻿#include "pch.h"
+#include "AdaptiveDebounceTest.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace AdaptiveDebounceTest {
+using Clock = AdaptiveDebounce::Clock;
+using std::chrono::milliseconds;
+
+// 一定の間隔でキー入力を記録
+static Clock::time_point Type(AdaptiveDebounce& debounce, Clock::time_point start, int count, int intervalMs) {
+	auto now = start;
+	for (int i = 0; i < count; ++i) {
+		now += milliseconds(intervalMs);
+		debounce.OnRequest(now);
+	}
+	return now;
+}
+
+void AdaptiveDebounceTest::TestNoHistory() {
+	AdaptiveDebounce debounce;
+	// 記録がなければすぐに始める
+	Assert::AreEqual(0LL, static_cast<long long>(debounce.FuzzyDelay().count()));
+	Assert::IsTrue(debounce.AverageFuzzyLatency() < 0.0);
+	Assert::IsTrue(debounce.AverageTypingInterval() < 0.0);
+}
+
+void AdaptiveDebounceTest::TestFastFuzzy() {
+	AdaptiveDebounce debounce;
+	Type(debounce, Clock::now(), 5, 100);
+	debounce.OnFuzzyCompleted(5.0);
+	// 処理が短ければ入力中でも待たない
+	Assert::AreEqual(0LL, static_cast<long long>(debounce.FuzzyDelay().count()));
+}
+
+void AdaptiveDebounceTest::TestSlowFuzzyWhileTyping() {
+	AdaptiveDebounce debounce;
+	Type(debounce, Clock::now(), 5, 100);
+	debounce.OnFuzzyCompleted(150.0);
+	// 入力の間隔より少し長く待つ
+	auto delay = debounce.FuzzyDelay().count();
+	Assert::IsTrue(delay >= 120);
+	Assert::IsTrue(delay <= 200);
+}
+
+void AdaptiveDebounceTest::TestDelayClamped() {
+	AdaptiveDebounce debounce;
+	Type(debounce, Clock::now(), 5, 10);
+	debounce.OnFuzzyCompleted(20.0);
+	Assert::AreEqual(static_cast<long long>(AdaptiveDebounce::MIN_DELAY_MS), static_cast<long long>(debounce.FuzzyDelay().count()));
+
+	AdaptiveDebounce slow;
+	Type(slow, Clock::now(), 5, 900);
+	slow.OnFuzzyCompleted(2000.0);
+	Assert::AreEqual(static_cast<long long>(AdaptiveDebounce::MAX_DELAY_MS), static_cast<long long>(slow.FuzzyDelay().count()));
+}
+
+void AdaptiveDebounceTest::TestTypingPause() {
+	AdaptiveDebounce debounce;
+	auto now = Type(debounce, Clock::now(), 5, 100);
+	debounce.OnFuzzyCompleted(150.0);
+	Assert::IsTrue(debounce.FuzzyDelay().count() > 0);
+
+	// 入力が途切れたら入力の間隔は測り直し、すぐに始める
+	debounce.OnRequest(now + milliseconds(2000));
+	Assert::IsTrue(debounce.AverageTypingInterval() < 0.0);
+	Assert::AreEqual(0LL, static_cast<long long>(debounce.FuzzyDelay().count()));
+}
+
+void AdaptiveDebounceTest::TestMovingAverage() {
+	AdaptiveDebounce debounce;
+	debounce.OnFuzzyCompleted(100.0);
+	Assert::AreEqual(100.0, debounce.AverageFuzzyLatency(), 0.001);
+	debounce.OnFuzzyCompleted(200.0);
+	Assert::AreEqual(100.0 + AdaptiveDebounce::SMOOTHING * 100.0, debounce.AverageFuzzyLatency(), 0.001);
+
+	auto now = Type(debounce, Clock::now(), 2, 100);
+	Assert::AreEqual(100.0, debounce.AverageTypingInterval(), 0.001);
+	debounce.OnRequest(now + milliseconds(300));
+	Assert::AreEqual(100.0 + AdaptiveDebounce::SMOOTHING * 200.0, debounce.AverageTypingInterval(), 0.001);
+}
+}
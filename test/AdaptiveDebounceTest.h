@@ -0,0 +1,21 @@
+﻿#pragma once
+
+#include "CppUnitTest.h"
+#include "../src/AdaptiveDebounce.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace AdaptiveDebounceTest {
+TEST_CLASS(AdaptiveDebounceTest) {
+public:
+	// 待ち時間のテスト
+	TEST_METHOD(TestNoHistory);
+	TEST_METHOD(TestFastFuzzy);
+	TEST_METHOD(TestSlowFuzzyWhileTyping);
+	TEST_METHOD(TestDelayClamped);
+	TEST_METHOD(TestTypingPause);
+
+	// 移動平均のテスト
+	TEST_METHOD(TestMovingAverage);
+};
+}
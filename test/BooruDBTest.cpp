@@ -15,6 +15,8 @@ static std::wstring ToString<BooruDB>(BooruDB* q) {
 namespace BooruDBTest {
 void BooruDBTest::SetUp() {
 	// テスト前の初期化処理
+	// 辞書ファイルに依存しないよう、テストごとにテスト用の辞書に差し替える
+	BooruDBTestHelper::SetupTestData(BooruDB::GetInstance());
 }
 
 void BooruDBTest::TearDown() {
@@ -106,6 +108,96 @@ void BooruDBTest::TestQuickSuggestionMaxLimit() {
 	Assert::IsTrue(suggestions.size() <= 3);
 }
 
+void BooruDBTest::TestQuickSuggestionPrefixOnly() {
+	// 即時サジェストは前方一致するタグだけを返す
+	BooruDB& db = BooruDB::GetInstance();
+	TagList suggestions;
+	db.QuickSuggestion(suggestions, "blue", 5);
+
+	for (const auto& suggestion : suggestions) {
+		Assert::AreEqual(0, suggestion.tag.compare(0, 4, "blue"));
+	}
+}
+
+void BooruDBTest::TestExactSuggestion() {
+	// 入力と同じ名前のタグだけを返す
+	BooruDB& db = BooruDB::GetInstance();
+	TagList suggestions;
+	Assert::IsTrue(db.ExactSuggestion(suggestions, "blue eyes"));
+	Assert::AreEqual(static_cast<size_t>(1), suggestions.size());
+	Assert::AreEqual(std::string("blue eyes"), suggestions[0].tag);
+
+	// 前方一致するだけのタグは返さない
+	suggestions.clear();
+	Assert::IsTrue(db.ExactSuggestion(suggestions, "blue"));
+	Assert::IsTrue(suggestions.empty());
+
+	// 続けて即時サジェストを呼ぶと、完全一致したタグは前方一致の結果に含まれない
+	TagHandleList handles;
+	db.ExactSuggestion(handles, "blue sky");
+	db.QuickSuggestion(handles, "blue sky", 5);
+	Assert::AreEqual(static_cast<size_t>(1), handles.size());
+}
+
+void BooruDBTest::TestExactSuggestionCategory() {
+	// カテゴリー指定の接頭辞があれば、そのカテゴリーのタグだけを返す
+	BooruDB& db = BooruDB::GetInstance();
+	TagList suggestions;
+	db.ExactSuggestion(suggestions, "char:hatsune miku");
+	Assert::AreEqual(static_cast<size_t>(1), suggestions.size());
+	Assert::AreEqual(std::string("hatsune miku"), suggestions[0].tag);
+
+	suggestions.clear();
+	db.ExactSuggestion(suggestions, "char:1girl");
+	Assert::IsTrue(suggestions.empty());
+
+	// 接頭辞のみの場合は一致するタグがない
+	suggestions.clear();
+	Assert::IsTrue(db.ExactSuggestion(suggestions, "char:"));
+	Assert::IsTrue(suggestions.empty());
+}
+
+void BooruDBTest::TestAliasSuggestion() {
+	// 別名に前方一致すると正式なタグ名で返す
+	BooruDB& db = BooruDB::GetInstance();
+	TagList suggestions;
+	Assert::IsTrue(db.AliasSuggestion(suggestions, "neko", 5));
+	Assert::AreEqual(static_cast<size_t>(1), suggestions.size());
+	Assert::AreEqual(std::string("cat ears"), suggestions[0].tag);
+
+	// 別名の下線は空白に変換して登録し、同じタグの別名がいくつ一致しても1件にまとめる
+	suggestions.clear();
+	db.AliasSuggestion(suggestions, "high res", 5);
+	Assert::AreEqual(static_cast<size_t>(1), suggestions.size());
+	Assert::AreEqual(std::string("highres"), suggestions[0].tag);
+
+	// 引用符で囲まれた列の最初と最後の別名も引ける
+	suggestions.clear();
+	db.AliasSuggestion(suggestions, "1girls", 5);
+	Assert::AreEqual(static_cast<size_t>(1), suggestions.size());
+	Assert::AreEqual(std::string("1girl"), suggestions[0].tag);
+	suggestions.clear();
+	db.AliasSuggestion(suggestions, "hires", 5);
+	Assert::AreEqual(static_cast<size_t>(1), suggestions.size());
+	Assert::AreEqual(std::string("highres"), suggestions[0].tag);
+
+	// カテゴリー指定の接頭辞があれば、そのカテゴリーのタグだけを返す
+	suggestions.clear();
+	db.AliasSuggestion(suggestions, "char:neko", 5);
+	Assert::IsTrue(suggestions.empty());
+}
+
+void BooruDBTest::TestAliasSuggestionExcludesShown() {
+	// 前方一致で表示済みのタグは別名に一致しても返さない
+	BooruDB& db = BooruDB::GetInstance();
+	TagHandleList handles;
+	db.QuickSuggestion(handles, "cat ear", 5);
+	Assert::AreEqual(static_cast<size_t>(1), handles.size());
+	db.AliasSuggestion(handles, "cat ear", 5);
+	Assert::AreEqual(static_cast<size_t>(1), handles.size());
+	Assert::AreEqual(std::string("cat ears"), db.GetTagName(handles[0]));
+}
+
 void BooruDBTest::TestFuzzySuggestion() {
 	// 曖昧検索サジェストのテスト
 	BooruDB& db = BooruDB::GetInstance();
@@ -146,6 +238,89 @@ void BooruDBTest::TestFuzzySuggestionMaxLimit() {
 	Assert::IsTrue(suggestions.size() <= 3);
 }
 
+void BooruDBTest::TestFuzzySuggestionAfterQuick() {
+	// 即時サジェストに続けて曖昧検索した場合のテスト
+	BooruDB& db = BooruDB::GetInstance();
+	TagList suggestions;
+	db.QuickSuggestion(suggestions, "blue", 5);
+	TagList quick = suggestions;
+	db.FuzzySuggestion(suggestions, "blue", 10);
+
+	// 即時サジェストの結果が先頭に残り、重複しないことを確認
+	Assert::IsTrue(suggestions.size() <= quick.size() + 10);
+	for (size_t i = 0; i < quick.size(); ++i) {
+		Assert::AreEqual(quick[i].tag, suggestions[i].tag);
+	}
+	for (size_t i = 0; i < suggestions.size(); ++i) {
+		for (size_t j = i + 1; j < suggestions.size(); ++j) {
+			Assert::AreNotEqual(suggestions[i].tag, suggestions[j].tag);
+		}
+	}
+}
+
+void BooruDBTest::TestFuzzySuggestionWithBudget() {
+	// 十分な制限時間があれば全件を走査し、制限時間なしの検索と同じ結果になる
+	BooruDB& db = BooruDB::GetInstance();
+	BooruDBTestHelper::SetupLargeTestData(db);
+	TagHandleList suggestions;
+	bool exhaustive = false;
+	Assert::IsTrue(db.FuzzySuggestion(suggestions, "blu", 3, std::chrono::milliseconds(10000), exhaustive));
+	Assert::IsTrue(exhaustive);
+
+	TagHandleList expected;
+	db.FuzzySuggestion(expected, "blu", 3);
+	Assert::AreEqual(static_cast<size_t>(3), suggestions.size());
+	for (size_t i = 0; i < expected.size(); ++i) {
+		Assert::AreEqual(expected[i].id, suggestions[i].id);
+	}
+}
+
+void BooruDBTest::TestFuzzySuggestionZeroBudget() {
+	// 制限時間0では最初の確認で時間切れになり、走査を打ち切ってそこまでの結果を返す
+	BooruDB& db = BooruDB::GetInstance();
+	BooruDBTestHelper::SetupLargeTestData(db);
+	TagHandleList suggestions;
+	FuzzyProgress progress;
+	Assert::IsTrue(db.FuzzySuggestion(suggestions, "blu", 3, std::chrono::milliseconds(0), progress));
+	Assert::IsFalse(progress.exhaustive);
+	Assert::IsTrue(progress.next > 0 && progress.next < BooruDBTestHelper::LARGE_DICTIONARY_SIZE);
+	Assert::IsTrue(suggestions.size() <= 3);
+
+	// 投稿数の多い順に走査するので、打ち切られても人気のタグは見つかっている
+	Assert::IsFalse(suggestions.empty());
+	Assert::AreEqual(std::string("blush"), db.GetTagName(suggestions[0]));
+
+	bool exhaustive = true;
+	TagHandleList handles;
+	Assert::IsTrue(db.FuzzySuggestion(handles, "blu", 3, std::chrono::milliseconds(0), exhaustive));
+	Assert::IsFalse(exhaustive);
+}
+
+void BooruDBTest::TestFuzzySuggestionResume() {
+	// 時間切れの位置から続きを走査すると、前回の結果が差し替わり、全件を走査した場合と同じ結果になる
+	BooruDB& db = BooruDB::GetInstance();
+	BooruDBTestHelper::SetupLargeTestData(db);
+	TagHandleList suggestions;
+	db.QuickSuggestion(suggestions, "blu", 2);
+	auto offset = suggestions.size();
+	FuzzyProgress progress;
+	db.FuzzySuggestion(suggestions, "blu", 8, std::chrono::milliseconds(0), progress);
+	Assert::IsFalse(progress.exhaustive);
+	Assert::AreEqual(offset, progress.offset);
+
+	Assert::IsTrue(db.FuzzySuggestion(suggestions, "blu", 8, std::chrono::milliseconds::max(), progress));
+	Assert::IsTrue(progress.exhaustive);
+
+	TagHandleList expected;
+	db.QuickSuggestion(expected, "blu", 2);
+	db.FuzzySuggestion(expected, "blu", 8);
+	Assert::AreEqual(expected.size(), suggestions.size());
+	for (size_t i = 0; i < expected.size(); ++i) {
+		Assert::AreEqual(expected[i].id, suggestions[i].id);
+		Assert::AreEqual(expected[i].score, suggestions[i].score);
+	}
+}
+
 void BooruDBTest::TestReverseSuggestion() {
 	// 逆引きサジェストのテスト
 	BooruDB& db = BooruDB::GetInstance();
@@ -186,13 +361,299 @@ void BooruDBTest::TestReverseSuggestionMaxLimit() {
 	Assert::IsTrue(suggestions.size() <= 3);
 }
 
-void BooruDBTest::TestCancel() {
-	// キャンセル機能のテスト
+void BooruDBTest::TestReverseSuggestionSingleChar() {
+	// 1文字の検索語は説明文の部分一致で引く（n-gram の索引には1文字の n-gram が無い）
 	BooruDB& db = BooruDB::GetInstance();
-	db.Cancel();
+	TagList suggestions;
+	Assert::IsTrue(db.ReverseSuggestion(suggestions, "髪", 5));
+	Assert::AreEqual(static_cast<size_t>(2), suggestions.size());
+	Assert::AreEqual(std::string("blonde hair"), suggestions[0].tag);
+	Assert::AreEqual(std::string("blue hair"), suggestions[1].tag);
+}
 
-	// キャンセルが正常に実行されることを確認
-	Assert::IsTrue(true);
+void BooruDBTest::TestMixedSuggestionEmpty() {
+	BooruDB& db = BooruDB::GetInstance();
+	TagList suggestions;
+	Assert::IsFalse(db.MixedSuggestion(suggestions, "", 5));
+	Assert::IsFalse(db.MixedSuggestion(suggestions, "   ", 5));
+	Assert::IsTrue(suggestions.empty());
+}
+
+void BooruDBTest::TestMixedSuggestionMaxLimit() {
+	// 部分ごとの結果をまとめても最大数を超えない
+	BooruDB& db = BooruDB::GetInstance();
+	TagList suggestions;
+	db.MixedSuggestion(suggestions, "blue 制服", 3);
+	Assert::IsTrue(suggestions.size() <= 3);
+}
+
+void BooruDBTest::TestRomajiSuggestionShortInput() {
+	// 3文字未満は引かない
+	BooruDB& db = BooruDB::GetInstance();
+	TagList suggestions;
+	Assert::IsFalse(db.RomajiSuggestion(suggestions, "ne", 5));
+	Assert::IsTrue(suggestions.empty());
+}
+
+void BooruDBTest::TestRomajiSuggestionMultibyte() {
+	// 日本語の入力は通常の逆引きで扱う
+	BooruDB& db = BooruDB::GetInstance();
+	TagList suggestions;
+	Assert::IsFalse(db.RomajiSuggestion(suggestions, "ねこみみ", 5));
+	Assert::IsTrue(suggestions.empty());
+}
+
+void BooruDBTest::TestRomajiSuggestionMaxLimit() {
+	// 最大数制限のテスト
+	BooruDB& db = BooruDB::GetInstance();
+	TagList suggestions;
+	db.RomajiSuggestion(suggestions, "seifuku", 3);
+	Assert::IsTrue(suggestions.size() <= 3);
+}
+
+void BooruDBTest::TestGetTagPostCountUnknown() {
+	// 辞書に無いタグの投稿数は0
+	BooruDB& db = BooruDB::GetInstance();
+	Assert::AreEqual(0, db.GetTagPostCount("xyz123_unknown_tag"));
+}
+
+void BooruDBTest::TestTopCompletion() {
+	// 前方一致するタグのうち最も人気のものを補完する
+	BooruDB& db = BooruDB::GetInstance();
+	std::string completion;
+	Assert::IsTrue(db.TopCompletion("blu", completion, std::chrono::microseconds(10000)));
+	Assert::AreEqual(std::string("blush"), completion);
+	Assert::IsTrue(db.TopCompletion("blue", completion, std::chrono::microseconds(10000)));
+	Assert::AreEqual(std::string("blue eyes"), completion);
+
+	// 完全一致は補完するものがないので除く
+	Assert::IsFalse(db.TopCompletion("blue eyes", completion, std::chrono::microseconds(10000)));
+	Assert::IsTrue(completion.empty());
+}
+
+void BooruDBTest::TestTopCompletionEmpty() {
+	BooruDB& db = BooruDB::GetInstance();
+	std::string completion = "dummy";
+	Assert::IsFalse(db.TopCompletion("", completion, std::chrono::microseconds(10000)));
+	Assert::IsTrue(completion.empty());
+}
+
+void BooruDBTest::TestTopCompletionNoMatch() {
+	BooruDB& db = BooruDB::GetInstance();
+	std::string completion;
+	Assert::IsFalse(db.TopCompletion("xyz123_unknown", completion, std::chrono::microseconds(10000)));
+	Assert::IsTrue(completion.empty());
+}
+
+void BooruDBTest::TestTopCompletionLatency() {
+	// 実際の辞書と同程度の件数でも、入力中の1文字ずつの補完が1フレーム（16ms）に収まる
+	BooruDB& db = BooruDB::GetInstance();
+	BooruDBTestHelper::SetupLargeTestData(db);
+	LatencyHistogram histogram;
+	const std::string words[] = { "blue hair", "long hair", "smile", "1girl", "school uniform", "looking at viewer" };
+	for (int round = 0; round < 10; ++round) {
+		for (const auto& word : words) {
+			for (size_t length = 1; length <= word.size(); ++length) {
+				std::string completion;
+				auto started = std::chrono::steady_clock::now();
+				db.TopCompletion(word.substr(0, length), completion, std::chrono::microseconds(2000));
+				histogram.Record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started));
+				if (length < word.size()) Assert::IsFalse(completion.empty());
+			}
+		}
+	}
+	Assert::IsTrue(histogram.Percentile(99) < std::chrono::milliseconds(16));
+}
+
+void BooruDBTest::TestLikelyContinuations() {
+	// 入力に1文字を加えたもので、重複しない
+	BooruDB& db = BooruDB::GetInstance();
+	auto continuations = db.LikelyContinuations("blu", 3);
+	std::unordered_set<std::string> seen;
+	for (const auto& continuation : continuations) {
+		Assert::AreEqual(static_cast<size_t>(4), continuation.size());
+		Assert::AreEqual(0, continuation.compare(0, 3, "blu"));
+		Assert::IsTrue(seen.insert(continuation).second);
+	}
+	// テスト用の辞書で blu で始まるタグは blue eyes、blue hair、blue sky、blush なので、blue が最も多く、次が blus
+	Assert::AreEqual(static_cast<size_t>(2), continuations.size());
+	Assert::AreEqual(std::string("blue"), continuations[0]);
+	Assert::AreEqual(std::string("blus"), continuations[1]);
+}
+
+void BooruDBTest::TestLikelyContinuationsNoPrefixMatch() {
+	// 前方一致するタグがなくても、辞書全体の文字の出現頻度から見込む
+	BooruDB& db = BooruDB::GetInstance();
+	auto continuations = db.LikelyContinuations("xyz123_unknown", 2);
+	Assert::AreEqual(static_cast<size_t>(2), continuations.size());
+	Assert::AreNotEqual(continuations[0], continuations[1]);
+	for (const auto& continuation : continuations) {
+		Assert::AreEqual(0, continuation.compare(0, 14, "xyz123_unknown"));
+		Assert::AreEqual(static_cast<size_t>(15), continuation.size());
+	}
+	Assert::IsTrue(db.LikelyContinuations("", 2).empty());
+}
+
+void BooruDBTest::TestVersionChangesOnPublish() {
+	// 重みを設定し直すとスナップショットが差し替わり、版が進む
+	BooruDB& db = BooruDB::GetInstance();
+	auto before = db.Version();
+	db.SetRankingWeights(db.GetRankingWeights());
+	Assert::IsTrue(db.Version() > before);
+}
+
+void BooruDBTest::TestHandleSuggestion() {
+	// ハンドルからタグ名を引け、スコアの高い順に並ぶ
+	BooruDB& db = BooruDB::GetInstance();
+	TagHandleList handles;
+	db.QuickSuggestion(handles, "blue", 5);
+	Assert::AreEqual(static_cast<size_t>(3), handles.size());
+	for (size_t i = 0; i < handles.size(); ++i) {
+		Assert::IsTrue(db.GetTagName(handles[i]).starts_with("blue"));
+		if (i > 0) Assert::IsTrue(handles[i - 1].score >= handles[i].score);
+	}
+	Assert::AreEqual(std::string("blue eyes"), db.GetTagName(handles[0]));
+	Assert::AreEqual(std::wstring(L"青い目"), db.GetDescription(db.GetTagName(handles[0])));
+}
+
+void BooruDBTest::TestHandleMatchesTagList() {
+	// TagList を返す版はハンドルの版と同じ順に同じタグを返す
+	BooruDB& db = BooruDB::GetInstance();
+	TagHandleList handles;
+	TagList suggestions;
+	db.FuzzySuggestion(handles, "blue", 10);
+	db.FuzzySuggestion(suggestions, "blue", 10);
+	Assert::IsFalse(handles.empty());
+	Assert::AreEqual(handles.size(), suggestions.size());
+	for (size_t i = 0; i < handles.size(); ++i) {
+		auto tag = db.MakeSuggestion(handles[i]);
+		Assert::AreEqual(suggestions[i].tag, tag.tag);
+		Assert::IsTrue(suggestions[i].description == tag.description);
+		Assert::AreEqual(suggestions[i].category, db.GetTagCategory(handles[i]));
+	}
+}
+
+void BooruDBTest::TestHandleOutOfRange() {
+	// 範囲外のハンドルは空のタグになる
+	BooruDB& db = BooruDB::GetInstance();
+	TagHandle handle{ UINT32_MAX, 0.0f, SuggestionStage::Prefix };
+	Assert::IsTrue(db.GetTagName(handle).empty());
+	Assert::IsTrue(db.MakeSuggestion(handle).tag.empty());
+}
+
+void BooruDBTest::TestQueryArenaSteadyState() {
+	// 同じ規模の前方一致検索と曖昧検索を繰り返すと、検索の中ではヒープから確保しなくなり、作業領域は検索の後に空に戻る
+	// 作業領域の拡張だけでなく、置き換えた operator new で作業領域の外の確保も数える
+	BooruDB& db = BooruDB::GetInstance();
+	auto& arena = QueryArena::ForThread();
+	TagHandleList handles;
+	handles.reserve(64);
+	auto search = [&](const std::string& input) {
+		handles.clear();
+		db.QuickSuggestion(handles, input, 8);
+		db.FuzzySuggestion(handles, input, 32);
+		return handles.size();
+	};
+	Assert::IsTrue(search("blue hair") > 0);
+	Assert::IsTrue(search("char:hatsune") > 0);
+	search("long hair");
+	auto allocations = BooruDBTestHelper::HeapAllocations();
+	auto arenaAllocations = arena.HeapAllocations();
+	for (int i = 0; i < 10; ++i) {
+		search(i % 2 ? "blue hair" : "long hair");
+		search("char:hatsune");
+	}
+	Assert::AreEqual(static_cast<unsigned long long>(allocations), static_cast<unsigned long long>(BooruDBTestHelper::HeapAllocations()));
+	Assert::AreEqual(static_cast<unsigned long long>(arenaAllocations), static_cast<unsigned long long>(arena.HeapAllocations()));
+	Assert::AreEqual(static_cast<size_t>(0), arena.Used());
+}
+
+void BooruDBTest::TestDescriptionSearchSteadyState() {
+	// 逆引き・ローマ字の逆引き・混在入力の検索も、同じ規模の検索を繰り返すとヒープから確保しなくなる
+	// 混在入力の2つ目以降の連続はスレッドプールで検索するので、呼び出し元のスレッドの確保を数える
+	BooruDB& db = BooruDB::GetInstance();
+	auto& arena = QueryArena::ForThread();
+	TagHandleList handles;
+	handles.reserve(64);
+	// 入力の文字列は検索の外で作っておく（長い文字列の作成もヒープから確保する）
+	const std::string reverse = "青い髪", uniform = "学校制服", romaji = "seeraa", mixed = "blue 制服 hair 猫耳";
+	auto search = [&]() {
+		handles.clear();
+		db.ReverseSuggestion(handles, reverse, 8);
+		db.ReverseSuggestion(handles, uniform, 8);
+		db.RomajiSuggestion(handles, romaji, 8);
+		db.MixedSuggestion(handles, mixed, 8);
+		return handles.size();
+	};
+	Assert::IsTrue(search() > 0);
+	search();
+	auto allocations = BooruDBTestHelper::HeapAllocations();
+	auto arenaAllocations = arena.HeapAllocations();
+	for (int i = 0; i < 10; ++i) {
+		search();
+	}
+	Assert::AreEqual(static_cast<unsigned long long>(allocations), static_cast<unsigned long long>(BooruDBTestHelper::HeapAllocations()));
+	Assert::AreEqual(static_cast<unsigned long long>(arenaAllocations), static_cast<unsigned long long>(arena.HeapAllocations()));
+	Assert::AreEqual(static_cast<size_t>(0), arena.Used());
+}
+
+void BooruDBTest::TestParseCategoryFilter() {
+	// 接頭辞が取り除かれ、対応するカテゴリーが返る
+	std::string input = "char:miku";
+	Assert::AreEqual(4, BooruDB::ParseCategoryFilter(input));
+	Assert::AreEqual("miku", input.c_str());
+
+	input = "artist: wlop";
+	Assert::AreEqual(1, BooruDB::ParseCategoryFilter(input));
+	Assert::AreEqual("wlop", input.c_str());
+
+	input = "copy:touhou";
+	Assert::AreEqual(3, BooruDB::ParseCategoryFilter(input));
+	Assert::AreEqual("touhou", input.c_str());
+
+	input = "meta:";
+	Assert::AreEqual(5, BooruDB::ParseCategoryFilter(input));
+	Assert::AreEqual("", input.c_str());
+}
+
+void BooruDBTest::TestParseCategoryFilterNone() {
+	// 接頭辞が無い場合は入力を変更しない
+	std::string input = "blue hair";
+	Assert::AreEqual(-1, BooruDB::ParseCategoryFilter(input));
+	Assert::AreEqual("blue hair", input.c_str());
+
+	// 未知の接頭辞（rating: など）はタグの一部として扱う
+	input = "rating:safe";
+	Assert::AreEqual(-1, BooruDB::ParseCategoryFilter(input));
+	Assert::AreEqual("rating:safe", input.c_str());
+}
+
+void BooruDBTest::TestQuickSuggestionWithCategoryFilter() {
+	// カテゴリー指定時は指定したカテゴリーのタグだけが返る
+	BooruDB& db = BooruDB::GetInstance();
+	TagList suggestions;
+	db.QuickSuggestion(suggestions, "char:", 5);
+
+	Assert::IsTrue(suggestions.size() <= 5);
+	for (const auto& suggestion : suggestions) {
+		Assert::AreEqual(4, suggestion.category);
+	}
+}
+
+void BooruDBTest::TestCancel() {
+	// 中断されたトークンを渡した検索は false を返す
+	BooruDB& db = BooruDB::GetInstance();
+	CancellationToken cancel;
+	cancel.Cancel();
+	TagList suggestions;
+	Assert::IsFalse(db.QuickSuggestion(suggestions, "blue", 5, cancel));
+	Assert::IsFalse(db.FuzzySuggestion(suggestions, "blu", 5, cancel));
+
+	// ほかのトークンを渡した検索には影響しない（テスト用の辞書には blue で始まるタグが3つある）
+	suggestions.clear();
+	Assert::IsTrue(db.QuickSuggestion(suggestions, "blue", 5));
+	Assert::AreEqual(static_cast<size_t>(3), suggestions.size());
+	Assert::AreEqual(std::string("blue eyes"), suggestions[0].tag);
 }
 
 void BooruDBTest::TestSingletonInstance() {
@@ -2,6 +2,9 @@
 
 #include "CppUnitTest.h"
 #include "../src/BooruDB.h"
+#include "../src/QueryArena.h"
+#include "../src/LatencyHistogram.h"
+#include "BooruDBTestHelper.h"
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -26,18 +29,69 @@ public:
 	TEST_METHOD(TestQuickSuggestionEmpty);
 	TEST_METHOD(TestQuickSuggestionNoMatch);
 	TEST_METHOD(TestQuickSuggestionMaxLimit);
+	TEST_METHOD(TestQuickSuggestionPrefixOnly);
+
+	// 完全一致サジェストのテスト
+	TEST_METHOD(TestExactSuggestion);
+	TEST_METHOD(TestExactSuggestionCategory);
+
+	// 別名サジェストのテスト
+	TEST_METHOD(TestAliasSuggestion);
+	TEST_METHOD(TestAliasSuggestionExcludesShown);
 
 	// 曖昧検索サジェストのテスト
 	TEST_METHOD(TestFuzzySuggestion);
 	TEST_METHOD(TestFuzzySuggestionEmpty);
 	TEST_METHOD(TestFuzzySuggestionNoMatch);
 	TEST_METHOD(TestFuzzySuggestionMaxLimit);
+	TEST_METHOD(TestFuzzySuggestionWithBudget);
+	TEST_METHOD(TestFuzzySuggestionZeroBudget);
+	TEST_METHOD(TestFuzzySuggestionResume);
+	TEST_METHOD(TestFuzzySuggestionAfterQuick);
 
 	// 逆引きサジェストのテスト
 	TEST_METHOD(TestReverseSuggestion);
 	TEST_METHOD(TestReverseSuggestionEmpty);
 	TEST_METHOD(TestReverseSuggestionNoMatch);
 	TEST_METHOD(TestReverseSuggestionMaxLimit);
+	TEST_METHOD(TestReverseSuggestionSingleChar);
+
+	// 英語と日本語が混在した入力のサジェストのテスト
+	TEST_METHOD(TestMixedSuggestionEmpty);
+	TEST_METHOD(TestMixedSuggestionMaxLimit);
+
+	// ローマ字の逆引きサジェストのテスト
+	TEST_METHOD(TestRomajiSuggestionShortInput);
+	TEST_METHOD(TestRomajiSuggestionMultibyte);
+	TEST_METHOD(TestRomajiSuggestionMaxLimit);
+
+	// 投稿数取得のテスト
+	TEST_METHOD(TestGetTagPostCountUnknown);
+
+	// インライン補完のテスト
+	TEST_METHOD(TestTopCompletion);
+	TEST_METHOD(TestTopCompletionEmpty);
+	TEST_METHOD(TestTopCompletionNoMatch);
+	TEST_METHOD(TestTopCompletionLatency);
+
+	// 先読みのテスト
+	TEST_METHOD(TestLikelyContinuations);
+	TEST_METHOD(TestLikelyContinuationsNoPrefixMatch);
+	TEST_METHOD(TestVersionChangesOnPublish);
+
+	// ハンドルで返すサジェストのテスト
+	TEST_METHOD(TestHandleSuggestion);
+	TEST_METHOD(TestHandleMatchesTagList);
+	TEST_METHOD(TestHandleOutOfRange);
+
+	// 作業領域のテスト
+	TEST_METHOD(TestQueryArenaSteadyState);
+	TEST_METHOD(TestDescriptionSearchSteadyState);
+
+	// カテゴリー指定のテスト
+	TEST_METHOD(TestParseCategoryFilter);
+	TEST_METHOD(TestParseCategoryFilterNone);
+	TEST_METHOD(TestQuickSuggestionWithCategoryFilter);
 
 	// キャンセル機能のテスト
 	TEST_METHOD(TestCancel);
@@ -0,0 +1,113 @@
+﻿#include "pch.h"
+#include "BooruDBTestHelper.h"
+#include <cstdlib>
+#include <new>
+#include <random>
+
+// 確保の回数を数える operator new
+// 配列版や nothrow 版は既定の実装がこれを呼ぶ
+static thread_local uint64_t heapAllocations = 0;
+
+void* operator new(size_t size) {
+	++heapAllocations;
+	if (void* p = std::malloc(size ? size : 1)) return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+	std::free(p);
+}
+
+namespace BooruDBTest {
+uint64_t BooruDBTestHelper::HeapAllocations() {
+	return heapAllocations;
+}
+
+// テスト用のタグを追加（投稿数の多い順）
+void BooruDBTestHelper::AddTestTags(BooruDB::Tables& tables) {
+	struct TestTag {
+		const char* tag;
+		int category;
+		int postCount;
+		const wchar_t* description;
+		const char* aliases; // danbooru.csv の別名の列
+	};
+	static const TestTag testTags[] = {
+		{ "1girl", 0, 5200000, L"女の子1人", "\"1girls,sole_female\"" },
+		{ "solo", 0, 4300000, L"1人" },
+		{ "long hair", 0, 3500000, L"ロングヘア", "longhair" },
+		{ "highres", 5, 3000000, L"高解像度", "\"high_res,high_resolution,hires\"" },
+		{ "smile", 0, 2800000, L"笑顔" },
+		{ "looking at viewer", 0, 2500000, L"こちらを見ている" },
+		{ "blush", 0, 2300000, L"赤面" },
+		{ "blue eyes", 0, 1300000, L"青い目" },
+		{ "blonde hair", 0, 1200000, L"金髪" },
+		{ "touhou", 3, 900000, L"東方Project" },
+		{ "blue hair", 0, 700000, L"青い髪" },
+		{ "school uniform", 0, 650000, L"制服" },
+		{ "cat ears", 0, 300000, L"猫耳 ネコミミ", "\"nekomimi,cat_ear\"" },
+		{ "serafuku", 0, 250000, L"セーラー服" },
+		{ "vocaloid", 3, 200000, L"ボーカロイド" },
+		{ "blue sky", 0, 180000, L"青空" },
+		{ "hatsune miku", 4, 150000, L"初音ミク" },
+		{ "hakurei reimu", 4, 90000, L"博麗霊夢" },
+		{ "yes", 0, 60000, L"はい" },
+		{ "wlop", 1, 1000, L"WLOP" },
+		{ "hyrule castle", 0, 10, L"ハイラル城" },
+	};
+	for (const auto& testTag : testTags) {
+		tables.dictionary.push_back(testTag.tag);
+		tables.category[testTag.tag] = testTag.category;
+		tables.post_count[testTag.tag] = testTag.postCount;
+		tables.AddDescription(testTag.tag, testTag.description, DescriptionTier::Curated);
+		if (testTag.aliases) {
+			tables.AddAliases(tables.dictionary.size() - 1, testTag.aliases);
+		}
+	}
+}
+
+void BooruDBTestHelper::SetupTestData(BooruDB& db) {
+	// フレンドクラスとしてprivateメンバーにアクセス可能
+	auto tables = std::make_shared<BooruDB::Tables>();
+	AddTestTags(*tables);
+
+	// 検索用の索引を構築して差し替え
+	tables->BuildIndex();
+	db.Publish(std::move(tables));
+}
+
+void BooruDBTestHelper::SetupLargeTestData(BooruDB& db, size_t count) {
+	auto tables = std::make_shared<BooruDB::Tables>();
+	AddTestTags(*tables);
+
+	// 音節をつないだ1～3語の架空のタグ（毎回同じ辞書になるよう乱数の種を固定する）
+	// 投稿数は実際の辞書と同じように順位に反比例させる
+	static const char* syllables[] = {
+		"a", "ka", "sa", "ta", "na", "ha", "ma", "ra", "ko", "to", "no", "ri", "shi", "chi",
+		"bl", "gr", "st", "tr", "ing", "er", "ed", "es", "on", "or", "an", "en", "ue", "oo",
+	};
+	std::mt19937 random(12345);
+	std::uniform_int_distribution<size_t> syllable(0, std::size(syllables) - 1);
+	std::uniform_int_distribution<int> length(2, 4);
+	std::uniform_int_distribution<int> words(1, 3);
+	while (tables->dictionary.size() < count) {
+		std::string tag;
+		for (int word = words(random); word > 0; --word) {
+			if (!tag.empty()) tag += ' ';
+			for (int i = length(random); i > 0; --i) {
+				tag += syllables[syllable(random)];
+			}
+		}
+		if (!tables->category.emplace(tag, 0).second) continue;
+		tables->dictionary.push_back(tag);
+		tables->post_count[tag] = static_cast<int>(100000 / tables->dictionary.size());
+	}
+
+	tables->BuildIndex();
+	db.Publish(std::move(tables));
+}
+}
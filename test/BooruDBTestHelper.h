@@ -0,0 +1,27 @@
+﻿#pragma once
+
+#include "../src/BooruDB.h"
+
+namespace BooruDBTest {
+// BooruDBのテスト用ヘルパークラス
+// テスト環境には辞書ファイルが無いので、テスト用の辞書を組み立てて差し替える
+class BooruDBTestHelper {
+public:
+	// 実際の辞書と同程度の件数（性能のテスト用）
+	static constexpr size_t LARGE_DICTIONARY_SIZE = 150000;
+
+	// 投稿数と説明文の付いた少数のタグ
+	static void SetupTestData(BooruDB& db);
+
+	// SetupTestData のタグに架空のタグを加えて count 件にする
+	// 架空のタグは SetupTestData のタグより投稿数が少ないので、SetupTestData のタグの順位は変わらない
+	static void SetupLargeTestData(BooruDB& db, size_t count = LARGE_DICTIONARY_SIZE);
+
+	// このスレッドでグローバルな operator new を呼んだ回数
+	// テストのモジュールでは operator new を置き換えて数える（作業領域の外の確保も数えられる）
+	static uint64_t HeapAllocations();
+
+private:
+	static void AddTestTags(BooruDB::Tables& tables);
+};
+}
@@ -0,0 +1,49 @@
+﻿#include "pch.h"
+#include "CancellationTokenTest.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace CancellationTokenTest {
+using Clock = CancellationToken::Clock;
+
+void CancellationTokenTest::TestDefault() {
+	CancellationToken cancel;
+	Assert::IsFalse(cancel.Cancelled());
+}
+
+void CancellationTokenTest::TestCancel() {
+	CancellationToken cancel;
+	cancel.Cancel();
+	Assert::IsTrue(cancel.Cancelled());
+
+	// ほかのトークンには影響しない
+	CancellationToken other;
+	Assert::IsFalse(other.Cancelled());
+}
+
+void CancellationTokenTest::TestNone() {
+	Assert::IsFalse(CancellationToken::None().Cancelled());
+}
+
+void CancellationTokenTest::TestDeadline() {
+	CancellationToken past(Clock::now() - std::chrono::milliseconds(1));
+	Assert::IsTrue(past.Cancelled());
+
+	CancellationToken future(Clock::now() + std::chrono::hours(1));
+	Assert::IsFalse(future.Cancelled());
+}
+
+void CancellationTokenTest::TestGeneration() {
+	std::atomic<uint64_t> generation{ 1 };
+	CancellationToken cancel(generation, 1);
+	Assert::IsFalse(cancel.Cancelled());
+
+	// 世代が進んだら中断
+	++generation;
+	Assert::IsTrue(cancel.Cancelled());
+
+	// 新しい世代のトークンは中断されていない
+	CancellationToken next(generation, 2);
+	Assert::IsFalse(next.Cancelled());
+}
+}
@@ -0,0 +1,22 @@
+﻿#pragma once
+
+#include "CppUnitTest.h"
+#include "../src/CancellationToken.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace CancellationTokenTest {
+TEST_CLASS(CancellationTokenTest) {
+public:
+	// 中断の指示のテスト
+	TEST_METHOD(TestDefault);
+	TEST_METHOD(TestCancel);
+	TEST_METHOD(TestNone);
+
+	// 期限のテスト
+	TEST_METHOD(TestDeadline);
+
+	// 世代の監視のテスト
+	TEST_METHOD(TestGeneration);
+};
+}
@@ -0,0 +1,74 @@
+﻿#include "pch.h"
+#include "DescriptionIndexTest.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace DescriptionIndexTest {
+// テスト用の索引（タグのインデックスごとにまとめて追加）
+static void MakeIndex(DescriptionIndex& index) {
+	index.Add(0, L"青髪", DescriptionTier::Curated);          // 0
+	index.Add(1, L"制服", DescriptionTier::Curated);          // 1
+	index.Add(1, L"学校の制服", DescriptionTier::Machine);    // 2
+	index.Add(2, L"セーラー服", DescriptionTier::MachineOnly); // 3
+	index.Build();
+}
+
+void DescriptionIndexTest::TestAdd() {
+	DescriptionIndex index(1, 2);
+	MakeIndex(index);
+	Assert::AreEqual(static_cast<size_t>(4), index.Size());
+	Assert::AreEqual(L"学校の制服", std::wstring(index.Text(2)).c_str());
+	Assert::AreEqual(static_cast<size_t>(1), index.GetDoc(2).tag);
+	Assert::IsTrue(index.GetDoc(3).tier == DescriptionTier::MachineOnly);
+}
+
+void DescriptionIndexTest::TestAddDuplicate() {
+	DescriptionIndex index(1, 2);
+	Assert::IsTrue(index.Add(0, L"制服", DescriptionTier::Curated));
+	// 同じタグの同じ説明文と空文字列は追加しない
+	Assert::IsFalse(index.Add(0, L"制服", DescriptionTier::Machine));
+	Assert::IsFalse(index.Add(0, L"", DescriptionTier::Machine));
+	// 別のタグなら追加する
+	Assert::IsTrue(index.Add(1, L"制服", DescriptionTier::Machine));
+	Assert::AreEqual(static_cast<size_t>(2), index.Size());
+}
+
+void DescriptionIndexTest::TestClear() {
+	DescriptionIndex index(1, 2);
+	MakeIndex(index);
+	index.Clear();
+	Assert::AreEqual(static_cast<size_t>(0), index.Size());
+	Assert::IsTrue(index.FindContaining(L"制服").empty());
+}
+
+void DescriptionIndexTest::TestFindContaining() {
+	DescriptionIndex index(1, 2);
+	MakeIndex(index);
+	auto result = index.FindContaining(L"制服");
+	Assert::AreEqual(static_cast<size_t>(2), result.size());
+	Assert::AreEqual(static_cast<uint32_t>(1), result[0]);
+	Assert::AreEqual(static_cast<uint32_t>(2), result[1]);
+
+	// 末尾の文書も引ける
+	result = index.FindContaining(L"服");
+	Assert::AreEqual(static_cast<size_t>(3), result.size());
+	Assert::AreEqual(static_cast<uint32_t>(3), result[2]);
+}
+
+void DescriptionIndexTest::TestFindContainingNoMatch() {
+	DescriptionIndex index(1, 2);
+	MakeIndex(index);
+	Assert::IsTrue(index.FindContaining(L"猫耳").empty());
+	// 文書をまたいだ一致はしない
+	Assert::IsTrue(index.FindContaining(L"髪制").empty());
+}
+
+void DescriptionIndexTest::TestFindSimilar() {
+	DescriptionIndex index(1, 2);
+	MakeIndex(index);
+	// 1文字の n-gram を6割以上共有する文書
+	auto result = index.FindSimilar(L"青い髪", 0.6, 1);
+	Assert::AreEqual(static_cast<size_t>(1), result.size());
+	Assert::AreEqual(static_cast<uint32_t>(0), result[0]);
+}
+}
@@ -0,0 +1,21 @@
+﻿#pragma once
+
+#include "CppUnitTest.h"
+#include "../src/DescriptionIndex.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace DescriptionIndexTest {
+TEST_CLASS(DescriptionIndexTest) {
+public:
+	// 追加のテスト
+	TEST_METHOD(TestAdd);
+	TEST_METHOD(TestAddDuplicate);
+	TEST_METHOD(TestClear);
+
+	// 検索のテスト
+	TEST_METHOD(TestFindContaining);
+	TEST_METHOD(TestFindContainingNoMatch);
+	TEST_METHOD(TestFindSimilar);
+};
+}
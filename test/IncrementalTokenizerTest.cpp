@@ -0,0 +1,132 @@
+﻿#include "pch.h"
+#include <algorithm>
+#include <random>
+#include "IncrementalTokenizerTest.h"
+#include "../src/TextUtils.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace IncrementalTokenizerTest {
+// 全体を解析し直した結果と同じか
+static void AssertSameAsFullParse(const IncrementalTokenizer& tokenizer) {
+	auto expected = extract_tags_from_text(tokenizer.Text());
+	const auto& actual = tokenizer.Tags();
+	Assert::AreEqual(expected.size(), actual.size());
+	for (size_t i = 0; i < expected.size(); ++i) {
+		Assert::AreEqual(expected[i].tag, actual[i].tag);
+		Assert::AreEqual(expected[i].start, actual[i].start);
+		Assert::AreEqual(expected[i].end, actual[i].end);
+	}
+}
+
+void IncrementalTokenizerTest::TestReset() {
+	IncrementalTokenizer tokenizer;
+	tokenizer.Reset("1girl, (blue hair:1.2), smile\nsolo");
+	Assert::AreEqual(std::string("1girl, (blue hair:1.2), smile\nsolo"), tokenizer.Text());
+	AssertSameAsFullParse(tokenizer);
+}
+
+void IncrementalTokenizerTest::TestInsertTag() {
+	IncrementalTokenizer tokenizer;
+	tokenizer.Reset("1girl, smile, solo");
+	tokenizer.Edit(7, 0, "blue hair, ");
+	Assert::AreEqual(std::string("1girl, blue hair, smile, solo"), tokenizer.Text());
+	AssertSameAsFullParse(tokenizer);
+	Assert::AreEqual(std::string("blue hair"), tokenizer.Tags()[1].tag);
+	Assert::AreEqual(static_cast<size_t>(18), tokenizer.Tags()[2].start);
+}
+
+void IncrementalTokenizerTest::TestDeleteComma() {
+	// 区切りを消すと前後のタグが1つになる
+	IncrementalTokenizer tokenizer;
+	tokenizer.Reset("1girl, blue, hair, solo");
+	tokenizer.Edit(11, 1, "");
+	AssertSameAsFullParse(tokenizer);
+	Assert::AreEqual(std::string("blue hair"), tokenizer.Tags()[1].tag);
+}
+
+void IncrementalTokenizerTest::TestOpenBracket() {
+	// 開き括弧を入れると、閉じ括弧まで括弧の中として解析し直す
+	IncrementalTokenizer tokenizer;
+	tokenizer.Reset("a, b, c:1.2), d, e");
+	tokenizer.Edit(3, 0, "(");
+	AssertSameAsFullParse(tokenizer);
+	tokenizer.Edit(3, 1, "");
+	AssertSameAsFullParse(tokenizer);
+}
+
+void IncrementalTokenizerTest::TestEscape() {
+	// エスケープした括弧やカンマは区切りにならない
+	IncrementalTokenizer tokenizer;
+	tokenizer.Reset("a, b, c, d");
+	tokenizer.Edit(4, 0, "\\");
+	AssertSameAsFullParse(tokenizer);
+	tokenizer.Edit(4, 1, "");
+	AssertSameAsFullParse(tokenizer);
+	tokenizer.Edit(10, 0, "\\");
+	AssertSameAsFullParse(tokenizer);
+	tokenizer.Edit(11, 0, "x");
+	AssertSameAsFullParse(tokenizer);
+}
+
+void IncrementalTokenizerTest::TestRandomEdits() {
+	// 区切りや括弧、エスケープを含む文字でランダムに編集し、毎回全体の解析と比べる
+	static const char ALPHABET[] = "ab ,\n()\\:1";
+	std::mt19937 random(12345);
+	IncrementalTokenizer tokenizer;
+	tokenizer.Reset("1girl, (blue hair:1.2), smile\n(a, b), c\\, d");
+	for (int i = 0; i < 2000; ++i) {
+		auto size = tokenizer.Text().size();
+		size_t position = std::uniform_int_distribution<size_t>(0, size)(random);
+		size_t deleted = std::uniform_int_distribution<size_t>(0, std::min<size_t>(3, size - position))(random);
+		std::string inserted;
+		size_t count = std::uniform_int_distribution<size_t>(0, 3)(random);
+		for (size_t j = 0; j < count; ++j) {
+			inserted += ALPHABET[std::uniform_int_distribution<size_t>(0, sizeof(ALPHABET) - 2)(random)];
+		}
+		tokenizer.Edit(position, deleted, inserted);
+		AssertSameAsFullParse(tokenizer);
+	}
+}
+
+void IncrementalTokenizerTest::TestUpdate() {
+	IncrementalTokenizer tokenizer;
+	tokenizer.Reset("1girl, smile, solo");
+	Assert::IsTrue(tokenizer.Update("1girl, smiles, solo"));
+	AssertSameAsFullParse(tokenizer);
+	Assert::AreEqual(std::string("smiles"), tokenizer.Tags()[1].tag);
+	Assert::IsTrue(tokenizer.Update("1girl"));
+	AssertSameAsFullParse(tokenizer);
+	Assert::IsTrue(tokenizer.Update(""));
+	Assert::IsTrue(tokenizer.Tags().empty());
+}
+
+void IncrementalTokenizerTest::TestUpdateUnchanged() {
+	IncrementalTokenizer tokenizer;
+	tokenizer.Reset("1girl, smile");
+	Assert::IsFalse(tokenizer.Update("1girl, smile"));
+	Assert::AreEqual(static_cast<size_t>(0), tokenizer.LastRelexedLength());
+}
+
+void IncrementalTokenizerTest::TestRelexedLengthIndependentOfPromptLength() {
+	// 1万タグのプロンプトでも、中ほどのタグへの1文字の入力で読み直すのはそのタグの周辺だけ
+	std::string prompt;
+	for (int i = 0; i < 10000; ++i) {
+		if (i) prompt += ", ";
+		prompt += i % 100 == 0 ? "(tag" + std::to_string(i) + ":1.1)" : "tag" + std::to_string(i);
+	}
+	IncrementalTokenizer tokenizer;
+	tokenizer.Reset(prompt);
+	auto position = prompt.find("tag5001") + 3;
+	tokenizer.Edit(position, 0, "x");
+	Assert::IsTrue(tokenizer.LastRelexedLength() < 32);
+	const auto& tags = tokenizer.Tags();
+	Assert::IsTrue(std::any_of(tags.begin(), tags.end(), [](const Tag& tag) { return tag.tag == "tagx5001"; }));
+	AssertSameAsFullParse(tokenizer);
+
+	// 区切りを入れても同じ
+	tokenizer.Edit(position, 0, ", ");
+	Assert::IsTrue(tokenizer.LastRelexedLength() < 32);
+	AssertSameAsFullParse(tokenizer);
+}
+}
@@ -0,0 +1,26 @@
+﻿#pragma once
+
+#include "CppUnitTest.h"
+#include "../src/IncrementalTokenizer.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace IncrementalTokenizerTest {
+TEST_CLASS(IncrementalTokenizerTest) {
+public:
+	// 全体の解析と同じ結果になるかのテスト
+	TEST_METHOD(TestReset);
+	TEST_METHOD(TestInsertTag);
+	TEST_METHOD(TestDeleteComma);
+	TEST_METHOD(TestOpenBracket);
+	TEST_METHOD(TestEscape);
+	TEST_METHOD(TestRandomEdits);
+
+	// 差分の反映のテスト
+	TEST_METHOD(TestUpdate);
+	TEST_METHOD(TestUpdateUnchanged);
+
+	// 解析し直す範囲のテスト
+	TEST_METHOD(TestRelexedLengthIndependentOfPromptLength);
+};
+}
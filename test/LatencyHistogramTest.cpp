@@ -0,0 +1,54 @@
+﻿#include "pch.h"
+#include "LatencyHistogramTest.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace LatencyHistogramTest {
+using std::chrono::microseconds;
+
+void LatencyHistogramTest::TestEmpty() {
+	LatencyHistogram histogram;
+	Assert::AreEqual(0ULL, static_cast<unsigned long long>(histogram.Count()));
+	Assert::AreEqual(0LL, static_cast<long long>(histogram.Percentile(99).count()));
+	Assert::AreEqual(0LL, static_cast<long long>(histogram.Max().count()));
+}
+
+void LatencyHistogramTest::TestPercentile() {
+	LatencyHistogram histogram;
+	// 99件は 100us、1件だけ 20ms
+	for (int i = 0; i < 99; ++i) {
+		histogram.Record(microseconds(100));
+	}
+	histogram.Record(microseconds(20000));
+	Assert::AreEqual(100ULL, static_cast<unsigned long long>(histogram.Count()));
+
+	// 100us は 64 以上 128 未満の区間に入るので、上端の 128us を返す
+	Assert::AreEqual(128LL, static_cast<long long>(histogram.Percentile(50).count()));
+	Assert::AreEqual(128LL, static_cast<long long>(histogram.Percentile(99).count()));
+	Assert::AreEqual(20000LL, static_cast<long long>(histogram.Percentile(100).count()));
+	Assert::AreEqual(20000LL, static_cast<long long>(histogram.Max().count()));
+}
+
+void LatencyHistogramTest::TestPercentileCappedByMax() {
+	LatencyHistogram histogram;
+	histogram.Record(microseconds(70));
+	// 区間の上端は 128us だが、実際の最大値を超えない
+	Assert::AreEqual(70LL, static_cast<long long>(histogram.Percentile(50).count()));
+}
+
+void LatencyHistogramTest::TestOverflowBucket() {
+	LatencyHistogram histogram;
+	// 最後の区間を超える値は最後の区間に入り、最大値を返す
+	histogram.Record(microseconds(int64_t(1) << 40));
+	Assert::AreEqual(1ULL, static_cast<unsigned long long>(histogram.Count()));
+	Assert::AreEqual(static_cast<long long>(int64_t(1) << 40), static_cast<long long>(histogram.Percentile(99).count()));
+}
+
+void LatencyHistogramTest::TestClear() {
+	LatencyHistogram histogram;
+	histogram.Record(microseconds(500));
+	histogram.Clear();
+	Assert::AreEqual(0ULL, static_cast<unsigned long long>(histogram.Count()));
+	Assert::AreEqual(0LL, static_cast<long long>(histogram.Max().count()));
+}
+}
@@ -0,0 +1,18 @@
+﻿#pragma once
+
+#include "CppUnitTest.h"
+#include "../src/LatencyHistogram.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace LatencyHistogramTest {
+TEST_CLASS(LatencyHistogramTest) {
+public:
+	// 記録と集計のテスト
+	TEST_METHOD(TestEmpty);
+	TEST_METHOD(TestPercentile);
+	TEST_METHOD(TestPercentileCappedByMax);
+	TEST_METHOD(TestOverflowBucket);
+	TEST_METHOD(TestClear);
+};
+}
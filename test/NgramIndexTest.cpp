@@ -0,0 +1,181 @@
+﻿#include "pch.h"
+#include "NgramIndexTest.h"
+#include <cmath>
+#include <random>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace NgramIndexTest {
+// テスト用の索引（追加順が文書ID）
+static NgramIndex MakeIndex() {
+	NgramIndex index(1, 2);
+	index.Add(L"青髪");         // 0
+	index.Add(L"セーラー服");   // 1
+	index.Add(L"制服");         // 2
+	index.Add(L"学校の制服");   // 3
+	index.Add(L"猫耳");         // 4
+	index.Add(L"金髪");         // 5
+	return index;
+}
+
+void NgramIndexTest::TestAdd() {
+	NgramIndex index(1, 2);
+	Assert::AreEqual(static_cast<uint32_t>(0), index.Add(L"制服"));
+	Assert::AreEqual(static_cast<uint32_t>(1), index.Add(L"猫耳"));
+	Assert::AreEqual(static_cast<size_t>(2), index.Size());
+}
+
+void NgramIndexTest::TestClear() {
+	auto index = MakeIndex();
+	index.Clear();
+	Assert::AreEqual(static_cast<size_t>(0), index.Size());
+	Assert::IsTrue(index.FindAll(L"制服").empty());
+}
+
+void NgramIndexTest::TestFindAll() {
+	auto index = MakeIndex();
+	auto result = index.FindAll(L"制服");
+	Assert::AreEqual(static_cast<size_t>(2), result.size());
+	Assert::AreEqual(static_cast<uint32_t>(2), result[0]);
+	Assert::AreEqual(static_cast<uint32_t>(3), result[1]);
+}
+
+void NgramIndexTest::TestFindAllSingleChar() {
+	// 1文字の検索語は1文字の n-gram で引く
+	auto index = MakeIndex();
+	auto result = index.FindAll(L"髪");
+	Assert::AreEqual(static_cast<size_t>(2), result.size());
+	Assert::AreEqual(static_cast<uint32_t>(0), result[0]);
+	Assert::AreEqual(static_cast<uint32_t>(5), result[1]);
+}
+
+void NgramIndexTest::TestFindAllNoMatch() {
+	auto index = MakeIndex();
+	Assert::IsTrue(index.FindAll(L"犬耳").empty());
+	Assert::IsTrue(index.FindAll(L"").empty());
+}
+
+void NgramIndexTest::TestFindAllOrder() {
+	// 結果は文書IDの昇順（追加順）
+	NgramIndex index(1, 2);
+	index.Add(L"白い制服");
+	index.Add(L"制服");
+	index.Add(L"黒い制服");
+	auto result = index.FindAll(L"制服");
+	Assert::AreEqual(static_cast<size_t>(3), result.size());
+	for (size_t i = 0; i < result.size(); ++i) {
+		Assert::AreEqual(static_cast<uint32_t>(i), result[i]);
+	}
+}
+
+void NgramIndexTest::TestFindSimilar() {
+	// 「学校制服」の文字を6割以上共有する文書
+	auto index = MakeIndex();
+	auto result = index.FindSimilar(L"学校制服", 0.6, 1);
+	Assert::AreEqual(static_cast<size_t>(2), result.size());
+	Assert::AreEqual(static_cast<uint32_t>(2), result[0]);
+	Assert::AreEqual(static_cast<uint32_t>(3), result[1]);
+}
+
+void NgramIndexTest::TestFindSimilarShortDocument() {
+	// 検索語より短い文書は文書側の n-gram の種類数を基準にする
+	auto index = MakeIndex();
+	auto result = index.FindSimilar(L"金髪ツインテール", 0.6, 1);
+	Assert::AreEqual(static_cast<size_t>(1), result.size());
+	Assert::AreEqual(static_cast<uint32_t>(5), result[0]);
+}
+
+void NgramIndexTest::TestFindSimilarEmpty() {
+	auto index = MakeIndex();
+	Assert::IsTrue(index.FindSimilar(L"", 0.6, 1).empty());
+	Assert::IsTrue(index.FindSimilar(L"犬", 0.6, 1).empty());
+}
+
+void NgramIndexTest::TestFindSimilarRepeated() {
+	// 作業用の配列を使い回しても、前の検索や別の索引の検索の結果が混ざらない
+	auto index = MakeIndex();
+	NgramIndex small(1, 2);
+	small.Add(L"制服");
+	for (int i = 0; i < 3; ++i) {
+		auto result = index.FindSimilar(L"学校制服", 0.6, 1);
+		Assert::AreEqual(static_cast<size_t>(2), result.size());
+		Assert::AreEqual(static_cast<uint32_t>(2), result[0]);
+		Assert::AreEqual(static_cast<uint32_t>(3), result[1]);
+
+		result = small.FindSimilar(L"学校制服", 0.6, 1);
+		Assert::AreEqual(static_cast<size_t>(1), result.size());
+		Assert::AreEqual(static_cast<uint32_t>(0), result[0]);
+
+		result = index.FindSimilar(L"金髪ツインテール", 0.6, 1);
+		Assert::AreEqual(static_cast<size_t>(1), result.size());
+		Assert::AreEqual(static_cast<uint32_t>(5), result[0]);
+	}
+}
+
+void NgramIndexTest::TestFindSimilarBigram() {
+	// 2文字の n-gram で引く
+	// 「学校の制服」は「学校制服」の3種類の2文字の n-gram のうち2種類（学校、制服）を共有する
+	auto index = MakeIndex();
+	auto result = index.FindSimilar(L"学校制服", 0.6, 2);
+	Assert::AreEqual(static_cast<size_t>(2), result.size());
+	Assert::AreEqual(static_cast<uint32_t>(2), result[0]);
+	Assert::AreEqual(static_cast<uint32_t>(3), result[1]);
+	Assert::IsTrue(index.FindSimilar(L"学校制服", 0.7, 2).size() == 1);
+}
+
+void NgramIndexTest::TestFindSimilarSingleCharFallback() {
+	// 1文字の検索語は1文字の n-gram で引く
+	auto index = MakeIndex();
+	auto result = index.FindSimilar(L"髪", 0.6, 2);
+	Assert::AreEqual(static_cast<size_t>(2), result.size());
+	Assert::AreEqual(static_cast<uint32_t>(0), result[0]);
+	Assert::AreEqual(static_cast<uint32_t>(5), result[1]);
+}
+
+void NgramIndexTest::TestFindSimilarMatchesScan() {
+	// 全ての文書を数えた結果と比べる
+	// 多くの文書に現れる文字（ー、ン）のリストは走査せず二分探索で数えるので、
+	// n-gram の種類が検索語以上の文書は一致し、それより少ない文書は余計に返さない
+	const std::wstring alphabet = L"ーンーンーンアイウ制服猫耳";
+	std::mt19937 random(12345);
+	auto make = [&](size_t length) {
+		std::wstring text;
+		for (size_t i = 0; i < length; ++i) text += alphabet[random() % alphabet.size()];
+		return text;
+	};
+	auto grams = [](std::wstring_view text) {
+		std::vector<std::wstring> result;
+		for (size_t i = 0; i + 2 <= text.size(); ++i) result.emplace_back(text.substr(i, 2));
+		std::sort(result.begin(), result.end());
+		result.erase(std::unique(result.begin(), result.end()), result.end());
+		return result;
+	};
+	NgramIndex index(1, 2);
+	std::vector<std::vector<std::wstring>> docs;
+	for (int i = 0; i < 5000; ++i) {
+		auto text = make(2 + random() % 8);
+		index.Add(text);
+		docs.push_back(grams(text));
+	}
+	for (int n = 0; n < 100; ++n) {
+		auto query = make(3 + random() % 6);
+		auto queryGrams = grams(query);
+		auto result = index.FindSimilar(query, 0.6, 2);
+		size_t total = queryGrams.size();
+		for (size_t id = 0; id < docs.size(); ++id) {
+			size_t shared = 0;
+			for (const auto& gram : queryGrams) {
+				if (std::binary_search(docs[id].begin(), docs[id].end(), gram)) ++shared;
+			}
+			auto base = std::min(total, docs[id].size());
+			bool expected = shared >= std::ceil(0.6 * static_cast<double>(base));
+			bool found = std::binary_search(result.begin(), result.end(), static_cast<uint32_t>(id));
+			if (docs[id].size() >= total) {
+				Assert::AreEqual(expected, found);
+			} else if (found) {
+				Assert::IsTrue(expected);
+			}
+		}
+	}
+}
+}
@@ -0,0 +1,30 @@
+﻿#pragma once
+
+#include "CppUnitTest.h"
+#include "../src/NgramIndex.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace NgramIndexTest {
+TEST_CLASS(NgramIndexTest) {
+public:
+	// 追加のテスト
+	TEST_METHOD(TestAdd);
+	TEST_METHOD(TestClear);
+
+	// 全 n-gram を含む文書の検索のテスト
+	TEST_METHOD(TestFindAll);
+	TEST_METHOD(TestFindAllSingleChar);
+	TEST_METHOD(TestFindAllNoMatch);
+	TEST_METHOD(TestFindAllOrder);
+
+	// 類似した文書の検索のテスト
+	TEST_METHOD(TestFindSimilar);
+	TEST_METHOD(TestFindSimilarShortDocument);
+	TEST_METHOD(TestFindSimilarEmpty);
+	TEST_METHOD(TestFindSimilarRepeated);
+	TEST_METHOD(TestFindSimilarBigram);
+	TEST_METHOD(TestFindSimilarSingleCharFallback);
+	TEST_METHOD(TestFindSimilarMatchesScan);
+};
+}
@@ -0,0 +1,92 @@
+﻿#include "pch.h"
+#include "PartialRatioTest.h"
+#include "../src/QueryArena.h"
+#include "rapidfuzz/fuzz.hpp"
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace PartialRatioTest {
+static const std::vector<std::wstring> texts = {
+	L"制服",
+	L"学校の制服",
+	L"セーラー服",
+	L"金髪ツインテール",
+	L"ツインテール",
+	L"猫耳 ネコミミ",
+	L"serafuku",
+	L"seeraa fuku",
+};
+
+void PartialRatioTest::TestSimilarityMatchesRapidfuzz() {
+	// 比較元が短い・長い・同じ長さのいずれでも rapidfuzz の partial_ratio と一致する
+	for (const auto& s1 : texts) {
+		CachedPartialRatioScorer scorer(s1);
+		for (const auto& s2 : texts) {
+			Assert::AreEqual(rapidfuzz::fuzz::partial_ratio(s1, s2), scorer.Similarity(s2));
+		}
+	}
+}
+
+void PartialRatioTest::TestSimilarityWithCutoff() {
+	for (const auto& s1 : texts) {
+		CachedPartialRatioScorer scorer(s1);
+		for (const auto& s2 : texts) {
+			for (double cutoff : { 50.0, 70.0, 85.0, 100.0, 101.0 }) {
+				Assert::AreEqual(rapidfuzz::fuzz::partial_ratio(s1, s2, cutoff), scorer.Similarity(s2, cutoff));
+			}
+		}
+	}
+}
+
+void PartialRatioTest::TestSimilarityEmpty() {
+	CachedPartialRatioScorer empty(L"");
+	Assert::AreEqual(100.0, empty.Similarity(L""));
+	Assert::AreEqual(0.0, empty.Similarity(L"制服"));
+	CachedPartialRatioScorer scorer(L"制服");
+	Assert::AreEqual(0.0, scorer.Similarity(L""));
+}
+
+void PartialRatioTest::TestSimilarityMatchesRapidfuzzRandom() {
+	// 乱数で作った文字列でも rapidfuzz の partial_ratio と一致する
+	// 少ない種類の文字で窓の枝刈りが効く組と、64文字を超える（複数ブロックの）文字列を含める
+	std::mt19937 random(12345);
+	const std::wstring alphabet = L"アイウエオンー制服ab ";
+	auto make = [&](size_t maxLength) {
+		std::wstring text;
+		size_t length = random() % (maxLength + 1);
+		for (size_t i = 0; i < length; ++i) text += alphabet[random() % alphabet.size()];
+		return text;
+	};
+	std::vector<std::wstring> targets;
+	for (int i = 0; i < 100; ++i) targets.push_back(make(i % 10 ? 16 : 150));
+	for (int n = 0; n < 50; ++n) {
+		auto query = make(n % 10 ? 12 : 100);
+		CachedPartialRatioScorer scorer(query);
+		for (double cutoff : { 0.0, 70.0 }) {
+			for (const auto& target : targets) {
+				Assert::AreEqual(rapidfuzz::fuzz::partial_ratio(query, target, cutoff), scorer.Similarity(target, cutoff));
+			}
+		}
+	}
+}
+
+void PartialRatioTest::TestSimilaritySteadyState() {
+	// 作業領域から確保し、同じ規模の比較を繰り返しても作業領域は拡張しない
+	QueryArena arena;
+	CachedPartialRatioScorer scorer(L"金髪ツインテール", &arena);
+	for (int i = 0; i < 2; ++i) {
+		// 探索する窓の配列は入れ替えながら使うので、2回で両方が必要な大きさになる
+		for (const auto& text : texts) scorer.Similarity(text);
+	}
+	auto allocations = arena.HeapAllocations();
+	auto used = arena.Used();
+	for (int i = 0; i < 10; ++i) {
+		for (const auto& text : texts) scorer.Similarity(text);
+	}
+	Assert::AreEqual(static_cast<unsigned long long>(allocations), static_cast<unsigned long long>(arena.HeapAllocations()));
+	Assert::AreEqual(used, arena.Used());
+}
+}
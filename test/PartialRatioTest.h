@@ -0,0 +1,20 @@
+﻿#pragma once
+
+#include "CppUnitTest.h"
+#include "../src/PartialRatio.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace PartialRatioTest {
+TEST_CLASS(PartialRatioTest) {
+public:
+	// 類似度のテスト
+	TEST_METHOD(TestSimilarityMatchesRapidfuzz);
+	TEST_METHOD(TestSimilarityWithCutoff);
+	TEST_METHOD(TestSimilarityEmpty);
+	TEST_METHOD(TestSimilarityMatchesRapidfuzzRandom);
+
+	// 作業領域のテスト
+	TEST_METHOD(TestSimilaritySteadyState);
+};
+}
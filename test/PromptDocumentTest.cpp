@@ -0,0 +1,142 @@
+﻿#include "pch.h"
+#include <random>
+#include "PromptDocumentTest.h"
+#include "../src/TextUtils.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace PromptDocumentTest {
+void PromptDocumentTest::TestVersion() {
+	// 変更のたびに版が1ずつ増え、タグの表も更新される
+	PromptDocument document;
+	Assert::AreEqual(static_cast<uint64_t>(0), document.Version());
+	Assert::IsTrue(document.Update("1girl, smile"));
+	Assert::AreEqual(static_cast<uint64_t>(1), document.Version());
+	document.Edit(5, 0, ", solo");
+	Assert::AreEqual(static_cast<uint64_t>(2), document.Version());
+	Assert::AreEqual(std::string("1girl, solo, smile"), document.Text());
+	Assert::AreEqual(static_cast<size_t>(3), document.Spans().size());
+	Assert::AreEqual(std::string("solo"), document.Tags()[1].tag);
+}
+
+void PromptDocumentTest::TestUpdateUnchanged() {
+	// 同じテキストや空の編集では版は変わらない
+	PromptDocument document;
+	document.Update("1girl, smile");
+	Assert::IsFalse(document.Update("1girl, smile"));
+	document.Edit(3, 0, "");
+	Assert::AreEqual(static_cast<uint64_t>(1), document.Version());
+}
+
+void PromptDocumentTest::TestChangesSince() {
+	// 指定した版より後の変更を古い順に返す
+	PromptDocument document;
+	document.Update("1girl, smile");
+	auto version = document.Version();
+	document.Update("1girl, smile, solo");
+	document.Update("2girls, smile, solo");
+
+	std::vector<DocumentChange> changes;
+	Assert::IsTrue(document.ChangesSince(version, changes));
+	Assert::AreEqual(static_cast<size_t>(2), changes.size());
+	Assert::AreEqual(static_cast<uint64_t>(2), changes[0].version);
+	Assert::AreEqual(static_cast<size_t>(12), changes[0].position);
+	Assert::AreEqual(static_cast<size_t>(0), changes[0].deletedLength);
+	Assert::AreEqual(static_cast<size_t>(6), changes[0].insertedLength);
+	Assert::AreEqual(static_cast<size_t>(0), changes[1].position);
+
+	Assert::IsTrue(document.ChangesSince(document.Version(), changes));
+	Assert::IsTrue(changes.empty());
+}
+
+void PromptDocumentTest::TestChangesSinceTooOld() {
+	// 履歴より古い版からの変更は求められず、範囲はテキスト全体になる
+	PromptDocument document;
+	for (size_t i = 0; i < PromptDocument::MAX_HISTORY + 1; ++i) {
+		document.Edit(document.Text().size(), 0, "a");
+	}
+	std::vector<DocumentChange> changes;
+	Assert::IsFalse(document.ChangesSince(0, changes));
+	Assert::IsTrue(document.ChangesSince(1, changes));
+	Assert::AreEqual(PromptDocument::MAX_HISTORY, changes.size());
+
+	auto [start, end] = document.ChangedRangeSince(0);
+	Assert::AreEqual(static_cast<size_t>(0), start);
+	Assert::AreEqual(document.Text().size(), end);
+}
+
+void PromptDocumentTest::TestChangedRangeSince() {
+	// 離れた2か所の変更は、その間を含む1つの範囲にまとめる
+	PromptDocument document;
+	document.Update("1girl, smile, solo");
+	auto version = document.Version();
+	document.Edit(0, 1, "2");        // "2girl, smile, solo"
+	document.Edit(14, 4, "dress");   // "2girl, smile, dress"
+	auto [start, end] = document.ChangedRangeSince(version);
+	Assert::AreEqual(static_cast<size_t>(0), start);
+	Assert::AreEqual(static_cast<size_t>(19), end);
+
+	// 変更がなければ空の範囲
+	auto [emptyStart, emptyEnd] = document.ChangedRangeSince(document.Version());
+	Assert::AreEqual(emptyStart, emptyEnd);
+}
+
+void PromptDocumentTest::TestChangedRangeSinceRandomEdits() {
+	// 範囲の外のテキストは、変更前のテキストの先頭と末尾にそのまま残っている
+	std::mt19937 random(7);
+	const std::string pieces[] = { "tag", ", ", "(", ")", ":1.2", "\n", "x" };
+	for (int round = 0; round < 200; ++round) {
+		PromptDocument document;
+		document.Update("1girl, (blue hair:1.2), smile\nsolo");
+		auto version = document.Version();
+		auto before = document.Text();
+		int edits = 1 + random() % 4;
+		for (int i = 0; i < edits; ++i) {
+			size_t length = document.Text().size();
+			size_t position = random() % (length + 1);
+			size_t deleted = random() % 3;
+			document.Edit(position, deleted, pieces[random() % _countof(pieces)]);
+		}
+		auto [start, end] = document.ChangedRangeSince(version);
+		const auto& after = document.Text();
+		Assert::IsTrue(start <= end && end <= after.size());
+		size_t suffix = after.size() - end;
+		Assert::IsTrue(start + suffix <= before.size());
+		Assert::AreEqual(0, before.compare(0, start, after, 0, start));
+		Assert::AreEqual(0, before.compare(before.size() - suffix, suffix, after, end, suffix));
+	}
+}
+
+void PromptDocumentTest::TestChangedRangeSinceIncludesReparsedTags() {
+	// 括弧を閉じると、編集位置より前の括弧の中のタグも変わるので範囲に含む
+	PromptDocument document;
+	document.Update("1girl, (smile, solo");
+	auto version = document.Version();
+	document.Edit(document.Text().size(), 0, ")");
+	auto [start, end] = document.ChangedRangeSince(version);
+	Assert::IsTrue(start <= 8);
+	Assert::AreEqual(document.Text().size(), end);
+}
+
+void PromptDocumentTest::TestSpanIndexAt() {
+	// 位置を含むタグか、その後ろの最初のタグ
+	PromptDocument document;
+	document.Update("1girl, (smile:1.2), solo");
+	const auto& spans = document.Spans();
+	Assert::AreEqual(static_cast<size_t>(0), document.SpanIndexAt(0));
+	Assert::AreEqual(static_cast<size_t>(1), document.SpanIndexAt(5));
+	Assert::AreEqual(static_cast<size_t>(2), document.SpanIndexAt(10));
+	Assert::AreEqual(spans.size() - 1, document.SpanIndexAt(20));
+	Assert::AreEqual(spans.size(), document.SpanIndexAt(document.Text().size()));
+}
+
+void PromptDocumentTest::TestWordRangeAt() {
+	// get_span_at_cursor と同じ範囲
+	PromptDocument document;
+	document.Update("1girl, smile\nsolo");
+	for (size_t position = 0; position <= document.Text().size(); ++position) {
+		auto expected = get_span_at_cursor(document.Text(), static_cast<int>(position));
+		Assert::IsTrue(expected == document.WordRangeAt(position));
+	}
+}
+}
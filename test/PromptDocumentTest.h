@@ -0,0 +1,26 @@
+﻿#pragma once
+
+#include "CppUnitTest.h"
+#include "../src/PromptDocument.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace PromptDocumentTest {
+TEST_CLASS(PromptDocumentTest) {
+public:
+	// 版のテスト
+	TEST_METHOD(TestVersion);
+	TEST_METHOD(TestUpdateUnchanged);
+
+	// 変更の履歴のテスト
+	TEST_METHOD(TestChangesSince);
+	TEST_METHOD(TestChangesSinceTooOld);
+	TEST_METHOD(TestChangedRangeSince);
+	TEST_METHOD(TestChangedRangeSinceRandomEdits);
+	TEST_METHOD(TestChangedRangeSinceIncludesReparsedTags);
+
+	// 位置からの参照のテスト
+	TEST_METHOD(TestSpanIndexAt);
+	TEST_METHOD(TestWordRangeAt);
+};
+}
@@ -0,0 +1,100 @@
+﻿#include "pch.h"
+#include "QueryArenaTest.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace QueryArenaTest {
+void QueryArenaTest::TestAllocateWithinBlock() {
+	QueryArena arena(1024);
+	Assert::AreEqual(0ULL, static_cast<unsigned long long>(arena.HeapAllocations()));
+	auto a = arena.allocate(100, 8);
+	auto b = arena.allocate(100, 8);
+	Assert::IsTrue(a != b);
+	// 1つ目のブロックに収まる
+	Assert::AreEqual(1ULL, static_cast<unsigned long long>(arena.HeapAllocations()));
+	Assert::AreEqual(static_cast<size_t>(1024), arena.Capacity());
+	Assert::IsTrue(arena.Used() >= 200);
+}
+
+void QueryArenaTest::TestAlignment() {
+	QueryArena arena(1024);
+	arena.allocate(1, 1);
+	auto p = arena.allocate(16, 64);
+	Assert::AreEqual(static_cast<uintptr_t>(0), reinterpret_cast<uintptr_t>(p) % 64);
+}
+
+void QueryArenaTest::TestGrowLargeRequest() {
+	// ブロックより大きい要求はその大きさのブロックを追加する
+	QueryArena arena(256);
+	arena.allocate(16, 8);
+	auto p = arena.allocate(4096, 8);
+	Assert::IsNotNull(p);
+	Assert::AreEqual(2ULL, static_cast<unsigned long long>(arena.HeapAllocations()));
+	Assert::IsTrue(arena.Capacity() >= 256 + 4096);
+}
+
+void QueryArenaTest::TestResetReusesBlock() {
+	QueryArena arena(1024);
+	auto a = arena.allocate(100, 8);
+	arena.Reset();
+	Assert::AreEqual(static_cast<size_t>(0), arena.Used());
+	// 同じブロックの先頭から使い直す
+	auto b = arena.allocate(100, 8);
+	Assert::IsTrue(a == b);
+	Assert::AreEqual(1ULL, static_cast<unsigned long long>(arena.HeapAllocations()));
+}
+
+void QueryArenaTest::TestResetCoalescesBlocks() {
+	// 複数のブロックを使った後は、合計の大きさの1ブロックにまとめ直し、次からは追加しない
+	QueryArena arena(256);
+	for (int i = 0; i < 10; ++i) {
+		arena.allocate(200, 8);
+	}
+	auto capacity = arena.Capacity();
+	arena.Reset();
+	auto allocations = arena.HeapAllocations();
+	Assert::AreEqual(capacity, arena.Capacity());
+	for (int round = 0; round < 3; ++round) {
+		for (int i = 0; i < 10; ++i) {
+			arena.allocate(200, 8);
+		}
+		arena.Reset();
+	}
+	Assert::AreEqual(static_cast<unsigned long long>(allocations), static_cast<unsigned long long>(arena.HeapAllocations()));
+}
+
+void QueryArenaTest::TestVectorSteadyState() {
+	// 作業領域に確保した配列は、2回目以降ヒープから確保しない
+	QueryArena arena(256);
+	auto fill = [&arena]() {
+		std::pmr::vector<int> values(&arena);
+		for (int i = 0; i < 1000; ++i) {
+			values.push_back(i);
+		}
+		Assert::AreEqual(999, values.back());
+	};
+	fill();
+	arena.Reset();
+	auto allocations = arena.HeapAllocations();
+	for (int i = 0; i < 5; ++i) {
+		fill();
+		arena.Reset();
+	}
+	Assert::AreEqual(static_cast<unsigned long long>(allocations), static_cast<unsigned long long>(arena.HeapAllocations()));
+}
+
+void QueryArenaTest::TestScopeResetsOutermost() {
+	{
+		QueryArena::Scope outer;
+		outer.Arena().allocate(100, 8);
+		{
+			// 内側の範囲を抜けても、外側で確保したものは残る
+			QueryArena::Scope inner;
+			Assert::IsTrue(&inner.Arena() == &outer.Arena());
+			inner.Arena().allocate(100, 8);
+		}
+		Assert::IsTrue(outer.Arena().Used() >= 200);
+	}
+	Assert::AreEqual(static_cast<size_t>(0), QueryArena::ForThread().Used());
+}
+}
@@ -0,0 +1,24 @@
+﻿#pragma once
+
+#include "CppUnitTest.h"
+#include "../src/QueryArena.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace QueryArenaTest {
+TEST_CLASS(QueryArenaTest) {
+public:
+	// 確保のテスト
+	TEST_METHOD(TestAllocateWithinBlock);
+	TEST_METHOD(TestAlignment);
+	TEST_METHOD(TestGrowLargeRequest);
+
+	// 使い回しのテスト
+	TEST_METHOD(TestResetReusesBlock);
+	TEST_METHOD(TestResetCoalescesBlocks);
+	TEST_METHOD(TestVectorSteadyState);
+
+	// 範囲のテスト
+	TEST_METHOD(TestScopeResetsOutermost);
+};
+}
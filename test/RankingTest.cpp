@@ -0,0 +1,107 @@
+﻿#include "pch.h"
+#include "RankingTest.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace RankingTest {
+void RankingTest::TestClassifyMatchExact() {
+	Assert::IsTrue(classify_match(std::string("blue hair"), std::string("blue hair")) == MatchType::Exact);
+}
+
+void RankingTest::TestClassifyMatchPrefix() {
+	Assert::IsTrue(classify_match(std::string("blue"), std::string("blue hair")) == MatchType::Prefix);
+}
+
+void RankingTest::TestClassifyMatchWordPrefix() {
+	// 2単語目以降の先頭に一致
+	Assert::IsTrue(classify_match(std::string("hai"), std::string("blue hair")) == MatchType::WordPrefix);
+	Assert::IsTrue(classify_match(std::string("miku"), std::string("hatsune miku")) == MatchType::WordPrefix);
+}
+
+void RankingTest::TestClassifyMatchFuzzy() {
+	// 単語の途中に一致するだけの場合は曖昧一致
+	Assert::IsTrue(classify_match(std::string("air"), std::string("blue hair")) == MatchType::Fuzzy);
+	Assert::IsTrue(classify_match(std::string("blu hair"), std::string("blue hair")) == MatchType::Fuzzy);
+	// 入力の方が長い場合
+	Assert::IsTrue(classify_match(std::string("blue hairs"), std::string("blue hair")) == MatchType::Fuzzy);
+}
+
+void RankingTest::TestClassifyMatchEmpty() {
+	Assert::IsTrue(classify_match(std::string(""), std::string("blue hair")) == MatchType::Fuzzy);
+	Assert::IsTrue(classify_match(std::string("blue"), std::string("")) == MatchType::Fuzzy);
+}
+
+void RankingTest::TestClassifyMatchWide() {
+	// 逆引き用にワイド文字列でも判定できる
+	Assert::IsTrue(classify_match(std::wstring(L"猫耳"), std::wstring(L"猫耳")) == MatchType::Exact);
+	Assert::IsTrue(classify_match(std::wstring(L"猫"), std::wstring(L"猫耳")) == MatchType::Prefix);
+	Assert::IsTrue(classify_match(std::wstring(L"耳"), std::wstring(L"猫耳")) == MatchType::Fuzzy);
+}
+
+void RankingTest::TestStaticScorePopularity() {
+	RankingWeights weights;
+	// 投稿数が多いほど高スコア
+	Assert::IsTrue(static_tag_score(100000, 0, false, weights) > static_tag_score(100, 0, false, weights));
+	// 投稿数0（不明）でも計算できる
+	Assert::AreEqual(0.0, static_tag_score(0, 0, false, weights));
+}
+
+void RankingTest::TestStaticScoreCategory() {
+	RankingWeights weights;
+	weights.category[1] = -10.0;
+	Assert::AreEqual(-10.0, static_tag_score(0, 1, false, weights));
+	Assert::AreEqual(0.0, static_tag_score(0, 0, false, weights));
+}
+
+void RankingTest::TestStaticScoreUserBoost() {
+	RankingWeights weights;
+	double boosted = static_tag_score(100, 0, true, weights);
+	double normal = static_tag_score(100, 0, false, weights);
+	Assert::AreEqual(weights.userBoost, boosted - normal);
+}
+
+void RankingTest::TestStaticScoreInvalidCategory() {
+	// 範囲外のカテゴリーは加点なし
+	RankingWeights weights;
+	Assert::AreEqual(0.0, static_tag_score(0, -1, false, weights));
+	Assert::AreEqual(0.0, static_tag_score(0, 99, false, weights));
+}
+
+void RankingTest::TestRankScoreMatchTypeOrder() {
+	// 同じ静的スコアなら 完全一致 > 前方一致 > 単語の前方一致 > 曖昧一致
+	RankingWeights weights;
+	double exact = rank_score(MatchType::Exact, 100.0, 0.0, weights);
+	double prefix = rank_score(MatchType::Prefix, 100.0, 0.0, weights);
+	double wordPrefix = rank_score(MatchType::WordPrefix, 100.0, 0.0, weights);
+	double fuzzy = rank_score(MatchType::Fuzzy, 100.0, 0.0, weights);
+	Assert::IsTrue(exact > prefix);
+	Assert::IsTrue(prefix > wordPrefix);
+	Assert::IsTrue(wordPrefix > fuzzy);
+}
+
+void RankingTest::TestRankScorePopularityBreaksTie() {
+	// 一致の種類と類似度が同じなら人気のタグが上位
+	RankingWeights weights;
+	double popular = rank_score(MatchType::Fuzzy, 80.0, static_tag_score(1000000, 0, false, weights), weights);
+	double minor = rank_score(MatchType::Fuzzy, 80.0, static_tag_score(10, 0, false, weights), weights);
+	Assert::IsTrue(popular > minor);
+}
+
+void RankingTest::TestRankScoreCustomWeights() {
+	// 重みを変えると結果が変わる（オフラインでの調整用）
+	RankingWeights weights;
+	weights.exact = 0.0;
+	weights.fuzzy = 1000.0;
+	weights.similarity = 0.0;
+	Assert::AreEqual(1000.0, rank_score(MatchType::Fuzzy, 60.0, 0.0, weights));
+	Assert::AreEqual(5.0, rank_score(MatchType::Exact, 100.0, 5.0, weights));
+}
+
+void RankingTest::TestDescriptionTierOrder() {
+	// 既定の重みでは 人手による翻訳 > 機械翻訳 > 機械翻訳のみ
+	RankingWeights weights;
+	auto tier = [&](DescriptionTier t) { return weights.descriptionTier[static_cast<size_t>(t)]; };
+	Assert::IsTrue(tier(DescriptionTier::Curated) > tier(DescriptionTier::Machine));
+	Assert::IsTrue(tier(DescriptionTier::Machine) > tier(DescriptionTier::MachineOnly));
+}
+}
@@ -0,0 +1,33 @@
+﻿#pragma once
+
+#include "CppUnitTest.h"
+#include "../src/Ranking.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace RankingTest {
+TEST_CLASS(RankingTest) {
+public:
+	// 一致の種類の判定のテスト
+	TEST_METHOD(TestClassifyMatchExact);
+	TEST_METHOD(TestClassifyMatchPrefix);
+	TEST_METHOD(TestClassifyMatchWordPrefix);
+	TEST_METHOD(TestClassifyMatchFuzzy);
+	TEST_METHOD(TestClassifyMatchEmpty);
+	TEST_METHOD(TestClassifyMatchWide);
+
+	// 静的スコアのテスト
+	TEST_METHOD(TestStaticScorePopularity);
+	TEST_METHOD(TestStaticScoreCategory);
+	TEST_METHOD(TestStaticScoreUserBoost);
+	TEST_METHOD(TestStaticScoreInvalidCategory);
+
+	// 総合スコアのテスト
+	TEST_METHOD(TestRankScoreMatchTypeOrder);
+	TEST_METHOD(TestRankScorePopularityBreaksTie);
+	TEST_METHOD(TestRankScoreCustomWeights);
+
+	// 説明文の出典の重みのテスト
+	TEST_METHOD(TestDescriptionTierOrder);
+};
+}
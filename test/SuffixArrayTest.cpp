@@ -0,0 +1,88 @@
+﻿#include "pch.h"
+#include "SuffixArrayTest.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace SuffixArrayTest {
+// テスト用のテキスト（説明文を区切り文字で連結したもの）
+static const std::wstring& TestText() {
+	static const std::wstring text = std::wstring(L"青髪") + SuffixArray::SEPARATOR
+		+ L"学校の制服" + SuffixArray::SEPARATOR
+		+ L"制服" + SuffixArray::SEPARATOR
+		+ L"金髪" + SuffixArray::SEPARATOR;
+	return text;
+}
+
+void SuffixArrayTest::TestBuild() {
+	SuffixArray index;
+	index.Build(TestText());
+	// 区切り文字から始まる接尾辞は登録しない
+	Assert::AreEqual(static_cast<size_t>(11), index.Size());
+}
+
+void SuffixArrayTest::TestClear() {
+	SuffixArray index;
+	index.Build(TestText());
+	index.Clear();
+	Assert::AreEqual(static_cast<size_t>(0), index.Size());
+	Assert::IsTrue(index.FindAll(L"制服").empty());
+}
+
+void SuffixArrayTest::TestLcp() {
+	SuffixArray index;
+	index.Build(TestText());
+	// 接尾辞は昇順に並び、LCP は隣との共通接頭辞の長さ
+	Assert::AreEqual(static_cast<uint32_t>(0), index.Lcp(0));
+	const auto& text = TestText();
+	for (size_t i = 1; i < index.Size(); ++i) {
+		std::wstring prev(text.c_str() + index.Position(i - 1));
+		std::wstring curr(text.c_str() + index.Position(i));
+		Assert::IsTrue(prev <= curr);
+		size_t lcp = 0;
+		while (lcp < prev.size() && lcp < curr.size() && prev[lcp] == curr[lcp]) ++lcp;
+		Assert::AreEqual(static_cast<uint32_t>(lcp), index.Lcp(i));
+	}
+}
+
+void SuffixArrayTest::TestFind() {
+	SuffixArray index;
+	index.Build(TestText());
+	auto [first, last] = index.Find(L"髪");
+	Assert::AreEqual(static_cast<size_t>(2), last - first);
+	auto [first2, last2] = index.Find(L"制服");
+	Assert::AreEqual(static_cast<size_t>(2), last2 - first2);
+}
+
+void SuffixArrayTest::TestFindAll() {
+	SuffixArray index;
+	index.Build(TestText());
+	// 位置の昇順
+	auto result = index.FindAll(L"制服");
+	Assert::AreEqual(static_cast<size_t>(2), result.size());
+	Assert::AreEqual(static_cast<uint32_t>(6), result[0]);
+	Assert::AreEqual(static_cast<uint32_t>(9), result[1]);
+}
+
+void SuffixArrayTest::TestFindNoMatch() {
+	SuffixArray index;
+	index.Build(TestText());
+	Assert::IsTrue(index.FindAll(L"猫耳").empty());
+	Assert::IsTrue(index.FindAll(L"制服姿").empty());
+}
+
+void SuffixArrayTest::TestFindEmpty() {
+	SuffixArray index;
+	index.Build(TestText());
+	Assert::IsTrue(index.FindAll(L"").empty());
+
+	SuffixArray empty;
+	Assert::IsTrue(empty.FindAll(L"制服").empty());
+}
+
+void SuffixArrayTest::TestFindAcrossSeparator() {
+	SuffixArray index;
+	index.Build(TestText());
+	// 文書をまたいだ一致はしない（「青髪」と「学校の制服」の境界）
+	Assert::IsTrue(index.FindAll(L"髪学").empty());
+}
+}
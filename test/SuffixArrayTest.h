@@ -0,0 +1,23 @@
+﻿#pragma once
+
+#include "CppUnitTest.h"
+#include "../src/SuffixArray.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace SuffixArrayTest {
+TEST_CLASS(SuffixArrayTest) {
+public:
+	// 構築のテスト
+	TEST_METHOD(TestBuild);
+	TEST_METHOD(TestClear);
+	TEST_METHOD(TestLcp);
+
+	// 部分文字列の検索のテスト
+	TEST_METHOD(TestFind);
+	TEST_METHOD(TestFindAll);
+	TEST_METHOD(TestFindNoMatch);
+	TEST_METHOD(TestFindEmpty);
+	TEST_METHOD(TestFindAcrossSeparator);
+};
+}
@@ -0,0 +1,69 @@
+﻿#include "pch.h"
+#include "SuggestionCacheTest.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace SuggestionCacheTest {
+// 1件だけのサジェスト
+static TagHandleList Single(uint32_t id) {
+	return { { id, 0.0f, SuggestionStage::Prefix } };
+}
+
+void SuggestionCacheTest::TestFindStored() {
+	SuggestionCache cache;
+	cache.Store("blue", 1, Single(1), false);
+	auto found = cache.Find("blue", 1);
+	Assert::IsNotNull(found);
+	Assert::AreEqual(1u, (*found)[0].id);
+	Assert::AreEqual(1ULL, static_cast<unsigned long long>(cache.Hits()));
+}
+
+void SuggestionCacheTest::TestFindMissing() {
+	SuggestionCache cache;
+	cache.Store("blue", 1, Single(1), false);
+	Assert::IsNull(cache.Find("red", 1));
+	Assert::AreEqual(1ULL, static_cast<unsigned long long>(cache.Lookups()));
+	Assert::AreEqual(0ULL, static_cast<unsigned long long>(cache.Hits()));
+}
+
+void SuggestionCacheTest::TestVersionMismatch() {
+	// 辞書の版が変わった結果は使わない
+	SuggestionCache cache;
+	cache.Store("blue", 1, Single(1), false);
+	Assert::IsNull(cache.Find("blue", 2));
+	Assert::IsFalse(cache.Contains("blue", 2));
+}
+
+void SuggestionCacheTest::TestEvictLeastRecentlyUsed() {
+	SuggestionCache cache(2);
+	cache.Store("a", 1, Single(1), false);
+	cache.Store("b", 1, Single(2), false);
+	// a を使ったので、次の登録では b が削除される
+	Assert::IsNotNull(cache.Find("a", 1));
+	cache.Store("c", 1, Single(3), false);
+	Assert::AreEqual(static_cast<size_t>(2), cache.Size());
+	Assert::IsTrue(cache.Contains("a", 1));
+	Assert::IsFalse(cache.Contains("b", 1));
+	Assert::IsTrue(cache.Contains("c", 1));
+}
+
+void SuggestionCacheTest::TestSpeculativeHit() {
+	// 先読みした結果が使われたのは最初の1回だけ数える
+	SuggestionCache cache;
+	cache.Store("blue", 1, Single(1), true);
+	cache.Store("red", 1, Single(2), true);
+	Assert::IsNotNull(cache.Find("blue", 1));
+	Assert::IsNotNull(cache.Find("blue", 1));
+	Assert::AreEqual(2ULL, static_cast<unsigned long long>(cache.SpeculativeStores()));
+	Assert::AreEqual(1ULL, static_cast<unsigned long long>(cache.SpeculativeHits()));
+	Assert::AreEqual(2ULL, static_cast<unsigned long long>(cache.Hits()));
+}
+
+void SuggestionCacheTest::TestContainsNotCounted() {
+	SuggestionCache cache;
+	cache.Store("blue", 1, Single(1), true);
+	Assert::IsTrue(cache.Contains("blue", 1));
+	Assert::AreEqual(0ULL, static_cast<unsigned long long>(cache.Lookups()));
+	Assert::AreEqual(0ULL, static_cast<unsigned long long>(cache.SpeculativeHits()));
+}
+}
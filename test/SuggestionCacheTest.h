@@ -0,0 +1,21 @@
+﻿#pragma once
+
+#include "CppUnitTest.h"
+#include "../src/SuggestionCache.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace SuggestionCacheTest {
+TEST_CLASS(SuggestionCacheTest) {
+public:
+	// 登録と検索のテスト
+	TEST_METHOD(TestFindStored);
+	TEST_METHOD(TestFindMissing);
+	TEST_METHOD(TestVersionMismatch);
+	TEST_METHOD(TestEvictLeastRecentlyUsed);
+
+	// 統計のテスト
+	TEST_METHOD(TestSpeculativeHit);
+	TEST_METHOD(TestContainsNotCounted);
+};
+}
@@ -14,12 +14,21 @@ static std::wstring ToString<Suggestion>(Suggestion* q) {
 namespace SuggestionTest {
 void SuggestionTest::SetUp() {
 	// テスト前の初期化処理
+	// 辞書ファイルに依存しないよう、テストごとにテスト用の辞書に差し替える
+	BooruDBTest::BooruDBTestHelper::SetupTestData(BooruDB::GetInstance());
 }
 
 void SuggestionTest::TearDown() {
 	// テスト後のクリーンアップ処理
 }
 
+// サジェスト処理を開始し、テスト用の辞書に差し替える
+// StartSuggestion は辞書ファイルがあれば読み込み直すので、その後で差し替える
+static void StartWithTestData(Suggestion& manager, std::function<void(const SuggestionBatch&)> callback) {
+	manager.StartSuggestion(callback);
+	BooruDBTest::BooruDBTestHelper::SetupTestData(BooruDB::GetInstance());
+}
+
 void SuggestionTest::TestConstructor() {
 	// コンストラクタのテスト
 	Suggestion manager;
@@ -44,7 +53,7 @@ void SuggestionTest::TestStartSuggestion() {
 	Suggestion manager;
 	bool callbackCalled = false;
 
-	auto callback = [&callbackCalled](const TagList& suggestions) {
+	auto callback = [&callbackCalled](const SuggestionBatch& batch) {
 		callbackCalled = true;
 		};
 
@@ -70,7 +79,7 @@ void SuggestionTest::TestRequest() {
 	bool callbackCalled = false;
 	std::string receivedInput;
 
-	auto callback = [&callbackCalled, &receivedInput](const TagList& suggestions) {
+	auto callback = [&callbackCalled, &receivedInput](const SuggestionBatch& batch) {
 		callbackCalled = true;
 		};
 
@@ -86,7 +95,7 @@ void SuggestionTest::TestRequestEmpty() {
 	Suggestion manager;
 	bool callbackCalled = false;
 
-	auto callback = [&callbackCalled](const TagList& suggestions) {
+	auto callback = [&callbackCalled](const SuggestionBatch& batch) {
 		callbackCalled = true;
 		};
 
@@ -102,7 +111,7 @@ void SuggestionTest::TestRequestMultiple() {
 	Suggestion manager;
 	bool callbackCalled = false;
 
-	auto callback = [&callbackCalled](const TagList& suggestions) {
+	auto callback = [&callbackCalled](const SuggestionBatch& batch) {
 		callbackCalled = true;
 		};
 
@@ -120,7 +129,7 @@ void SuggestionTest::TestShutdown() {
 	Suggestion manager;
 	bool callbackCalled = false;
 
-	auto callback = [&callbackCalled](const TagList& suggestions) {
+	auto callback = [&callbackCalled](const SuggestionBatch& batch) {
 		callbackCalled = true;
 		};
 
@@ -144,37 +153,278 @@ void SuggestionTest::TestShutdownMultiple() {
 	Assert::IsTrue(true);
 }
 
-void SuggestionTest::TestTimerDelay() {
-	// タイマー遅延のテスト
+void SuggestionTest::TestWorkerDelay() {
+	// 入力直後は結果が届かない（入力が落ち着くまで待つ）
 	Suggestion manager;
-	bool callbackCalled = false;
+	int resultCount = 0;
 
-	auto callback = [&callbackCalled](const TagList& suggestions) {
-		callbackCalled = true;
+	auto callback = [&resultCount](const SuggestionBatch& batch) {
+		if (!batch.suggestions.empty()) resultCount++;
 		};
 
 	manager.StartSuggestion(callback);
-	manager.Request("test_input");
+	manager.Request("blue");
+	manager.DeliverResults();
 
-	// タイマーが設定されることを確認（実際の遅延はテスト環境では確認困難）
-	Assert::IsTrue(true);
+	Assert::AreEqual(0, resultCount);
 }
 
-void SuggestionTest::TestTimerCancellation() {
-	// タイマーキャンセルのテスト
+void SuggestionTest::TestWorkerCancellation() {
+	// 処理中にシャットダウンしても結果は届かない
 	Suggestion manager;
-	bool callbackCalled = false;
+	int resultCount = 0;
 
-	auto callback = [&callbackCalled](const TagList& suggestions) {
-		callbackCalled = true;
+	auto callback = [&resultCount](const SuggestionBatch& batch) {
+		if (!batch.suggestions.empty()) resultCount++;
 		};
 
 	manager.StartSuggestion(callback);
 	manager.Request("first_input");
-	manager.Request("second_input"); // 前のタイマーがキャンセルされる
+	manager.Request("second_input"); // 前のリクエストは上書きされる
+	manager.Shutdown();
+	manager.DeliverResults();
 
-	// タイマーがキャンセルされることを確認
-	Assert::IsTrue(true);
+	Assert::AreEqual(0, resultCount);
+}
+
+void SuggestionTest::TestWorkerLatestRequestWins() {
+	// 続けてリクエストすると最後のリクエストの結果だけが届く
+	Suggestion manager;
+	std::vector<SuggestionBatch> results;
+	bool final = false;
+
+	auto callback = [&results, &final](const SuggestionBatch& batch) {
+		if (!batch.suggestions.empty()) results.push_back(batch);
+		final = batch.final;
+		};
+
+	StartWithTestData(manager, callback);
+	manager.Request("long");
+	manager.Request("blue");
+	for (int i = 0; i < 100 && !final; ++i) {
+		Sleep(50);
+		manager.DeliverResults();
+	}
+	manager.Shutdown();
+
+	// テスト用の辞書では blue で始まるタグのうち blue eyes が最も人気
+	auto& db = BooruDB::GetInstance();
+	Assert::IsFalse(results.empty());
+	Assert::IsTrue(results[0].stage == SuggestionStage::Prefix);
+	Assert::AreEqual(std::string("blue eyes"), db.GetTagName(results[0].suggestions[0]));
+
+	// 上書きされたリクエスト（long）の結果は届かない
+	for (const auto& batch : results) {
+		for (const auto& suggestion : batch.suggestions) {
+			Assert::AreNotEqual(std::string("long hair"), db.GetTagName(suggestion));
+		}
+	}
+}
+
+void SuggestionTest::TestStreamingStages() {
+	// 段階ごとに差分が届き、最後の結果には final が付く
+	Suggestion manager;
+	std::vector<SuggestionBatch> results;
+	TagHandleList shown;
+
+	auto callback = [&results, &shown](const SuggestionBatch& batch) {
+		// 差分は表示済みの件数以内の位置に追加される
+		Assert::IsTrue(batch.offset <= shown.size());
+		shown.resize(batch.offset);
+		shown.insert(shown.end(), batch.suggestions.begin(), batch.suggestions.end());
+		results.push_back(batch);
+		};
+
+	StartWithTestData(manager, callback);
+	manager.Request("blue");
+	for (int i = 0; i < 100 && (results.empty() || !results.back().final); ++i) {
+		Sleep(50);
+		manager.DeliverResults();
+	}
+	manager.Shutdown();
+
+	Assert::IsTrue(results.size() >= 3);
+	Assert::IsTrue(results.front().stage == SuggestionStage::Clear);
+	Assert::IsTrue(results[1].stage == SuggestionStage::Prefix);
+	Assert::AreEqual(static_cast<size_t>(0), results[1].offset);
+	Assert::IsTrue(results.back().stage == SuggestionStage::Fuzzy);
+	Assert::IsTrue(results.back().final);
+	for (size_t i = 0; i + 1 < results.size(); ++i) {
+		Assert::IsFalse(results[i].final);
+	}
+
+	// 段階をまたいで同じタグは届かない
+	std::unordered_set<uint32_t> seen;
+	for (const auto& suggestion : shown) {
+		Assert::IsTrue(seen.insert(suggestion.id).second);
+	}
+}
+
+// 最後の結果が届くまで待ち、表示されるサジェストを返す
+static TagHandleList WaitForFinal(Suggestion& manager, TagHandleList& shown, std::vector<SuggestionBatch>& results) {
+	for (int i = 0; i < 100 && (results.empty() || !results.back().final); ++i) {
+		Sleep(50);
+		manager.DeliverResults();
+	}
+	return shown;
+}
+
+void SuggestionTest::TestSpeculativeCacheHit() {
+	// 空いている間に先読みした入力は、1回の結果でまとめて届き、通常の検索と同じ結果になる
+	auto next = BooruDB::GetInstance().LikelyContinuations("blu", 1);
+	Assert::AreEqual(static_cast<size_t>(1), next.size());
+	Assert::AreEqual(std::string("blue"), next[0]);
+
+	Suggestion manager;
+	std::vector<SuggestionBatch> results;
+	TagHandleList shown;
+	auto callback = [&results, &shown](const SuggestionBatch& batch) {
+		shown.resize(batch.offset);
+		shown.insert(shown.end(), batch.suggestions.begin(), batch.suggestions.end());
+		results.push_back(batch);
+		};
+	StartWithTestData(manager, callback);
+	manager.Request("blu");
+	WaitForFinal(manager, shown, results);
+	for (int i = 0; i < 100 && manager.SpeculatedCount() == 0; ++i) {
+		Sleep(50);
+	}
+	Assert::IsTrue(manager.SpeculatedCount() > 0);
+
+	results.clear();
+	manager.Request(next[0]);
+	auto speculated = WaitForFinal(manager, shown, results);
+	manager.Shutdown();
+	Assert::IsTrue(results.back().stage == SuggestionStage::Cached);
+
+	// 先読みしていない場合の結果と比べる
+	Suggestion fresh;
+	std::vector<SuggestionBatch> freshResults;
+	TagHandleList freshShown;
+	StartWithTestData(fresh, [&freshResults, &freshShown](const SuggestionBatch& batch) {
+		freshShown.resize(batch.offset);
+		freshShown.insert(freshShown.end(), batch.suggestions.begin(), batch.suggestions.end());
+		freshResults.push_back(batch);
+		});
+	fresh.Request(next[0]);
+	auto expected = WaitForFinal(fresh, freshShown, freshResults);
+	fresh.Shutdown();
+	Assert::IsFalse(expected.empty());
+	Assert::AreEqual(expected.size(), speculated.size());
+	for (size_t i = 0; i < expected.size(); ++i) {
+		Assert::AreEqual(expected[i].id, speculated[i].id);
+	}
+}
+
+void SuggestionTest::TestExactAndAliasStages() {
+	// 完全一致は前方一致より先に単独の段階として届き、別名の前方一致は前方一致の後に届く
+	auto& db = BooruDB::GetInstance();
+	auto request = [](const std::string& input, std::vector<SuggestionBatch>& results) {
+		Suggestion manager;
+		TagHandleList shown;
+		StartWithTestData(manager, [&results, &shown](const SuggestionBatch& batch) {
+			shown.resize(batch.offset);
+			shown.insert(shown.end(), batch.suggestions.begin(), batch.suggestions.end());
+			results.push_back(batch);
+			});
+		manager.Request(input);
+		auto final = WaitForFinal(manager, shown, results);
+		manager.Shutdown();
+		return final;
+	};
+
+	std::vector<SuggestionBatch> results;
+	auto shown = request("cat ears", results);
+	Assert::IsTrue(results.size() >= 3);
+	Assert::IsTrue(results[1].stage == SuggestionStage::Exact);
+	Assert::AreEqual(static_cast<size_t>(0), results[1].offset);
+	Assert::AreEqual(static_cast<size_t>(1), results[1].suggestions.size());
+	Assert::AreEqual(std::string("cat ears"), db.GetTagName(results[1].suggestions[0]));
+	Assert::IsTrue(results[2].stage == SuggestionStage::Prefix);
+	Assert::AreEqual(static_cast<size_t>(1), results[2].offset);
+
+	// nekomimi は cat ears の別名（ローマ字読みも説明文のネコミミに一致するが、別名に一致したので英語として扱う）
+	results.clear();
+	shown = request("nekomimi", results);
+	auto alias = std::find_if(results.begin(), results.end(),
+		[](const SuggestionBatch& batch) { return batch.stage == SuggestionStage::Alias; });
+	Assert::IsTrue(alias != results.end());
+	Assert::AreEqual(std::string("cat ears"), db.GetTagName(alias->suggestions.front()));
+	Assert::IsTrue(alias->suggestions.front().stage == SuggestionStage::Alias);
+	size_t count = 0;
+	for (const auto& suggestion : shown) {
+		Assert::IsTrue(suggestion.stage != SuggestionStage::Romaji);
+		if (db.GetTagName(suggestion) == "cat ears") count++;
+	}
+	Assert::AreEqual(static_cast<size_t>(1), count);
+}
+
+void SuggestionTest::TestRomajiRankedWithFuzzy() {
+	// ローマ字の逆引きの結果は曖昧検索の結果とスコアで比べて並ぶ
+	// 「hair」はハイラル城（hairaru）のローマ字読みにも一致するが、投稿数の少ないタグなので人気の髪型のタグより下になる
+	Suggestion manager;
+	std::vector<SuggestionBatch> results;
+	TagHandleList shown;
+	StartWithTestData(manager, [&results, &shown](const SuggestionBatch& batch) {
+		shown.resize(batch.offset);
+		shown.insert(shown.end(), batch.suggestions.begin(), batch.suggestions.end());
+		results.push_back(batch);
+		});
+	manager.Request("hair");
+	WaitForFinal(manager, shown, results);
+	manager.Shutdown();
+
+	auto& db = BooruDB::GetInstance();
+	Assert::IsFalse(shown.empty());
+	Assert::AreEqual(std::string("long hair"), db.GetTagName(shown.front()));
+	for (size_t i = 1; i < shown.size(); ++i) {
+		Assert::IsTrue(shown[i - 1].score >= shown[i].score);
+	}
+	auto position = [&](const std::string& tag) {
+		for (size_t i = 0; i < shown.size(); ++i) {
+			if (db.GetTagName(shown[i]) == tag) return i;
+		}
+		return shown.size();
+	};
+	auto castle = position("hyrule castle");
+	Assert::IsTrue(castle < shown.size());
+	Assert::IsTrue(shown[castle].stage == SuggestionStage::Romaji);
+	Assert::IsTrue(position("blue hair") < castle);
+}
+
+void SuggestionTest::TestRomajiHiddenForEnglishPrefix() {
+	// 英語のタグに前方一致する入力では、ローマ字の逆引きの結果を出さない
+	// 「long hair」のローマ字読みは「はい」（hai）の説明文に部分一致するが、英語として打っているので雑音になる
+	auto& db = BooruDB::GetInstance();
+	TagHandleList romaji;
+	db.RomajiSuggestion(romaji, "long hair", 8);
+	Assert::IsFalse(romaji.empty());
+	Assert::AreEqual(std::string("yes"), db.GetTagName(romaji.front()));
+
+	Suggestion manager;
+	std::vector<SuggestionBatch> results;
+	TagHandleList shown;
+	StartWithTestData(manager, [&results, &shown](const SuggestionBatch& batch) {
+		shown.resize(batch.offset);
+		shown.insert(shown.end(), batch.suggestions.begin(), batch.suggestions.end());
+		results.push_back(batch);
+		});
+	manager.Request("long hair");
+	WaitForFinal(manager, shown, results);
+	manager.Shutdown();
+
+	Assert::IsFalse(results.empty());
+	Assert::IsTrue(results.back().final);
+	for (const auto& batch : results) {
+		Assert::IsTrue(batch.stage != SuggestionStage::Romaji);
+		for (const auto& suggestion : batch.suggestions) {
+			Assert::IsTrue(suggestion.stage != SuggestionStage::Romaji);
+		}
+	}
+	Assert::AreEqual(std::string("long hair"), db.GetTagName(shown.front()));
+	for (const auto& suggestion : shown) {
+		Assert::AreNotEqual(std::string("yes"), db.GetTagName(suggestion));
+	}
 }
 
 void SuggestionTest::TestCallbackExecution() {
@@ -182,14 +432,14 @@ void SuggestionTest::TestCallbackExecution() {
 	Suggestion manager;
 	bool callbackCalled = false;
 
-	auto callback = [&callbackCalled](const TagList& suggestions) {
+	auto callback = [&callbackCalled](const SuggestionBatch& batch) {
 		callbackCalled = true;
 		};
 
 	manager.StartSuggestion(callback);
 	manager.Request("test_input");
 
-	// コールバックが設定されることを確認（実際の実行はタイマーに依存）
+	// コールバックが設定されることを確認（実際の実行はワーカースレッドに依存）
 	Assert::IsTrue(true);
 }
 
@@ -198,7 +448,7 @@ void SuggestionTest::TestCallbackWithEmptyInput() {
 	Suggestion manager;
 	bool callbackCalled = false;
 
-	auto callback = [&callbackCalled](const TagList& suggestions) {
+	auto callback = [&callbackCalled](const SuggestionBatch& batch) {
 		callbackCalled = true;
 		};
 
@@ -208,4 +458,19 @@ void SuggestionTest::TestCallbackWithEmptyInput() {
 	// 空入力でもコールバックが設定されることを確認
 	Assert::IsTrue(true);
 }
+
+void SuggestionTest::TestDeliverResultsWithoutRequest() {
+	// 結果が届いていなければコールバックは呼ばれない
+	Suggestion manager;
+	bool callbackCalled = false;
+
+	auto callback = [&callbackCalled](const SuggestionBatch& batch) {
+		callbackCalled = true;
+		};
+
+	manager.StartSuggestion(callback);
+	manager.DeliverResults();
+
+	Assert::IsFalse(callbackCalled);
+}
 }
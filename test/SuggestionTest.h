@@ -2,6 +2,7 @@
 
 #include "CppUnitTest.h"
 #include "../src/Suggestion.h"
+#include "BooruDBTestHelper.h"
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -29,12 +30,19 @@ public:
 	TEST_METHOD(TestShutdown);
 	TEST_METHOD(TestShutdownMultiple);
 
-	// タイマー処理のテスト
-	TEST_METHOD(TestTimerDelay);
-	TEST_METHOD(TestTimerCancellation);
+	// ワーカースレッドのテスト
+	TEST_METHOD(TestWorkerDelay);
+	TEST_METHOD(TestWorkerCancellation);
+	TEST_METHOD(TestWorkerLatestRequestWins);
+	TEST_METHOD(TestStreamingStages);
+	TEST_METHOD(TestExactAndAliasStages);
+	TEST_METHOD(TestSpeculativeCacheHit);
+	TEST_METHOD(TestRomajiRankedWithFuzzy);
+	TEST_METHOD(TestRomajiHiddenForEnglishPrefix);
 
 	// コールバック処理のテスト
 	TEST_METHOD(TestCallbackExecution);
 	TEST_METHOD(TestCallbackWithEmptyInput);
+	TEST_METHOD(TestDeliverResultsWithoutRequest);
 };
 }
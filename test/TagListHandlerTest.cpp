@@ -27,9 +27,7 @@ namespace TagListHandlerTest {
 void BooruDBTestHelper::SetupTestData(BooruDB& db) {
 	// テスト用のタグとカテゴリーを設定
 	// フレンドクラスとしてprivateメンバーにアクセス可能
-	db.dictionary_.clear();
-	db.category_.clear();
-	db.metadata_.clear();
+	auto tables = std::make_shared<BooruDB::Tables>();
 
 	// テスト用のタグを追加（順序が重要）
 	std::vector<std::pair<std::string, int>> testTags = {
@@ -53,11 +51,15 @@ void BooruDBTestHelper::SetupTestData(BooruDB& db) {
 
 	int index = 0;
 	for (const auto& [tag, category] : testTags) {
-		db.dictionary_.push_back(tag);
-		db.category_[tag] = category;
-		db.metadata_[tag] = L"テスト用メタデータ";
+		tables->dictionary.push_back(tag);
+		tables->category[tag] = category;
+		tables->AddDescription(tag, L"テスト用メタデータ", DescriptionTier::Curated);
 		index++;
 	}
+
+	// 検索用の索引を構築して差し替え
+	tables->BuildIndex();
+	db.Publish(std::move(tables));
 }
 
 // テストクラス全体の初期化（1回だけ実行される）
@@ -1,4 +1,5 @@
 ﻿#include "pch.h"
+#include <chrono>
 #include <sstream>
 #include <iomanip>
 #include "TextUtilsTest.h"
@@ -119,6 +120,53 @@ void TextUtilsTest::TestUtf8HasMultibyteJapanese() {
 	Assert::IsTrue(has_multibyte);
 }
 
+void TextUtilsTest::TestSplitScriptRuns() {
+	// 英語と日本語の境界で分割し、前後の空白を取り除く
+	auto runs = split_script_runs("miku 制服");
+	Assert::AreEqual(static_cast<size_t>(2), runs.size());
+	Assert::AreEqual("miku", runs[0].c_str());
+	Assert::AreEqual("制服", runs[1].c_str());
+
+	runs = split_script_runs("猫耳long hair");
+	Assert::AreEqual(static_cast<size_t>(2), runs.size());
+	Assert::AreEqual("猫耳", runs[0].c_str());
+	Assert::AreEqual("long hair", runs[1].c_str());
+}
+
+void TextUtilsTest::TestSplitScriptRunsSingle() {
+	// 1つの文字種だけなら分割しない（単語の間の空白は境界にしない）
+	auto runs = split_script_runs("long hair");
+	Assert::AreEqual(static_cast<size_t>(1), runs.size());
+	Assert::AreEqual("long hair", runs[0].c_str());
+
+	runs = split_script_runs("制服 猫耳");
+	Assert::AreEqual(static_cast<size_t>(1), runs.size());
+	Assert::AreEqual("制服 猫耳", runs[0].c_str());
+}
+
+void TextUtilsTest::TestSplitScriptRunsSpaces() {
+	// 空白だけの部分は返さない
+	Assert::IsTrue(split_script_runs("").empty());
+	Assert::IsTrue(split_script_runs("   ").empty());
+	auto runs = split_script_runs("  制服  ");
+	Assert::AreEqual(static_cast<size_t>(1), runs.size());
+	Assert::AreEqual("制服", runs[0].c_str());
+}
+
+void TextUtilsTest::TestSplitScriptRunsViews() {
+	// 作業領域に確保する版は、入力の部分文字列として同じ部分を返す
+	std::pmr::monotonic_buffer_resource resource;
+	for (std::string_view input : { "miku 制服", "猫耳long hair", "  制服  ", "   ", "blue\n猫耳\t hair", "" }) {
+		auto expected = split_script_runs(input);
+		auto runs = split_script_runs(input, &resource);
+		Assert::AreEqual(expected.size(), runs.size());
+		for (size_t i = 0; i < runs.size(); ++i) {
+			Assert::AreEqual(expected[i], std::string(runs[i]));
+			Assert::IsTrue(runs[i].data() >= input.data() && runs[i].data() + runs[i].size() <= input.data() + input.size());
+		}
+	}
+}
+
 void TextUtilsTest::TestGetSpanAtCursor() {
 	// 基本的なワード範囲取得のテスト
 	std::string text = "oh, Hello World, xxx";
@@ -170,6 +218,28 @@ void TextUtilsTest::TestGetSpanAtCursorOnComma() {
 	Assert::IsTrue(std::make_tuple(6, 6) == get_span_at_cursor(text3, 5)); // 2つ目のカンマ（位置5）を指している
 }
 
+void TextUtilsTest::TestFindChangedRange() {
+	// 先頭と末尾の共通部分を除いた範囲
+	size_t position, deletedLength, insertedLength;
+	Assert::IsTrue(find_changed_range("1girl, smile", "1girl, blue, smile", position, deletedLength, insertedLength));
+	Assert::AreEqual(static_cast<size_t>(7), position);
+	Assert::AreEqual(static_cast<size_t>(0), deletedLength);
+	Assert::AreEqual(static_cast<size_t>(6), insertedLength);
+
+	// 繰り返しの中の削除は、末尾の共通部分が先頭の共通部分と重ならない
+	Assert::IsTrue(find_changed_range("aaa", "aa", position, deletedLength, insertedLength));
+	Assert::AreEqual(static_cast<size_t>(2), position);
+	Assert::AreEqual(static_cast<size_t>(1), deletedLength);
+	Assert::AreEqual(static_cast<size_t>(0), insertedLength);
+}
+
+void TextUtilsTest::TestFindChangedRangeSame() {
+	// 同じテキスト
+	size_t position, deletedLength, insertedLength;
+	Assert::IsFalse(find_changed_range("1girl", "1girl", position, deletedLength, insertedLength));
+	Assert::IsFalse(find_changed_range("", "", position, deletedLength, insertedLength));
+}
+
 void TextUtilsTest::TestExtractTagsFromText() {
 	// 基本的なタグ抽出のテスト
 	std::string text = "tag1, tag2, tag3";
@@ -338,6 +408,120 @@ void TextUtilsTest::TestExtractTagsFromTextWithMultipleBrackets() {
 	AssertTagEquals(tags[6], "tag3", 20, 24);
 }
 
+// 10000個のタグを含むプロンプト（括弧、重み、改行を含む）
+static std::string make_long_prompt() {
+	std::string text;
+	for (int i = 0; i < 10000; ++i) {
+		std::string tag = "tag_" + std::to_string(i);
+		switch (i % 4) {
+		case 0: text += tag + ", "; break;
+		case 1: text += "(" + tag + ":1.2), "; break;
+		case 2: text += "(" + tag + ", extra), "; break;
+		default: text += tag + "\n"; break;
+		}
+	}
+	return text;
+}
+
+void TextUtilsTest::TestTokenizePrompt() {
+	// タグの範囲と種類
+	std::string text = "(tag1), (tag2:1.2), tag3\n";
+	TagSpanList spans;
+	tokenize_prompt(text, spans);
+	Assert::AreEqual(static_cast<size_t>(8), spans.size());
+	const TagSpanKind kinds[] = {
+		TagSpanKind::OpenBracket, TagSpanKind::Tag, TagSpanKind::CloseBracket,
+		TagSpanKind::OpenBracket, TagSpanKind::Tag, TagSpanKind::Weight,
+		TagSpanKind::Tag, TagSpanKind::Newline,
+	};
+	for (size_t i = 0; i < spans.size(); ++i) {
+		Assert::IsTrue(kinds[i] == spans[i].kind);
+	}
+	Assert::AreEqual(static_cast<size_t>(13), spans[5].start);
+	Assert::AreEqual(static_cast<size_t>(18), spans[5].end);
+	Assert::AreEqual(std::string(":1.2)"), tag_span_text(text, spans[5]));
+	Assert::AreEqual(std::string("\n"), tag_span_text(text, spans[7]));
+
+	// 呼ぶたびに空にしてから追加する
+	tokenize_prompt("tag", spans);
+	Assert::AreEqual(static_cast<size_t>(1), spans.size());
+}
+
+void TextUtilsTest::TestTokenizePromptMatchesExtract() {
+	// 範囲の文字列と括弧の判定が extract_tags_from_text と同じ
+	const std::string texts[] = {
+		"tag1, tag2\ntag3",
+		"  tag1  ,\t tag2 \n , ,tag3, ",
+		"(tag1), (tag2:1.2), tag3",
+		"(a, b , c : 0.8 ), (), ( , ), (x\\), y)",
+		"tag\\(1\\), (tag\\,2:1.1), (tag3\\\\)",
+		"(unclosed, tag",
+		"a,(b\\,c\\d, e),f\\",
+		"(tag, trailing\\)",
+	};
+	for (const auto& text : texts) {
+		TagList tags = extract_tags_from_text(text);
+		TagSpanList spans;
+		tokenize_prompt(text, spans);
+		Assert::AreEqual(tags.size(), spans.size());
+		for (size_t i = 0; i < spans.size(); ++i) {
+			Assert::AreEqual(tags[i].tag, tag_span_text(text, spans[i]));
+			Assert::AreEqual(tags[i].start, spans[i].start);
+			Assert::AreEqual(tags[i].end, spans[i].end);
+			Assert::AreEqual(is_bracket_tag(tags[i].tag), is_bracket_span(text, spans[i]));
+		}
+	}
+}
+
+void TextUtilsTest::TestTokenizePromptWeightAfterCarriageReturn() {
+	// 括弧の最後のセグメントが \r で始まっても、コロンの位置で区切る
+	std::string text = "(a,\rb:1.2)";
+	TagSpanList spans;
+	tokenize_prompt(text, spans);
+	Assert::AreEqual(static_cast<size_t>(4), spans.size());
+	Assert::AreEqual(std::string("b"), tag_span_text(text, spans[2]));
+	Assert::AreEqual(static_cast<size_t>(5), spans[2].end);
+	Assert::IsTrue(TagSpanKind::Weight == spans[3].kind);
+	Assert::AreEqual(static_cast<size_t>(5), spans[3].start);
+	Assert::AreEqual(std::string(":1.2)"), tag_span_text(text, spans[3]));
+}
+
+void TextUtilsTest::TestTokenizePromptReusesSpans() {
+	// 同じ規模のプロンプトなら、2回目以降は確保済みの領域に書き込む
+	std::string text = make_long_prompt();
+	TagSpanList spans;
+	tokenize_prompt(text, spans);
+	auto data = spans.data();
+	auto capacity = spans.capacity();
+	tokenize_prompt(text, spans);
+	Assert::IsTrue(data == spans.data());
+	Assert::AreEqual(capacity, spans.capacity());
+}
+
+void TextUtilsTest::TestTokenizePromptBenchmark() {
+	// 10000個のタグのプロンプトで、範囲への分割とタグの文字列を作る抽出の時間を比べる
+	// 実行時間は環境で変わるので結果の一致だけを確かめ、時間は出力する
+	std::string text = make_long_prompt();
+	TagSpanList spans;
+	TagList tags;
+	auto best = [](auto&& run) {
+		auto fastest = std::chrono::steady_clock::duration::max();
+		for (int round = 0; round < 5; ++round) {
+			auto started = std::chrono::steady_clock::now();
+			run();
+			fastest = std::min(fastest, std::chrono::steady_clock::now() - started);
+		}
+		return fastest;
+	};
+	auto spanTime = best([&] { tokenize_prompt(text, spans); });
+	auto tagTime = best([&] { tags = extract_tags_from_text(text); });
+
+	Assert::AreEqual(tags.size(), spans.size());
+	Assert::IsTrue(spans.size() > 10000);
+	auto ms = [](auto time) { return std::to_string(std::chrono::duration<double, std::milli>(time).count()); };
+	Logger::WriteMessage(("tokenize_prompt: " + ms(spanTime) + "ms, extract_tags_from_text: " + ms(tagTime) + "ms\n").c_str());
+}
+
 void TextUtilsTest::TestIsBracketTag() {
 	// 基本的な括弧タグ判定のテスト
 	Assert::IsTrue(is_bracket_tag("("));
@@ -527,4 +711,89 @@ void TextUtilsTest::TestUnescapeNewlinesNoEscape() {
 	std::wstring result = unescape_newlines(text);
 	Assert::AreEqual(L"Hello World", result.c_str());
 }
+
+void TextUtilsTest::TestNormalizeJapaneseHiragana() {
+	// ひらがなはカタカナに揃える
+	Assert::AreEqual(L"ネコミミ", normalize_japanese(L"ねこみみ").c_str());
+	Assert::AreEqual(L"ネコミミ", normalize_japanese(L"ネコミミ").c_str());
+}
+
+void TextUtilsTest::TestNormalizeJapaneseHalfwidthKatakana() {
+	// 半角カタカナは全角に揃える
+	Assert::AreEqual(L"ネコミミ", normalize_japanese(L"ﾈｺﾐﾐ").c_str());
+	Assert::AreEqual(L"ツインテール", normalize_japanese(L"ﾂｲﾝﾃｰﾙ").c_str());
+}
+
+void TextUtilsTest::TestNormalizeJapaneseVoicedMarks() {
+	// 半角の濁点・半濁点や結合文字は直前のカナと合成する
+	Assert::AreEqual(L"ガギパピヴ", normalize_japanese(L"ｶﾞｷﾞﾊﾟﾋﾟｳﾞ").c_str());
+	Assert::AreEqual(L"ガ", normalize_japanese(L"か\u3099").c_str());
+	// 合成できない場合はそのまま残す
+	Assert::AreEqual(L"ア゛", normalize_japanese(L"ｱﾞ").c_str());
+}
+
+void TextUtilsTest::TestNormalizeJapaneseFullwidthAscii() {
+	// 全角英数記号と全角スペースは半角に揃える
+	Assert::AreEqual(L"Blue hair!", normalize_japanese(L"Ｂｌｕｅ　ｈａｉｒ！").c_str());
+	Assert::AreEqual(L"1~2", normalize_japanese(L"１～２").c_str());
+}
+
+void TextUtilsTest::TestNormalizeJapaneseLongVowel() {
+	// カナの後のダッシュや波ダッシュは長音記号に揃える
+	Assert::AreEqual(L"ラーメン", normalize_japanese(L"らーめん").c_str());
+	Assert::AreEqual(L"ラーメン", normalize_japanese(L"ら〜めん").c_str());
+	Assert::AreEqual(L"ラーメン", normalize_japanese(L"ラ―メン").c_str());
+	Assert::AreEqual(L"ラーメン", normalize_japanese(L"ﾗｰﾒﾝ").c_str());
+}
+
+void TextUtilsTest::TestNormalizeJapaneseUnchanged() {
+	// 漢字や半角英数はそのまま
+	Assert::AreEqual(L"猫耳 cat ears", normalize_japanese(L"猫耳 cat ears").c_str());
+	Assert::AreEqual(L"", normalize_japanese(L"").c_str());
+}
+
+void TextUtilsTest::TestNormalizeJapaneseResource() {
+	// 作業領域に確保する版も同じ変換をする
+	std::pmr::monotonic_buffer_resource resource;
+	for (const wchar_t* text : { L"ねこみみ", L"ｶﾞｷﾞﾊﾟﾋﾟｳﾞ", L"Ｂｌｕｅ　ｈａｉｒ！", L"ら〜めん", L"" }) {
+		auto normalized = normalize_japanese(text, &resource);
+		Assert::AreEqual(normalize_japanese(std::wstring(text)).c_str(), normalized.c_str());
+		Assert::IsTrue(normalized.get_allocator().resource() == &resource);
+	}
+	auto unicode = utf8_to_unicode(reinterpret_cast<const char*>(u8"こんにちは"), &resource);
+	Assert::AreEqual(L"こんにちは", unicode.c_str());
+}
+
+void TextUtilsTest::TestKanaToRomaji() {
+	Assert::AreEqual("nekomimi", kana_to_romaji(L"ネコミミ").c_str());
+	Assert::AreEqual("seifuku", kana_to_romaji(L"セイフク").c_str());
+	Assert::AreEqual("tsuinteeru", kana_to_romaji(L"ツインテール").c_str());
+}
+
+void TextUtilsTest::TestKanaToRomajiContracted() {
+	// 拗音と外来音
+	Assert::AreEqual("shatsu", kana_to_romaji(L"シャツ").c_str());
+	Assert::AreEqual("kyuuto", kana_to_romaji(L"キュート").c_str());
+	Assert::AreEqual("chokoreeto", kana_to_romaji(L"チョコレート").c_str());
+	Assert::AreEqual("faiyaa", kana_to_romaji(L"ファイヤー").c_str());
+	Assert::AreEqual("tiishatsu", kana_to_romaji(L"ティーシャツ").c_str());
+	Assert::AreEqual("wicchi", kana_to_romaji(L"ウィッチ").c_str());
+}
+
+void TextUtilsTest::TestKanaToRomajiSokuonAndLongVowel() {
+	// 促音は次の子音を重ね、長音は直前の母音を繰り返す
+	Assert::AreEqual("jaketto", kana_to_romaji(L"ジャケット").c_str());
+	Assert::AreEqual("gakkou", kana_to_romaji(L"ガッコウ").c_str());
+	Assert::AreEqual("seeraa", kana_to_romaji(L"セーラー").c_str());
+}
+
+void TextUtilsTest::TestKanaToRomajiMixed() {
+	// 漢字や記号は区切りになり、英数字は小文字で残す
+	Assert::AreEqual("seeraa", kana_to_romaji(L"セーラー服").c_str());
+	Assert::AreEqual("seeraa no", kana_to_romaji(normalize_japanese(L"セーラー服の学校")).c_str());
+	Assert::AreEqual("1gaaru", kana_to_romaji(L"1ガール").c_str());
+	// カタカナを含まなければ空文字列
+	Assert::AreEqual("", kana_to_romaji(L"猫耳").c_str());
+	Assert::AreEqual("", kana_to_romaji(L"cat ears").c_str());
+}
 }
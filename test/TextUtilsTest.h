@@ -26,6 +26,12 @@ public:
 	TEST_METHOD(TestUtf8HasMultibyteAsciiOnly);
 	TEST_METHOD(TestUtf8HasMultibyteJapanese);
 
+	// 文字種ごとの分割のテスト
+	TEST_METHOD(TestSplitScriptRuns);
+	TEST_METHOD(TestSplitScriptRunsSingle);
+	TEST_METHOD(TestSplitScriptRunsSpaces);
+	TEST_METHOD(TestSplitScriptRunsViews);
+
 	// カーソル位置のワード範囲取得のテスト
 	TEST_METHOD(TestGetSpanAtCursor);
 	TEST_METHOD(TestGetSpanAtCursorEmpty);
@@ -34,6 +40,10 @@ public:
 	TEST_METHOD(TestGetSpanAtCursorMixedDelimiters);
 	TEST_METHOD(TestGetSpanAtCursorOnComma);
 
+	// 異なる範囲の検出のテスト
+	TEST_METHOD(TestFindChangedRange);
+	TEST_METHOD(TestFindChangedRangeSame);
+
 	// タグ抽出のテスト
 	TEST_METHOD(TestExtractTagsFromText);
 	TEST_METHOD(TestExtractTagsFromTextEmpty);
@@ -52,6 +62,13 @@ public:
 	TEST_METHOD(TestExtractTagsFromTextWithEmptyBrackets);
 	TEST_METHOD(TestExtractTagsFromTextWithMultipleBrackets);
 
+	// タグの範囲への分割のテスト
+	TEST_METHOD(TestTokenizePrompt);
+	TEST_METHOD(TestTokenizePromptMatchesExtract);
+	TEST_METHOD(TestTokenizePromptWeightAfterCarriageReturn);
+	TEST_METHOD(TestTokenizePromptReusesSpans);
+	TEST_METHOD(TestTokenizePromptBenchmark);
+
 	// 括弧タグ判定のテスト
 	TEST_METHOD(TestIsBracketTag);
 	TEST_METHOD(TestIsBracketTagOpenBracket);
@@ -85,5 +102,20 @@ public:
 	TEST_METHOD(TestUnescapeNewlines);
 	TEST_METHOD(TestUnescapeNewlinesEmpty);
 	TEST_METHOD(TestUnescapeNewlinesNoEscape);
+
+	// 日本語の表記ゆれ吸収のテスト
+	TEST_METHOD(TestNormalizeJapaneseHiragana);
+	TEST_METHOD(TestNormalizeJapaneseHalfwidthKatakana);
+	TEST_METHOD(TestNormalizeJapaneseVoicedMarks);
+	TEST_METHOD(TestNormalizeJapaneseFullwidthAscii);
+	TEST_METHOD(TestNormalizeJapaneseLongVowel);
+	TEST_METHOD(TestNormalizeJapaneseUnchanged);
+	TEST_METHOD(TestNormalizeJapaneseResource);
+
+	// ローマ字変換のテスト
+	TEST_METHOD(TestKanaToRomaji);
+	TEST_METHOD(TestKanaToRomajiContracted);
+	TEST_METHOD(TestKanaToRomajiSokuonAndLongVowel);
+	TEST_METHOD(TestKanaToRomajiMixed);
 };
 }
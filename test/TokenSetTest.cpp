@@ -0,0 +1,157 @@
+﻿#include "pch.h"
+#include "TokenSetTest.h"
+#include "rapidfuzz/fuzz.hpp"
+#include <random>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TokenSetTest {
+static const std::vector<std::string> entries = {
+	"blue hair",
+	"long hair",
+	"hair between eyes",
+	"hatsune miku",
+	"hatsune miku (append)",
+	"1girl",
+	"",
+	"hair hair blue",
+	"\xE7\x8C\xAB \xE8\x80\xB3", // マルチバイトを含むトークン
+};
+
+static const std::vector<std::string> inputs = {
+	"blu hair",
+	"blue",
+	"hair blue",
+	"miku",
+	"hatsune miku",
+	"hatsune",
+	"long long hair",
+	"eyes between",
+	"girl",
+	"zzz",
+	"\xE7\x8C\xAB",
+};
+
+void TokenSetTest::TestBuildTokenTable() {
+	TokenTable table;
+	table.Build(entries);
+
+	Assert::AreEqual(entries.size(), table.EntryCount());
+	// 同じトークンは1つにまとめられる
+	uint32_t id = table.LowerBound("hair");
+	Assert::AreEqual(std::string("hair"), table.Token(id));
+	Assert::AreEqual(id, table.EntryTokens(0)[1]);
+	Assert::AreEqual(id, table.EntryTokens(1)[0]);
+}
+
+void TokenSetTest::TestEntryTokensSorted() {
+	TokenTable table;
+	table.Build(entries);
+
+	// エントリのトークンは辞書順（重複あり）
+	auto tokens = table.EntryTokens(7);
+	Assert::AreEqual(static_cast<size_t>(3), tokens.size());
+	Assert::AreEqual(std::string("blue"), table.Token(tokens[0]));
+	Assert::AreEqual(std::string("hair"), table.Token(tokens[1]));
+	Assert::AreEqual(std::string("hair"), table.Token(tokens[2]));
+}
+
+void TokenSetTest::TestEmptyEntry() {
+	TokenTable table;
+	table.Build(entries);
+
+	Assert::AreEqual(static_cast<size_t>(0), table.EntryTokens(6).size());
+	CachedTokenSetScorer scorer("blue", table);
+	Assert::AreEqual(0.0, scorer.Similarity(6));
+}
+
+void TokenSetTest::TestSimilarityMatchesRapidfuzz() {
+	// 全ての組み合わせで rapidfuzz の token_set_ratio と一致する
+	TokenTable table;
+	table.Build(entries);
+	for (const auto& input : inputs) {
+		CachedTokenSetScorer scorer(input, table);
+		for (size_t i = 0; i < entries.size(); ++i) {
+			double expected = rapidfuzz::fuzz::token_set_ratio(input, entries[i]);
+			Assert::AreEqual(expected, scorer.Similarity(i));
+		}
+	}
+}
+
+void TokenSetTest::TestSimilarityWithCutoff() {
+	TokenTable table;
+	table.Build(entries);
+	for (double cutoff : { 60.0, 90.0, 100.0, 101.0 }) {
+		for (const auto& input : inputs) {
+			CachedTokenSetScorer scorer(input, table);
+			for (size_t i = 0; i < entries.size(); ++i) {
+				double expected = rapidfuzz::fuzz::token_set_ratio(input, entries[i], cutoff);
+				Assert::AreEqual(expected, scorer.Similarity(i, cutoff));
+			}
+		}
+	}
+}
+
+void TokenSetTest::TestSimilarityUnknownTokens() {
+	// 表に無いトークンでも正しく比較できる
+	TokenTable table;
+	table.Build(entries);
+	CachedTokenSetScorer scorer("aaa hair zzz", table);
+	Assert::AreEqual(rapidfuzz::fuzz::token_set_ratio("aaa hair zzz", entries[0]), scorer.Similarity(0));
+	Assert::AreEqual(rapidfuzz::fuzz::token_set_ratio("aaa hair zzz", entries[2]), scorer.Similarity(2));
+}
+
+void TokenSetTest::TestSimilarityEmptyInput() {
+	TokenTable table;
+	table.Build(entries);
+	CachedTokenSetScorer scorer("", table);
+	Assert::AreEqual(0.0, scorer.Similarity(0));
+	CachedTokenSetScorer spaces("   ", table);
+	Assert::AreEqual(0.0, spaces.Similarity(0));
+}
+
+void TokenSetTest::TestSimilarityMatchesRapidfuzzRandom() {
+	// 乱数で作ったエントリと入力でも rapidfuzz の token_set_ratio と一致する
+	// 共通トークンの無い組（入力全体との Indel 距離）と、64文字を超える（複数ブロックの）トークンを含める
+	std::mt19937 random(12345);
+	const std::vector<std::string> words = { "blue", "blu", "hair", "long", "eyes", "miku", "hatsune", "a", "bb",
+		"\xE7\x8C\xAB", std::string(70, 'x'), std::string(65, 'x') + "y" };
+	auto make = [&](size_t maxWords) {
+		std::string text;
+		size_t count = random() % (maxWords + 1);
+		for (size_t i = 0; i < count; ++i) {
+			if (i) text += ' ';
+			text += words[random() % words.size()];
+		}
+		return text;
+	};
+	std::vector<std::string> randomEntries;
+	for (int i = 0; i < 200; ++i) randomEntries.push_back(make(4));
+	TokenTable table;
+	table.Build(randomEntries);
+	for (int n = 0; n < 50; ++n) {
+		auto input = make(3);
+		CachedTokenSetScorer scorer(input, table);
+		for (double cutoff : { 0.0, 60.0 }) {
+			for (size_t i = 0; i < randomEntries.size(); ++i) {
+				Assert::AreEqual(rapidfuzz::fuzz::token_set_ratio(input, randomEntries[i], cutoff), scorer.Similarity(i, cutoff));
+			}
+		}
+	}
+}
+
+void TokenSetTest::TestIndelDistanceMatchesRapidfuzz() {
+	// 64文字を超える（複数ブロックの）文字列や上限付きでも rapidfuzz の indel_distance と一致する
+	std::string longText;
+	for (int i = 0; i < 10; ++i) longText += "hatsune miku ";
+	const std::vector<std::string> texts = { "", "blue hair", "long hair", "\xE7\x8C\xAB \xE8\x80\xB3", longText, longText + "blue", "miku " + longText };
+	for (const auto& s1 : texts) {
+		CachedIndelDistance indel(s1, std::pmr::get_default_resource());
+		for (const auto& s2 : texts) {
+			for (size_t cutoff : { static_cast<size_t>(0), static_cast<size_t>(5), SIZE_MAX }) {
+				Assert::AreEqual(rapidfuzz::indel_distance(s1, s2, cutoff), indel.Distance(s2, cutoff));
+			}
+		}
+	}
+}
+}
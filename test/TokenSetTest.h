@@ -0,0 +1,26 @@
+﻿#pragma once
+
+#include "CppUnitTest.h"
+#include "../src/TokenSet.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TokenSetTest {
+TEST_CLASS(TokenSetTest) {
+public:
+	// トークン表のテスト
+	TEST_METHOD(TestBuildTokenTable);
+	TEST_METHOD(TestEntryTokensSorted);
+	TEST_METHOD(TestEmptyEntry);
+
+	// 類似度のテスト
+	TEST_METHOD(TestSimilarityMatchesRapidfuzz);
+	TEST_METHOD(TestSimilarityWithCutoff);
+	TEST_METHOD(TestSimilarityUnknownTokens);
+	TEST_METHOD(TestSimilarityEmptyInput);
+	TEST_METHOD(TestSimilarityMatchesRapidfuzzRandom);
+
+	// Indel 距離のテスト
+	TEST_METHOD(TestIndelDistanceMatchesRapidfuzz);
+};
+}